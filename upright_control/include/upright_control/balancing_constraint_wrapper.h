@@ -5,11 +5,16 @@
 #include <upright_control/constraint/bounded_balancing_constraints.h>
 #include <upright_control/controller_settings.h>
 #include <upright_control/dynamics/system_pinocchio_mapping.h>
+#include <upright_control/library_cache.h>
 #include <upright_control/types.h>
 #include <upright_control/util.h>
 
 #include <pinocchio/multibody/model.hpp>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 namespace upright {
 
 // Wrapper to enable access to constraint Jacobian through bindings.
@@ -22,27 +27,79 @@ class BalancingConstraintWrapper {
         if (!settings.balancing_settings.use_force_constraints) {
             throw std::runtime_error("Contact force constraints not enabled.");
         }
+        if (settings.balancing_settings.friction_model ==
+            FrictionModel::ExactCone) {
+            // The wrapper exposes the constant state Jacobian of the linear
+            // constraint formulations; the exact cone's Jacobian depends on
+            // the forces and is not supported here.
+            throw std::runtime_error(
+                "Exact-cone friction model is not supported by the balancing "
+                "constraint wrapper; use the linearized cone.");
+        }
 
         ocs2::PinocchioInterface interface(build_pinocchio_interface(
             settings.robot_urdf_path, settings.robot_base_type,
             settings.locked_joints, settings.base_pose));
 
-        SystemPinocchioMapping<
-            TripleIntegratorPinocchioMapping<ocs2::ad_scalar_t>,
-            ocs2::ad_scalar_t>
-            mapping(settings.dims);
+        // Same cache layout as ControllerInterface, so the wrapper reuses
+        // libraries compiled by the controller (and vice versa).
+        const LibraryCache lib_cache(settings.lib_folder,
+                                     settings.use_library_cache,
+                                     settings.recompile_libraries);
+        // Key composition must match ControllerInterface exactly, so that the
+        // two entry points agree on whether a library is up to date.
+        LibraryHash kinematics_key;
+        kinematics_key.add(settings.dims.robot.q);
+        kinematics_key.add(settings.dims.robot.v);
+        kinematics_key.add(settings.dims.robot.x);
+        kinematics_key.add(settings.dims.robot.u);
+        kinematics_key.add(settings.dims.o);
+        kinematics_key.add(settings.dims.c);
+        kinematics_key.add(settings.dims.nf);
+        kinematics_key.add_file(settings.robot_urdf_path);
+        kinematics_key.add(robot_base_type_to_string(settings.robot_base_type));
+        kinematics_key.add(VecXd(settings.base_pose));
+        for (const auto& kv : settings.locked_joints) {
+            kinematics_key.add(kv.first);
+            kinematics_key.add(kv.second);
+        }
+        kinematics_key.add(settings.end_effector_link_name);
+
+        // Only the structure of the arrangement is baked into the tapes; the
+        // object and contact properties are runtime parameters.
+        LibraryHash balancing_key = kinematics_key;
+        balancing_key.add(VecXd(settings.gravity));
+        balancing_key.add(
+            friction_model_to_string(settings.balancing_settings.friction_model));
+        balancing_key.add(settings.balancing_settings.constraints_enabled.normal);
+        balancing_key.add(settings.balancing_settings.constraints_enabled.friction);
+        balancing_key.add(settings.balancing_settings.constraints_enabled.zmp);
+        for (const auto& kv : settings.balancing_settings.objects) {
+            balancing_key.add(kv.first);
+            balancing_key.add(kv.second.num_parameters());
+        }
+        for (const auto& contact : settings.balancing_settings.contacts) {
+            balancing_key.add(contact.object1_name);
+            balancing_key.add(contact.object2_name);
+        }
+
+        // The friction constraints are linear in the inputs, so they are
+        // analytical and need no codegen library (nor the end-effector
+        // kinematics model the codegen version taped through).
+        contact_constraints_.reset(new LinearContactForceBalancingConstraints(
+            settings.balancing_settings, settings.dims));
 
-        ocs2::PinocchioEndEffectorKinematicsCppAd end_effector_kinematics(
-            interface, mapping, {settings.end_effector_link_name},
-            settings.dims.x(), settings.dims.u(), "end_effector_kinematics",
-            settings.lib_folder, settings.recompile_libraries, false);
+        // Fused single-pass kinematics for the object dynamics constraints.
+        RigidBodyStateKinematicsCppAd rigid_body_kinematics(
+            interface, settings.end_effector_link_name, settings.dims);
 
-        contact_constraints_.reset(new ContactForceBalancingConstraints(
-            end_effector_kinematics, settings.balancing_settings,
-            settings.gravity, settings.dims, settings.recompile_libraries));
+        const std::string object_dynamics_folder =
+            lib_cache.folder("object_dynamics_constraints", balancing_key);
         dynamics_constraints_.reset(new ObjectDynamicsConstraints(
-            end_effector_kinematics, settings.balancing_settings,
-            settings.gravity, settings.dims, settings.recompile_libraries));
+            rigid_body_kinematics, settings.balancing_settings,
+            settings.gravity, settings.dims, object_dynamics_folder,
+            lib_cache.recompile("object_dynamics_constraints",
+                                balancing_key)));
     }
 
     ocs2::VectorFunctionLinearApproximation getLinearApproximation(
@@ -62,8 +119,85 @@ class BalancingConstraintWrapper {
         return approx;
     }
 
+    // Evaluate the constraint linearization at a batch of (t, x, u) points,
+    // given as rows of the state and input matrices, using num_threads
+    // worker threads. The per-point values and state Jacobians are stacked
+    // vertically in the returned approximation, with point i occupying rows
+    // [i * nc, (i + 1) * nc). Intended for offline analysis over logged
+    // trajectories, where per-point Python calls dominate the wall time; the
+    // bindings release the GIL for the duration of the batch.
+    ocs2::VectorFunctionLinearApproximation getLinearApproximationBatch(
+        const VecXd& times, const MatXd& states, const MatXd& inputs,
+        size_t num_threads) {
+        const size_t n = times.size();
+        if (states.rows() != n || inputs.rows() != n) {
+            throw std::runtime_error(
+                "[BalancingConstraintWrapper] times, states, and inputs must "
+                "have the same number of rows.");
+        }
+
+        const size_t nc = contact_constraints_->getNumConstraints() +
+                          dynamics_constraints_->getNumConstraints();
+        ocs2::VectorFunctionLinearApproximation approx(n * nc, states.cols(),
+                                                       0);
+        if (n == 0) {
+            return approx;
+        }
+
+        num_threads = std::max(size_t(1), std::min(num_threads, n));
+        std::atomic<size_t> next_index{0};
+        std::exception_ptr worker_exception;
+        std::mutex exception_mutex;
+
+        // The compiled CppAd models keep per-instance evaluation workspace,
+        // so each worker operates on its own clones of the constraints
+        // (which reuse the already-compiled libraries).
+        auto worker = [&]() {
+            try {
+                std::unique_ptr<LinearContactForceBalancingConstraints>
+                    contacts(contact_constraints_->clone());
+                std::unique_ptr<ObjectDynamicsConstraints> dynamics(
+                    dynamics_constraints_->clone());
+                ocs2::PreComputation precomputation;
+
+                size_t i;
+                while ((i = next_index.fetch_add(1)) < n) {
+                    const VecXd x = states.row(i);
+                    const VecXd u = inputs.row(i);
+                    const auto a = contacts->getLinearApproximation(
+                        times(i), x, u, precomputation);
+                    const auto b = dynamics->getLinearApproximation(
+                        times(i), x, u, precomputation);
+                    approx.f.segment(i * nc, a.f.size()) = a.f;
+                    approx.f.segment(i * nc + a.f.size(), b.f.size()) = b.f;
+                    approx.dfdx.middleRows(i * nc, a.dfdx.rows()) = a.dfdx;
+                    approx.dfdx.middleRows(i * nc + a.dfdx.rows(),
+                                           b.dfdx.rows()) = b.dfdx;
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                if (!worker_exception) {
+                    worker_exception = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_threads; ++i) {
+            threads.emplace_back(worker);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (worker_exception) {
+            std::rethrow_exception(worker_exception);
+        }
+        return approx;
+    }
+
    private:
-    std::unique_ptr<ContactForceBalancingConstraints> contact_constraints_;
+    std::unique_ptr<LinearContactForceBalancingConstraints>
+        contact_constraints_;
     std::unique_ptr<ObjectDynamicsConstraints> dynamics_constraints_;
     ocs2::PreComputation precomputation_;
 };
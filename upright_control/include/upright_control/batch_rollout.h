@@ -0,0 +1,194 @@
+#pragma once
+
+#include <ocs2_core/ComputationRequest.h>
+#include <ocs2_core/reference/TargetTrajectories.h>
+#include <ocs2_mpc/MPC_BASE.h>
+#include <ocs2_oc/oc_data/PrimalSolution.h>
+#include <ocs2_oc/oc_problem/OptimalControlProblem.h>
+#include <upright_control/controller_interface.h>
+#include <upright_control/controller_settings.h>
+#include <upright_control/types.h>
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace upright {
+
+// Closed-loop trajectory of a single scenario produced by BatchRollout.
+struct BatchRolloutResult {
+    VecXd ts;  // sample times, length T + 1
+    MatXd xs;  // states, row i is the state at ts(i), shape (T + 1, nx)
+    MatXd us;  // inputs, row i is held over [ts(i), ts(i+1)), shape (T, nu)
+};
+
+// Runs many independent closed-loop MPC simulations in parallel, for scenario
+// sweeps (object arrangements x trajectories x noise seeds) that would
+// otherwise step one ControllerPythonInterface at a time from Python.
+//
+// Each instance owns its own MPC and optimal control problem, since
+// evaluation of the compiled auto-diff models is stateful, but all instances
+// share the compiled libraries on disk: the first instance compiles (or
+// loads) them as configured and the remaining instances are constructed with
+// recompilation disabled, so they simply load the same libraries, which are
+// read-only after load. Scenarios are distributed over the instances with
+// one worker thread per instance; the Python binding releases the GIL for
+// the duration of the batch.
+class BatchRollout {
+   public:
+    BatchRollout(const ControllerSettings& settings, size_t num_instances) {
+        if (num_instances == 0) {
+            throw std::runtime_error(
+                "[BatchRollout] num_instances must be positive.");
+        }
+
+        // The instances are constructed sequentially so that later ones never
+        // race the first one's compilation.
+        ControllerSettings instance_settings = settings;
+        instances_.reserve(num_instances);
+        for (size_t i = 0; i < num_instances; ++i) {
+            instances_.emplace_back(new Instance(instance_settings));
+            instance_settings.recompile_libraries = false;
+        }
+    }
+
+    size_t getNumInstances() const { return instances_.size(); }
+
+    // Roll out one scenario per row of x0s: starting from initial state
+    // x0s.row(i), track targets[i] for the given duration, replanning and
+    // applying a new input every timestep. Scenarios are processed in
+    // parallel across the instances; result i corresponds to scenario i.
+    std::vector<BatchRolloutResult> rollout(
+        const MatXd& x0s, const std::vector<ocs2::TargetTrajectories>& targets,
+        ocs2::scalar_t duration, ocs2::scalar_t timestep) {
+        const size_t num_scenarios = x0s.rows();
+        if (targets.size() != num_scenarios) {
+            throw std::runtime_error(
+                "[BatchRollout] x0s and targets must have the same number of "
+                "scenarios.");
+        }
+        if (timestep <= 0 || duration < timestep) {
+            throw std::runtime_error(
+                "[BatchRollout] duration and timestep must be positive with "
+                "duration >= timestep.");
+        }
+
+        std::vector<BatchRolloutResult> results(num_scenarios);
+        std::atomic<size_t> next_scenario{0};
+        std::exception_ptr worker_exception;
+        std::mutex exception_mutex;
+
+        auto worker = [&](Instance& instance) {
+            try {
+                size_t i;
+                while ((i = next_scenario.fetch_add(1)) < num_scenarios) {
+                    results[i] = runScenario(instance, x0s.row(i), targets[i],
+                                             duration, timestep);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                if (!worker_exception) {
+                    worker_exception = std::current_exception();
+                }
+            }
+        };
+
+        const size_t num_workers =
+            std::min(instances_.size(), num_scenarios);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_workers; ++i) {
+            threads.emplace_back(worker, std::ref(*instances_[i]));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (worker_exception) {
+            std::rethrow_exception(worker_exception);
+        }
+        return results;
+    }
+
+   private:
+    // One independent simulation slot: its own interface, MPC, and a deep
+    // copy of the optimal control problem whose dynamics propagate the
+    // simulated state. Each instance is only ever touched by one worker
+    // thread at a time.
+    struct Instance {
+        explicit Instance(const ControllerSettings& settings)
+            : interface(settings), problem(interface.getOptimalControlProblem()) {
+            mpc = interface.get_mpc();
+            mpc->getSolverPtr()->setReferenceManager(
+                interface.getReferenceManagerPtr());
+        }
+
+        ControllerInterface interface;
+        ocs2::OptimalControlProblem problem;
+        std::unique_ptr<ocs2::MPC_BASE> mpc;
+    };
+
+    BatchRolloutResult runScenario(Instance& instance, const VecXd& x0,
+                                   const ocs2::TargetTrajectories& target,
+                                   ocs2::scalar_t duration,
+                                   ocs2::scalar_t timestep) {
+        const size_t num_steps = std::ceil(duration / timestep);
+
+        BatchRolloutResult result;
+        result.ts.resize(num_steps + 1);
+        result.xs.resize(num_steps + 1, x0.size());
+
+        instance.interface.getReferenceManagerPtr()->setTargetTrajectories(
+            target);
+        instance.mpc->reset();
+
+        ocs2::PrimalSolution policy;
+        VecXd x = x0;
+        for (size_t i = 0; i < num_steps; ++i) {
+            const ocs2::scalar_t t = i * timestep;
+            result.ts(i) = t;
+            result.xs.row(i) = x.transpose();
+
+            instance.mpc->run(t, x);
+            instance.mpc->getSolverPtr()->getPrimalSolution(
+                t + instance.mpc->settings().timeHorizon_, &policy);
+            const VecXd u = policy.controllerPtr_->computeInput(t, x);
+
+            if (i == 0) {
+                result.us.resize(num_steps, u.size());
+            }
+            result.us.row(i) = u.transpose();
+
+            x = integrate(instance.problem, t, x, u, timestep);
+        }
+        result.ts(num_steps) = num_steps * timestep;
+        result.xs.row(num_steps) = x.transpose();
+        return result;
+    }
+
+    // Classical fourth-order Runge-Kutta step on the system flow map, with
+    // the input held constant over the timestep (zero-order hold, matching
+    // how commands are applied by the tracking loop).
+    static VecXd integrate(ocs2::OptimalControlProblem& problem,
+                           ocs2::scalar_t t, const VecXd& x, const VecXd& u,
+                           ocs2::scalar_t dt) {
+        auto f = [&](ocs2::scalar_t s, const VecXd& y) -> VecXd {
+            problem.preComputationPtr->request(ocs2::Request::Dynamics, s, y,
+                                               u);
+            return problem.dynamicsPtr->computeFlowMap(
+                s, y, u, *problem.preComputationPtr);
+        };
+
+        const VecXd k1 = f(t, x);
+        const VecXd k2 = f(t + 0.5 * dt, x + 0.5 * dt * k1);
+        const VecXd k3 = f(t + 0.5 * dt, x + 0.5 * dt * k2);
+        const VecXd k4 = f(t + dt, x + dt * k3);
+        return x + (dt / 6) * (k1 + 2 * k2 + 2 * k3 + k4);
+    }
+
+    std::vector<std::unique_ptr<Instance>> instances_;
+};
+
+}  // namespace upright
@@ -1,10 +1,13 @@
 #pragma once
 
-#include <ocs2_core/constraint/StateInputConstraintCppAd.h>
+#include <ocs2_core/constraint/StateInputConstraint.h>
 #include <ocs2_pinocchio_interface/PinocchioEndEffectorKinematicsCppAd.h>
 
 #include <upright_control/constraint/constraint_type.h>
+#include <upright_control/constraint/friction_model.h>
+#include <upright_control/constraint/robot_state_input_constraint_cppad.h>
 #include <upright_control/dimensions.h>
+#include <upright_control/rigid_body_state_kinematics.h>
 #include <upright_control/types.h>
 #include <upright_core/nominal.h>
 #include <upright_core/bounded.h>
@@ -28,6 +31,12 @@ struct BalancingSettings {
     bool use_force_constraints = false;
     std::vector<ContactPoint<ocs2::scalar_t>> contacts;
 
+    // Friction model used by the contact force constraints. Must be
+    // consistent with the optimization dimensions: Frictionless uses one
+    // force variable per contact (dims.nf == 1), the cone models a full 3D
+    // force (dims.nf == 3).
+    FrictionModel friction_model = FrictionModel::LinearizedCone;
+
     // Weight on the contact forces in the optimization problem
     ocs2::scalar_t force_weight = 0.01;
 
@@ -40,20 +49,21 @@ std::ostream& operator<<(std::ostream& out, const BalancingSettings& settings);
 
 
 class NominalBalancingConstraints final
-    : public ocs2::StateInputConstraintCppAd {
+    : public RobotStateInputConstraintCppAd {
    public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
     NominalBalancingConstraints(
-        const ocs2::PinocchioEndEffectorKinematicsCppAd& pinocchioEEKinematics,
+        const RigidBodyStateKinematicsCppAd& kinematics,
         const BalancingSettings& settings, const Vec3d& gravity,
-        const OptimizationDimensions& dims, bool recompileLibraries);
+        const OptimizationDimensions& dims,
+        const std::string& library_folder, bool recompileLibraries);
 
     NominalBalancingConstraints* clone() const override {
         // Always pass recompileLibraries = false to avoid recompiling the same
         // library just because this object is cloned.
-        return new NominalBalancingConstraints(*pinocchioEEKinPtr_, settings_,
-                                               gravity_, dims_, false);
+        return new NominalBalancingConstraints(
+            kinematics_, settings_, gravity_, dims_, library_folder_, false);
     }
 
     size_t getNumConstraints(ocs2::scalar_t time) const override {
@@ -63,8 +73,7 @@ class NominalBalancingConstraints final
     size_t getNumConstraints() const { return getNumConstraints(0); }
 
     VecXd getParameters(ocs2::scalar_t time) const override {
-        // Parameters are constant for now
-        return VecXd(0);
+        return parameters_;
     }
 
    protected:
@@ -73,34 +82,40 @@ class NominalBalancingConstraints final
                               const VecXad& parameters) const override;
 
    private:
-    NominalBalancingConstraints(const NominalBalancingConstraints& other) =
-        default;
-
-    std::unique_ptr<ocs2::PinocchioEndEffectorKinematicsCppAd>
-        pinocchioEEKinPtr_;
+    RigidBodyStateKinematicsCppAd kinematics_;
     BalancingSettings settings_;
     BalancedObjectArrangement<ocs2::scalar_t> arrangement_;
-    OptimizationDimensions dims_;
+    // AD-typed copy of the arrangement. Only its structure (object names,
+    // parameter counts, gravity, enabled flags) is baked into the tape; the
+    // object properties themselves enter as runtime parameters, so changing
+    // a mass, CoM, or friction coefficient does not invalidate the library.
+    BalancedObjectArrangement<ocs2::ad_scalar_t> ad_arrangement_;
+    // Parameter vector fed to the generated model on every evaluation,
+    // assembled once at construction.
+    VecXd parameters_;
     Vec3d gravity_;
+    std::string library_folder_;
 };
 
 
 // Balancing constraints based on contact forces between objects.
 class ContactForceBalancingConstraints final
-    : public ocs2::StateInputConstraintCppAd {
+    : public RobotStateInputConstraintCppAd {
    public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
     ContactForceBalancingConstraints(
         const ocs2::PinocchioEndEffectorKinematicsCppAd& pinocchioEEKinematics,
         const BalancingSettings& settings, const Vec3d& gravity,
-        const OptimizationDimensions& dims, bool recompileLibraries);
+        const OptimizationDimensions& dims,
+        const std::string& library_folder, bool recompileLibraries);
 
     ContactForceBalancingConstraints* clone() const override {
         // Always pass recompileLibraries = false to avoid recompiling the same
         // library just because this object is cloned.
         return new ContactForceBalancingConstraints(
-            *pinocchioEEKinPtr_, settings_, gravity_, dims_, false);
+            *pinocchioEEKinPtr_, settings_, gravity_, dims_, library_folder_,
+            false);
     }
 
     size_t getNumConstraints(ocs2::scalar_t time) const override {
@@ -110,8 +125,7 @@ class ContactForceBalancingConstraints final
     size_t getNumConstraints() const { return getNumConstraints(0); }
 
     VecXd getParameters(ocs2::scalar_t time) const override {
-        // Parameters are constant for now
-        return VecXd(0);
+        return parameters_;
     }
 
    protected:
@@ -120,34 +134,86 @@ class ContactForceBalancingConstraints final
                               const VecXad& parameters) const override;
 
    private:
-    ContactForceBalancingConstraints(
-        const ContactForceBalancingConstraints& other) = default;
-
     std::unique_ptr<ocs2::PinocchioEndEffectorKinematicsCppAd>
         pinocchioEEKinPtr_;
     BalancingSettings settings_;
-    OptimizationDimensions dims_;
+    // Parameter vector fed to the generated model on every evaluation,
+    // assembled once at construction. Only the number of contacts is baked
+    // into the tape; the friction coefficients, normals, and spans enter as
+    // runtime parameters.
+    VecXd parameters_;
     Vec3d gravity_;
+    std::string library_folder_;
     size_t num_constraints_;
 };
 
+// Analytical version of the contact force friction constraints above. The
+// linearized friction cone is linear in the force block of the input, so its
+// Jacobian is a constant sparse matrix determined entirely by the contact
+// normals, spans, and friction coefficients. It is precomputed once at
+// construction and returned directly from getLinearApproximation, bypassing
+// the generated-library call per horizon node and the codegen compilation at
+// startup entirely.
+class LinearContactForceBalancingConstraints final
+    : public ocs2::StateInputConstraint {
+   public:
+    LinearContactForceBalancingConstraints(const BalancingSettings& settings,
+                                           const OptimizationDimensions& dims);
+
+    LinearContactForceBalancingConstraints* clone() const override {
+        return new LinearContactForceBalancingConstraints(*this);
+    }
+
+    size_t getNumConstraints(ocs2::scalar_t time) const override {
+        return num_constraints_;
+    }
+
+    size_t getNumConstraints() const { return getNumConstraints(0); }
+
+    VecXd getValue(ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+                   const ocs2::PreComputation&) const override {
+        return dfdu_ * input;
+    }
+
+    ocs2::VectorFunctionLinearApproximation getLinearApproximation(
+        ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+        const ocs2::PreComputation&) const override {
+        ocs2::VectorFunctionLinearApproximation approximation(
+            num_constraints_, state.size(), input.size());
+        approximation.f.noalias() = dfdu_ * input;
+        approximation.dfdx.setZero();
+        approximation.dfdu = dfdu_;
+        return approximation;
+    }
+
+   private:
+    LinearContactForceBalancingConstraints(
+        const LinearContactForceBalancingConstraints& other) = default;
+
+    size_t num_constraints_;
+    // Constant Jacobian with respect to the full input; only the columns of
+    // the trailing force block are non-zero.
+    MatXd dfdu_;
+};
+
 // Equality constraints that ensure contact forces on the object are consistent
 // with sticking to the EE.
 class ObjectDynamicsConstraints final
-    : public ocs2::StateInputConstraintCppAd {
+    : public RobotStateInputConstraintCppAd {
    public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
     ObjectDynamicsConstraints(
-        const ocs2::PinocchioEndEffectorKinematicsCppAd& pinocchioEEKinematics,
+        const RigidBodyStateKinematicsCppAd& kinematics,
         const BalancingSettings& settings, const Vec3d& gravity,
-        const OptimizationDimensions& dims, bool recompileLibraries);
+        const OptimizationDimensions& dims,
+        const std::string& library_folder, bool recompileLibraries);
 
     ObjectDynamicsConstraints* clone() const override {
         // Always pass recompileLibraries = false to avoid recompiling the same
         // library just because this object is cloned.
         return new ObjectDynamicsConstraints(
-            *pinocchioEEKinPtr_, settings_, gravity_, dims_, false);
+            kinematics_, settings_, gravity_, dims_, library_folder_, false);
     }
 
     size_t getNumConstraints(ocs2::scalar_t time) const override {
@@ -157,8 +223,7 @@ class ObjectDynamicsConstraints final
     size_t getNumConstraints() const { return getNumConstraints(0); }
 
     VecXd getParameters(ocs2::scalar_t time) const override {
-        // Parameters are constant for now
-        return VecXd(0);
+        return parameters_;
     }
 
    protected:
@@ -167,14 +232,20 @@ class ObjectDynamicsConstraints final
                               const VecXad& parameters) const override;
 
    private:
-    ObjectDynamicsConstraints(
-        const ObjectDynamicsConstraints& other) = default;
-
-    std::unique_ptr<ocs2::PinocchioEndEffectorKinematicsCppAd>
-        pinocchioEEKinPtr_;
+    RigidBodyStateKinematicsCppAd kinematics_;
     BalancingSettings settings_;
-    OptimizationDimensions dims_;
+    // AD-typed objects and contacts with resolved indices. Only their
+    // structure (names, iteration order, parameter counts, contact topology)
+    // is baked into the tape; the masses, CoM offsets, friction coefficients,
+    // and contact positions enter as runtime parameters.
+    std::map<std::string, BalancedObject<ocs2::ad_scalar_t>> ad_objects_;
+    std::vector<ContactPoint<ocs2::ad_scalar_t>> ad_contacts_;
+    Vec3ad ad_gravity_;
+    // Parameter vector fed to the generated model on every evaluation,
+    // assembled once at construction.
+    VecXd parameters_;
     Vec3d gravity_;
+    std::string library_folder_;
     size_t num_constraints_;
 };
 
@@ -4,6 +4,7 @@
 #include <ocs2_oc/synchronized_module/ReferenceManager.h>
 #include <ocs2_robotic_tools/end_effector/EndEffectorKinematics.h>
 
+#include <upright_control/precomputation.h>
 #include <upright_control/reference_trajectory.h>
 #include <upright_control/types.h>
 
@@ -45,11 +46,18 @@ class EndEffectorBoxConstraint final : public ocs2::StateConstraint {
     size_t getNumConstraints(ocs2::scalar_t time) const override { return 6; }
 
     VecXd getValue(ocs2::scalar_t time, const VecXd& state,
-                   const ocs2::PreComputation&) const override {
+                   const ocs2::PreComputation& pre_comp) const override {
         const auto& target = reference_manager_ptr_->getTargetTrajectories();
-        const auto desired_pose = interpolate_end_effector_pose(time, target);
+        const auto desired_pose =
+            compiled_reference_.interpolate_pose(time, target);
         Vec3d desired_position = desired_pose.first;
-        Vec3d actual_position = kinematics_ptr_->getPosition(state).front();
+
+        // Use the position cached by the shared pre-computation if available.
+        const auto* precomputation =
+            dynamic_cast<const UprightPreComputation*>(&pre_comp);
+        Vec3d actual_position =
+            precomputation ? precomputation->getEndEffectorState().pose.position
+                           : kinematics_ptr_->getPosition(state).front();
 
         VecXd value = VecXd::Zero(6);
         value.head<3>() = desired_position + xyz_upper_ - actual_position;
@@ -68,8 +76,13 @@ class EndEffectorBoxConstraint final : public ocs2::StateConstraint {
 
         approximation.f = getValue(time, state, pre_comp);
 
+        const auto* precomputation =
+            dynamic_cast<const UprightPreComputation*>(&pre_comp);
         const auto position_approx =
-            kinematics_ptr_->getPositionLinearApproximation(state).front();
+            (precomputation && precomputation->hasApproximation())
+                ? precomputation->getEndEffectorPositionApproximation()
+                : kinematics_ptr_->getPositionLinearApproximation(state)
+                      .front();
         approximation.dfdx << -position_approx.dfdx, position_approx.dfdx;
 
         return approximation;
@@ -85,6 +98,7 @@ class EndEffectorBoxConstraint final : public ocs2::StateConstraint {
     std::unique_ptr<ocs2::EndEffectorKinematics<ocs2::scalar_t>>
         kinematics_ptr_;
     const ocs2::ReferenceManager* reference_manager_ptr_;
+    mutable CompiledEndEffectorReference compiled_reference_;
 };
 
 }  // namespace upright
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+namespace upright {
+
+// Friction model used by the contact-force balancing constraints. The model
+// is fixed when the constraint objects are built, so the generated tapes and
+// analytical Jacobians contain only the selected model's kernel (see the
+// friction-model tags in upright_core/contact.h).
+enum class FrictionModel {
+    // One non-negative normal-force magnitude per contact (dims.nf == 1).
+    Frictionless,
+    // Full 3D force per contact, pyramidal cone facets (dims.nf == 3).
+    LinearizedCone,
+    // Full 3D force per contact, quadratic Coulomb cone (dims.nf == 3).
+    ExactCone,
+};
+
+inline std::string friction_model_to_string(const FrictionModel& model) {
+    if (model == FrictionModel::Frictionless) {
+        return "frictionless";
+    } else if (model == FrictionModel::LinearizedCone) {
+        return "linearized_cone";
+    } else {
+        return "exact_cone";
+    }
+}
+
+inline FrictionModel friction_model_from_string(const std::string& s) {
+    if (s == "frictionless") {
+        return FrictionModel::Frictionless;
+    } else if (s == "linearized_cone") {
+        return FrictionModel::LinearizedCone;
+    } else if (s == "exact_cone") {
+        return FrictionModel::ExactCone;
+    }
+    throw std::runtime_error("Could not parse FrictionModel from string.");
+}
+
+}  // namespace upright
@@ -11,7 +11,18 @@ class JointStateInputLimits final : public ocs2::StateInputConstraint {
    public:
     JointStateInputLimits(const OptimizationDimensions& dims)
         : ocs2::StateInputConstraint(ocs2::ConstraintOrder::Linear),
-          dims_(dims) {}
+          dims_(dims),
+          approx_(dims.robot.x + dims.robot.u, dims.x(), dims.u()) {
+        // The derivative blocks are constant (see getLinearApproximation),
+        // so they are assembled once here; per call only the value vector is
+        // refreshed in place and the cached approximation copied out.
+        approx_.f.setZero();
+        approx_.dfdx.setZero();
+        approx_.dfdx.topLeftCorner(dims_.robot.x, dims_.robot.x).setIdentity();
+        approx_.dfdu.setZero();
+        approx_.dfdu.bottomLeftCorner(dims_.robot.u, dims_.robot.u)
+            .setIdentity();
+    }
 
     ~JointStateInputLimits() override = default;
 
@@ -28,9 +39,8 @@ class JointStateInputLimits final : public ocs2::StateInputConstraint {
     // limit)
     VecXd getValue(ocs2::scalar_t time, const VecXd& state, const VecXd& input,
                    const ocs2::PreComputation&) const override {
-        VecXd value(getNumConstraints(time));
-        value << state.head(dims_.robot.x), input.head(dims_.robot.u);
-        return value;
+        refresh_value(state, input);
+        return approx_.f;
     }
 
     // Following from the above, we have
@@ -39,25 +49,28 @@ class JointStateInputLimits final : public ocs2::StateInputConstraint {
     // and
     //   df/du = [df/du_1 df/du_2] = |dx_1/du_1 dx_1/du_2| = |0 0|
     //                               |du_1/du_1 du_1/du_2|   |I 0|
+    // Both are constant and cached at construction, so this is a value
+    // refresh plus a copy of the cached approximation.
     ocs2::VectorFunctionLinearApproximation getLinearApproximation(
         ocs2::scalar_t time, const VecXd& state, const VecXd& input,
         const ocs2::PreComputation& precomp) const override {
-        ocs2::VectorFunctionLinearApproximation limits(
-            getNumConstraints(time), state.rows(), input.rows());
-
-        limits.f = getValue(time, state, input, precomp);
-        limits.dfdx.setZero();
-        limits.dfdx.topLeftCorner(dims_.robot.x, dims_.robot.x).setIdentity();
-        limits.dfdu.setZero();
-        limits.dfdu.bottomLeftCorner(dims_.robot.u, dims_.robot.u).setIdentity();
-
-        return limits;
+        refresh_value(state, input);
+        return approx_;
     }
 
    private:
     JointStateInputLimits(const JointStateInputLimits& other) = default;
 
+    void refresh_value(const VecXd& state, const VecXd& input) const {
+        approx_.f.head(dims_.robot.x) = state.head(dims_.robot.x);
+        approx_.f.tail(dims_.robot.u) = input.head(dims_.robot.u);
+    }
+
     OptimizationDimensions dims_;
+    // Cached approximation with constant derivatives. The solver gives each
+    // worker thread its own clone, so the mutable value refresh is not
+    // contended.
+    mutable ocs2::VectorFunctionLinearApproximation approx_;
 };
 
 // For hard inequalities. TODO: these should be replaced with box constraints
@@ -94,6 +107,12 @@ class JointStateInputConstraint final : public ocs2::StateInputConstraint {
         e_ = VecXd::Zero(n);
         e_ << -state_limit_lower, state_limit_upper, -input_limit_lower,
             input_limit_upper;
+
+        // The Jacobians are just C and D, so the whole approximation except
+        // for the value is cached here.
+        approx_.f = e_;
+        approx_.dfdx = C_;
+        approx_.dfdu = D_;
     }
 
     ~JointStateInputConstraint() override = default;
@@ -109,27 +128,33 @@ class JointStateInputConstraint final : public ocs2::StateInputConstraint {
 
     VecXd getValue(ocs2::scalar_t time, const VecXd& state, const VecXd& input,
                    const ocs2::PreComputation&) const override {
-        VecXd f = C_ * state + D_ * input + e_;
-        return f;
+        refresh_value(state, input);
+        return approx_.f;
     }
 
     ocs2::VectorFunctionLinearApproximation getLinearApproximation(
         ocs2::scalar_t time, const VecXd& state, const VecXd& input,
         const ocs2::PreComputation&) const {
-        ocs2::VectorFunctionLinearApproximation g;
-        g.f = C_ * state + D_ * input + e_;
-        g.dfdx = C_;
-        g.dfdu = D_;
-        return g;
+        refresh_value(state, input);
+        return approx_;
     }
 
    private:
     JointStateInputConstraint(const JointStateInputConstraint& other) = default;
 
+    // f = C * x + D * u + e, computed in place into the cached approximation.
+    void refresh_value(const VecXd& state, const VecXd& input) const {
+        approx_.f = e_;
+        approx_.f.noalias() += C_ * state;
+        approx_.f.noalias() += D_ * input;
+    }
+
     OptimizationDimensions dims_;
     MatXd C_;
     MatXd D_;
     VecXd e_;
+    // Cached approximation with constant derivatives; see JointStateInputLimits.
+    mutable ocs2::VectorFunctionLinearApproximation approx_;
 };
 
 }  // namespace upright
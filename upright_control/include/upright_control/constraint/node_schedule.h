@@ -0,0 +1,189 @@
+#pragma once
+
+#include <ocs2_core/constraint/StateConstraint.h>
+#include <ocs2_core/constraint/StateInputConstraint.h>
+#include <ocs2_oc/synchronized_module/SolverSynchronizedModule.h>
+
+#include <upright_control/types.h>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace upright {
+
+// Node schedule for one constraint term: the term is evaluated at every
+// shooting node within dense_horizon of the start of the horizon and at
+// every stride-th node beyond it. The far end of the horizon is re-solved
+// many times before it is executed, so expensive terms (e.g. narrowphase
+// obstacle checking) can be subsampled there without losing fidelity where
+// it matters.
+struct NodeScheduleSettings {
+    bool enabled = false;
+
+    // Nodes within this duration of the horizon start are always evaluated
+    // [s].
+    ocs2::scalar_t dense_horizon = 0.5;
+
+    // Beyond the dense window, evaluate the term at every stride-th node.
+    size_t stride = 4;
+};
+
+// Decides per node time whether a scheduled term is evaluated. The horizon
+// start is re-anchored before every solve by NodeScheduleModule, so the
+// dense window always covers the part of the plan about to be executed.
+class NodeSchedule {
+   public:
+    // dt is the shooting node spacing (sqp.dt), used to map node times to
+    // node indices.
+    NodeSchedule(const NodeScheduleSettings& settings, ocs2::scalar_t dt)
+        : settings_(settings), dt_(dt) {
+        if (settings.stride == 0) {
+            throw std::runtime_error(
+                "Node schedule stride must be positive.");
+        }
+    }
+
+    void set_horizon_start(ocs2::scalar_t t0) { t0_ = t0; }
+
+    // Thread safety: set_horizon_start runs in the solver synchronization
+    // hook before the worker threads are dispatched, so t0 is constant while
+    // the per-thread problem clones (which share this schedule) evaluate
+    // their constraints.
+    bool node_active(ocs2::scalar_t time) const {
+        if (!settings_.enabled) {
+            return true;
+        }
+        const ocs2::scalar_t offset = time - t0_;
+        // Half-node tolerance so event-adjusted node times near the window
+        // boundary still count as inside it.
+        if (offset <= settings_.dense_horizon + 0.5 * dt_) {
+            return true;
+        }
+        const size_t k = static_cast<size_t>(std::lround(offset / dt_));
+        return k % settings_.stride == 0;
+    }
+
+   private:
+    NodeScheduleSettings settings_;
+    ocs2::scalar_t dt_;
+    ocs2::scalar_t t0_ = 0;
+};
+
+// Re-anchors the node schedules to each solve's horizon start.
+class NodeScheduleModule final : public ocs2::SolverSynchronizedModule {
+   public:
+    explicit NodeScheduleModule(
+        std::vector<std::shared_ptr<NodeSchedule>> schedules)
+        : schedule_ptrs_(std::move(schedules)) {}
+
+    void preSolverRun(ocs2::scalar_t initTime, ocs2::scalar_t /*finalTime*/,
+                      const VecXd& /*currentState*/,
+                      const ocs2::ReferenceManagerInterface&
+                      /*referenceManager*/) override {
+        for (auto& schedule_ptr : schedule_ptrs_) {
+            schedule_ptr->set_horizon_start(initTime);
+        }
+    }
+
+    void postSolverRun(const ocs2::PrimalSolution& /*primalSolution*/)
+        override {}
+
+   private:
+    std::vector<std::shared_ptr<NodeSchedule>> schedule_ptrs_;
+};
+
+// Evaluates the wrapped constraint only at the scheduled nodes; at the
+// others its rows drop out of the problem seen by the solver.
+class NodeScheduledConstraint final : public ocs2::StateConstraint {
+   public:
+    NodeScheduledConstraint(std::unique_ptr<ocs2::StateConstraint> constraint,
+                            std::shared_ptr<const NodeSchedule> schedule)
+        : ocs2::StateConstraint(constraint->getOrder()),
+          constraint_ptr_(std::move(constraint)),
+          schedule_ptr_(std::move(schedule)) {}
+
+    NodeScheduledConstraint(const NodeScheduledConstraint& other)
+        : ocs2::StateConstraint(other),
+          constraint_ptr_(other.constraint_ptr_->clone()),
+          schedule_ptr_(other.schedule_ptr_) {}
+
+    NodeScheduledConstraint* clone() const override {
+        return new NodeScheduledConstraint(*this);
+    }
+
+    bool isActive(ocs2::scalar_t time) const override {
+        return constraint_ptr_->isActive(time) &&
+               schedule_ptr_->node_active(time);
+    }
+
+    size_t getNumConstraints(ocs2::scalar_t time) const override {
+        return constraint_ptr_->getNumConstraints(time);
+    }
+
+    VecXd getValue(ocs2::scalar_t time, const VecXd& state,
+                   const ocs2::PreComputation& pre_comp) const override {
+        return constraint_ptr_->getValue(time, state, pre_comp);
+    }
+
+    ocs2::VectorFunctionLinearApproximation getLinearApproximation(
+        ocs2::scalar_t time, const VecXd& state,
+        const ocs2::PreComputation& pre_comp) const override {
+        return constraint_ptr_->getLinearApproximation(time, state, pre_comp);
+    }
+
+   private:
+    std::unique_ptr<ocs2::StateConstraint> constraint_ptr_;
+    std::shared_ptr<const NodeSchedule> schedule_ptr_;
+};
+
+// State-input counterpart of NodeScheduledConstraint, for terms that also
+// depend on the inputs (e.g. the balancing and contact force constraints).
+class NodeScheduledStateInputConstraint final
+    : public ocs2::StateInputConstraint {
+   public:
+    NodeScheduledStateInputConstraint(
+        std::unique_ptr<ocs2::StateInputConstraint> constraint,
+        std::shared_ptr<const NodeSchedule> schedule)
+        : ocs2::StateInputConstraint(constraint->getOrder()),
+          constraint_ptr_(std::move(constraint)),
+          schedule_ptr_(std::move(schedule)) {}
+
+    NodeScheduledStateInputConstraint(
+        const NodeScheduledStateInputConstraint& other)
+        : ocs2::StateInputConstraint(other),
+          constraint_ptr_(other.constraint_ptr_->clone()),
+          schedule_ptr_(other.schedule_ptr_) {}
+
+    NodeScheduledStateInputConstraint* clone() const override {
+        return new NodeScheduledStateInputConstraint(*this);
+    }
+
+    bool isActive(ocs2::scalar_t time) const override {
+        return constraint_ptr_->isActive(time) &&
+               schedule_ptr_->node_active(time);
+    }
+
+    size_t getNumConstraints(ocs2::scalar_t time) const override {
+        return constraint_ptr_->getNumConstraints(time);
+    }
+
+    VecXd getValue(ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+                   const ocs2::PreComputation& pre_comp) const override {
+        return constraint_ptr_->getValue(time, state, input, pre_comp);
+    }
+
+    ocs2::VectorFunctionLinearApproximation getLinearApproximation(
+        ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+        const ocs2::PreComputation& pre_comp) const override {
+        return constraint_ptr_->getLinearApproximation(time, state, input,
+                                                       pre_comp);
+    }
+
+   private:
+    std::unique_ptr<ocs2::StateInputConstraint> constraint_ptr_;
+    std::shared_ptr<const NodeSchedule> schedule_ptr_;
+};
+
+}  // namespace upright
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <pinocchio/fwd.hpp>
+
+#include <pinocchio/algorithm/geometry.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
+
+#include <ocs2_core/constraint/StateConstraint.h>
+#include <ocs2_oc/synchronized_module/SolverSynchronizedModule.h>
+#include <ocs2_pinocchio_interface/PinocchioGeometryInterface.h>
+#include <ocs2_pinocchio_interface/PinocchioInterface.h>
+
+#include <upright_control/constraint/obstacle_constraint.h>
+#include <upright_control/dimensions.h>
+#include <upright_control/dynamics/system_pinocchio_mapping.h>
+#include <upright_control/types.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace upright {
+
+// Broadphase layer for obstacle avoidance. Narrowphase distances are cached
+// per collision pair along with a temporal-coherence certificate: a pair
+// separated by distance d cannot reach the minimum distance for
+// (d - minimum_distance - safety_margin) / velocity_bound seconds, where the
+// velocity bound is a configured upper bound on the closing speed of any
+// pair. Pairs with a valid certificate skip narrowphase entirely, and a
+// whole constraint group drops out of the problem seen by the solver when
+// every pair in it is certified for the full horizon. The certificate is
+// sound as long as the configured velocity bound holds; the safety margin
+// adds the conservatism we certify against.
+class ObstacleBroadphase {
+   public:
+    // The geometry interface must already contain all collision pairs;
+    // pair_groups maps each pair (in registration order) to the constraint
+    // group gated on it.
+    ObstacleBroadphase(const ocs2::PinocchioInterface& pinocchio_interface,
+                       const ocs2::PinocchioGeometryInterface& geom_interface,
+                       const ObstacleSettings& settings,
+                       const OptimizationDimensions& dims,
+                       const std::vector<size_t>& pair_groups,
+                       size_t num_groups)
+        : pinocchio_interface_(pinocchio_interface),
+          geom_interface_(geom_interface),
+          geom_data_(geom_interface_.getGeometryModel()),
+          mapping_(dims),
+          settings_(settings),
+          pair_groups_(pair_groups),
+          valid_until_(pair_groups.size(),
+                       -std::numeric_limits<ocs2::scalar_t>::infinity()),
+          group_active_(num_groups, 1) {}
+
+    // Refresh the certificates for the solve over [t0, t_final] at the
+    // current state. Called from the solver synchronization hook before each
+    // solve; the activity flags are constant while the solver runs, so the
+    // constraint dimension is consistent within a solve.
+    void update(ocs2::scalar_t t0, ocs2::scalar_t t_final, const VecXd& x) {
+        const auto& model = pinocchio_interface_.getModel();
+        auto& data = pinocchio_interface_.getData();
+        const auto& geom_model = geom_interface_.getGeometryModel();
+
+        bool placements_updated = false;
+        for (size_t i = 0; i < pair_groups_.size(); ++i) {
+            // Temporal coherence: skip the narrowphase query while the
+            // certificate from a previous solve still holds.
+            if (t0 < valid_until_[i]) {
+                continue;
+            }
+            if (!placements_updated) {
+                const VecXd q = mapping_.getPinocchioJointPosition(x);
+                pinocchio::forwardKinematics(model, data, q);
+                pinocchio::updateGeometryPlacements(model, data, geom_model,
+                                                    geom_data_);
+                placements_updated = true;
+            }
+            const auto& result =
+                pinocchio::computeDistance(geom_model, geom_data_, i);
+            const ocs2::scalar_t slack = result.min_distance -
+                                         settings_.minimum_distance -
+                                         settings_.broadphase_safety_margin;
+            valid_until_[i] =
+                t0 + std::max(slack, ocs2::scalar_t(0)) /
+                         settings_.broadphase_velocity_bound;
+        }
+
+        // A group stays in the problem if any of its pairs could violate
+        // before the end of the horizon.
+        std::fill(group_active_.begin(), group_active_.end(), 0);
+        for (size_t i = 0; i < pair_groups_.size(); ++i) {
+            if (valid_until_[i] < t_final) {
+                group_active_[pair_groups_[i]] = 1;
+            }
+        }
+    }
+
+    // Thread safety: the gated constraints (and their per-thread clones when
+    // the solver linearizes in parallel) only ever read the activity flags,
+    // and update() runs in the solver synchronization hook before the worker
+    // threads are dispatched, so the flags are constant while they run. The
+    // thread pool's task handoff orders the writes before the reads.
+    bool group_active(size_t group) const {
+        return group_active_[group] != 0;
+    }
+
+   private:
+    ocs2::PinocchioInterface pinocchio_interface_;
+    ocs2::PinocchioGeometryInterface geom_interface_;
+    pinocchio::GeometryData geom_data_;
+    SystemPinocchioMapping<TripleIntegratorPinocchioMapping<ocs2::scalar_t>,
+                           ocs2::scalar_t>
+        mapping_;
+    ObstacleSettings settings_;
+
+    // Group index for each collision pair.
+    std::vector<size_t> pair_groups_;
+
+    // Time up to which each pair's cached separation certifies it cannot
+    // reach the minimum distance.
+    std::vector<ocs2::scalar_t> valid_until_;
+    std::vector<uint8_t> group_active_;
+};
+
+// Hooks the broadphase into the solver so the certificates are refreshed at
+// the measured state before every solve.
+class ObstacleBroadphaseModule final : public ocs2::SolverSynchronizedModule {
+   public:
+    explicit ObstacleBroadphaseModule(
+        std::shared_ptr<ObstacleBroadphase> broadphase)
+        : broadphase_ptr_(std::move(broadphase)) {}
+
+    void preSolverRun(ocs2::scalar_t initTime, ocs2::scalar_t finalTime,
+                      const VecXd& currentState,
+                      const ocs2::ReferenceManagerInterface&
+                      /*referenceManager*/) override {
+        broadphase_ptr_->update(initTime, finalTime, currentState);
+    }
+
+    void postSolverRun(const ocs2::PrimalSolution& /*primalSolution*/)
+        override {}
+
+   private:
+    std::shared_ptr<ObstacleBroadphase> broadphase_ptr_;
+};
+
+// Gates one narrowphase collision constraint group on the broadphase: when
+// every pair in the group is certified separated for the full horizon, the
+// group reports itself inactive and its rows drop out of the problem.
+class BroadphaseGatedConstraint final : public ocs2::StateConstraint {
+   public:
+    BroadphaseGatedConstraint(
+        std::unique_ptr<ocs2::StateConstraint> constraint,
+        std::shared_ptr<const ObstacleBroadphase> broadphase, size_t group)
+        : ocs2::StateConstraint(constraint->getOrder()),
+          constraint_ptr_(std::move(constraint)),
+          broadphase_ptr_(std::move(broadphase)),
+          group_(group) {}
+
+    BroadphaseGatedConstraint(const BroadphaseGatedConstraint& other)
+        : ocs2::StateConstraint(other),
+          constraint_ptr_(other.constraint_ptr_->clone()),
+          broadphase_ptr_(other.broadphase_ptr_),
+          group_(other.group_) {}
+
+    BroadphaseGatedConstraint* clone() const override {
+        return new BroadphaseGatedConstraint(*this);
+    }
+
+    bool isActive(ocs2::scalar_t time) const override {
+        return constraint_ptr_->isActive(time) &&
+               broadphase_ptr_->group_active(group_);
+    }
+
+    size_t getNumConstraints(ocs2::scalar_t time) const override {
+        return constraint_ptr_->getNumConstraints(time);
+    }
+
+    VecXd getValue(ocs2::scalar_t time, const VecXd& state,
+                   const ocs2::PreComputation& pre_comp) const override {
+        return constraint_ptr_->getValue(time, state, pre_comp);
+    }
+
+    ocs2::VectorFunctionLinearApproximation getLinearApproximation(
+        ocs2::scalar_t time, const VecXd& state,
+        const ocs2::PreComputation& pre_comp) const override {
+        return constraint_ptr_->getLinearApproximation(time, state, pre_comp);
+    }
+
+   private:
+    std::unique_ptr<ocs2::StateConstraint> constraint_ptr_;
+    std::shared_ptr<const ObstacleBroadphase> broadphase_ptr_;
+    size_t group_;
+};
+
+}  // namespace upright
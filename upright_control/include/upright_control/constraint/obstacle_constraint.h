@@ -1,6 +1,7 @@
 #pragma once
 
 #include <upright_control/constraint/constraint_type.h>
+#include <upright_control/constraint/node_schedule.h>
 #include <upright_control/reference_trajectory.h>
 #include <upright_control/types.h>
 
@@ -76,6 +77,23 @@ struct ObstacleSettings {
     ocs2::scalar_t mu = 1e-2;
     ocs2::scalar_t delta = 1e-3;
 
+    // True to enable broadphase pruning: collision pairs are grouped per
+    // obstacle link and a group is dropped from a solve when cached
+    // distances certify that none of its pairs can reach the minimum
+    // distance within the horizon.
+    bool use_broadphase = false;
+
+    // Upper bound on the closing speed between any collision pair [m/s],
+    // used to compute how long a cached separation remains valid.
+    ocs2::scalar_t broadphase_velocity_bound = 2.0;
+
+    // Extra separation subtracted from every broadphase certificate [m].
+    ocs2::scalar_t broadphase_safety_margin = 0.05;
+
+    // Horizon node schedule: when enabled, the obstacle constraints are only
+    // evaluated at every stride-th node beyond the dense window.
+    NodeScheduleSettings node_schedule;
+
     // URDF of static obstacles
     std::string obstacle_urdf_path;
 
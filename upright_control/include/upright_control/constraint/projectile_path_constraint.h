@@ -2,10 +2,16 @@
 
 #include <ocs2_core/constraint/StateConstraint.h>
 #include <ocs2_oc/synchronized_module/ReferenceManager.h>
+#include <ocs2_oc/synchronized_module/SolverSynchronizedModule.h>
 #include <ocs2_robotic_tools/end_effector/EndEffectorKinematics.h>
 #include <upright_control/reference_trajectory.h>
 #include <upright_control/types.h>
 
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
 namespace upright {
 
 // Use Newton's method to find roots of cubic equation
@@ -43,17 +49,94 @@ ocs2::scalar_t projectile_closest_time(const Vec3d& r, const Vec3d& r0,
     return t;
 }
 
+// Cache of Newton seeds for the closest-approach times computed by
+// ProjectilePathConstraint. The closest time for a given (node time, link)
+// pair changes only slightly between SQP iterations and between consecutive
+// solves, so each converged solution is stored in a bucket indexed by node
+// time and used as the initial guess the next time that bucket is queried.
+// With a warm seed the Newton iteration hits its tolerance in one or two
+// steps instead of running cold from zero per link, per node, per iteration.
+//
+// The cache is shared between the constraint and its per-thread clones when
+// the solver linearizes in parallel; the seeds are relaxed atomics, since a
+// stale or torn-ordered seed only costs an extra Newton step.
+class ProjectileArcCache {
+   public:
+    ProjectileArcCache(size_t num_links, size_t num_buckets)
+        : num_links_(num_links),
+          num_buckets_(num_buckets),
+          seeds_(num_links * num_buckets) {
+        for (auto& seed : seeds_) {
+            seed.store(0.0, std::memory_order_relaxed);
+        }
+    }
+
+    // Re-anchor the bucket grid to the solve over [t0, t_final]. Called from
+    // the solver synchronization hook before each solve; the seeds themselves
+    // are kept, since consecutive solves shift the node times only slightly.
+    void update(ocs2::scalar_t t0, ocs2::scalar_t t_final) {
+        t0_ = t0;
+        bucket_width_ = std::max((t_final - t0) / num_buckets_,
+                                 ocs2::scalar_t(1e-3));
+    }
+
+    ocs2::scalar_t seed(ocs2::scalar_t time, size_t link) const {
+        return seeds_[index(time, link)].load(std::memory_order_relaxed);
+    }
+
+    void store_seed(ocs2::scalar_t time, size_t link, ocs2::scalar_t dt) {
+        seeds_[index(time, link)].store(dt, std::memory_order_relaxed);
+    }
+
+   private:
+    size_t index(ocs2::scalar_t time, size_t link) const {
+        const ocs2::scalar_t s = (time - t0_) / bucket_width_;
+        const size_t bucket = std::min(
+            num_buckets_ - 1, static_cast<size_t>(std::max(s, ocs2::scalar_t(0))));
+        return bucket * num_links_ + link;
+    }
+
+    size_t num_links_;
+    size_t num_buckets_;
+    ocs2::scalar_t t0_ = 0;
+    ocs2::scalar_t bucket_width_ = 1;
+    std::vector<std::atomic<ocs2::scalar_t>> seeds_;
+};
+
+// Hooks the arc cache into the solver so the bucket grid tracks the horizon
+// of each solve.
+class ProjectileArcCacheModule final : public ocs2::SolverSynchronizedModule {
+   public:
+    explicit ProjectileArcCacheModule(std::shared_ptr<ProjectileArcCache> cache)
+        : cache_ptr_(std::move(cache)) {}
+
+    void preSolverRun(ocs2::scalar_t initTime, ocs2::scalar_t finalTime,
+                      const VecXd& /*currentState*/,
+                      const ocs2::ReferenceManagerInterface&
+                      /*referenceManager*/) override {
+        cache_ptr_->update(initTime, finalTime);
+    }
+
+    void postSolverRun(const ocs2::PrimalSolution& /*primalSolution*/)
+        override {}
+
+   private:
+    std::shared_ptr<ProjectileArcCache> cache_ptr_;
+};
+
 class ProjectilePathConstraint final : public ocs2::StateConstraint {
    public:
     ProjectilePathConstraint(
         const ocs2::EndEffectorKinematics<ocs2::scalar_t>& kinematics,
         const ocs2::ReferenceManager& reference_manager, const VecXd& distances,
-        ocs2::scalar_t scale)
+        ocs2::scalar_t scale,
+        std::shared_ptr<ProjectileArcCache> arc_cache = nullptr)
         : ocs2::StateConstraint(ocs2::ConstraintOrder::Linear),
           kinematics_ptr_(kinematics.clone()),
           reference_manager_ptr_(&reference_manager),
           distances_(distances),
-          scale_(scale) {
+          scale_(scale),
+          arc_cache_ptr_(std::move(arc_cache)) {
         if (kinematics.getIds().size() != distances.size()) {
             std::cout << "num ids = " << kinematics.getIds().size() << std::endl;
             std::cout << "num dists = " << distances.size() << std::endl;
@@ -65,8 +148,11 @@ class ProjectilePathConstraint final : public ocs2::StateConstraint {
     ~ProjectilePathConstraint() override = default;
 
     ProjectilePathConstraint* clone() const override {
-        return new ProjectilePathConstraint(
-            *kinematics_ptr_, *reference_manager_ptr_, distances_, scale_);
+        // Clones share the arc cache, so seeds found by one clone warm the
+        // others.
+        return new ProjectilePathConstraint(*kinematics_ptr_,
+                                            *reference_manager_ptr_,
+                                            distances_, scale_, arc_cache_ptr_);
     }
 
     size_t getNumConstraints(ocs2::scalar_t time) const override {
@@ -91,7 +177,7 @@ class ProjectilePathConstraint final : public ocs2::StateConstraint {
 
             ocs2::scalar_t dt = 0.0;
             if (s > 0.5) {
-                dt = projectile_closest_time(r_ew_w, r_obs, v_obs, a_obs, 0.0);
+                dt = closest_time(time, i, r_ew_w, r_obs, v_obs, a_obs);
                 dt = std::max(0.0, dt);
             }
             Vec3d r_closest = r_obs + dt * v_obs + 0.5 * dt * dt * a_obs;
@@ -128,7 +214,7 @@ class ProjectilePathConstraint final : public ocs2::StateConstraint {
 
             ocs2::scalar_t dt = 0.0;
             if (s > 0.5) {
-                dt = projectile_closest_time(r_ew_w, r_obs, v_obs, a_obs, 0.0);
+                dt = closest_time(time, i, r_ew_w, r_obs, v_obs, a_obs);
                 dt = std::max(0.0, dt);  // don't care about the past
             }
             MatXd A_obs(3, 9);
@@ -159,11 +245,30 @@ class ProjectilePathConstraint final : public ocs2::StateConstraint {
    private:
     ProjectilePathConstraint(const ProjectilePathConstraint& other) = default;
 
+    // Closest-approach time of the arc to point r_ew_w, seeded from the arc
+    // cache when one is attached. The Newton iteration exits on tolerance,
+    // so a warm seed reduces it to a single polish step.
+    ocs2::scalar_t closest_time(ocs2::scalar_t time, size_t link,
+                                const Vec3d& r_ew_w, const Vec3d& r_obs,
+                                const Vec3d& v_obs, const Vec3d& a_obs) const {
+        ocs2::scalar_t guess = 0.0;
+        if (arc_cache_ptr_ != nullptr) {
+            guess = arc_cache_ptr_->seed(time, link);
+        }
+        const ocs2::scalar_t dt =
+            projectile_closest_time(r_ew_w, r_obs, v_obs, a_obs, guess);
+        if (arc_cache_ptr_ != nullptr) {
+            arc_cache_ptr_->store_seed(time, link, dt);
+        }
+        return dt;
+    }
+
     ocs2::scalar_t scale_;
     VecXd distances_;
     std::unique_ptr<ocs2::EndEffectorKinematics<ocs2::scalar_t>>
         kinematics_ptr_;
     const ocs2::ReferenceManager* reference_manager_ptr_;
+    std::shared_ptr<ProjectileArcCache> arc_cache_ptr_;
 };
 
 }  // namespace upright
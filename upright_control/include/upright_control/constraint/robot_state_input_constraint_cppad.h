@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <ocs2_core/automatic_differentiation/CppAdInterface.h>
+#include <ocs2_core/constraint/StateInputConstraint.h>
+
+#include <upright_control/dimensions.h>
+#include <upright_control/types.h>
+
+namespace upright {
+
+// Base class for auto-differentiated constraints that depend only on the
+// robot portion of the state. The optimization state appends nine entries per
+// dynamic obstacle to the robot state, but the balancing and alignment
+// constraints never touch them, so the corresponding Jacobian columns are
+// structurally zero. Unlike ocs2::StateInputConstraintCppAd, which tapes over
+// the full state, this class tapes over [t; robot state; input] only: the
+// obstacle entries are AD constants inside the tape, so the generated model
+// is smaller and the per-node Jacobian evaluation skips the dead columns. The
+// zero columns are restored when the (dense) linear approximation is
+// assembled for the solver.
+//
+// Only ocs2::ConstraintOrder::Linear is supported, which is all the derived
+// constraints use.
+class RobotStateInputConstraintCppAd : public ocs2::StateInputConstraint {
+   public:
+    ~RobotStateInputConstraintCppAd() override = default;
+
+    VecXd getValue(ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+                   const ocs2::PreComputation&) const override;
+
+    ocs2::VectorFunctionLinearApproximation getLinearApproximation(
+        ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+        const ocs2::PreComputation&) const override;
+
+    virtual VecXd getParameters(ocs2::scalar_t time) const {
+        // Parameters are constant for now
+        return VecXd(0);
+    }
+
+   protected:
+    RobotStateInputConstraintCppAd(ocs2::ConstraintOrder order,
+                                   const OptimizationDimensions& dims)
+        : ocs2::StateInputConstraint(order), dims_(dims) {}
+
+    // Tape constraintFunction over [t; robot state; input] and compile (or
+    // load) the generated library. Must be called from the derived
+    // constructor, after any members used by constraintFunction are set up.
+    void initialize(size_t num_params, const std::string& model_name,
+                    const std::string& model_folder, bool recompile_libraries,
+                    bool verbose);
+
+    // Derived classes implement the constraint on the full-dimensional state;
+    // the obstacle entries they receive are AD constants (zero).
+    virtual VecXad constraintFunction(ocs2::ad_scalar_t time,
+                                      const VecXad& state, const VecXad& input,
+                                      const VecXad& parameters) const = 0;
+
+    OptimizationDimensions dims_;
+
+   private:
+    std::unique_ptr<ocs2::CppAdInterface> ad_interface_ptr_;
+};
+
+}  // namespace upright
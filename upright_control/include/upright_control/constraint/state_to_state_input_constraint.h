@@ -24,6 +24,10 @@ class StateToStateInputConstraint final : public ocs2::StateInputConstraint {
         return new StateToStateInputConstraint(*constraint_ptr_);
     }
 
+    bool isActive(ocs2::scalar_t time) const override {
+        return constraint_ptr_->isActive(time);
+    }
+
     size_t getNumConstraints(ocs2::scalar_t time) const override {
         return constraint_ptr_->getNumConstraints(time);
     }
@@ -38,13 +42,24 @@ class StateToStateInputConstraint final : public ocs2::StateInputConstraint {
         const ocs2::PreComputation& preComp) const override {
         ocs2::VectorFunctionLinearApproximation approx =
             constraint_ptr_->getLinearApproximation(time, state, preComp);
-        approx.dfdu.setZero(approx.dfdx.rows(), input.rows());
+        // The input Jacobian is identically zero; copy from a cached zero
+        // block instead of zero-filling a fresh matrix each call. The cache
+        // is resized only when the wrapped constraint changes dimension
+        // (e.g. the broadphase-gated obstacle constraints).
+        if (dfdu_zero_.rows() != approx.dfdx.rows() ||
+            dfdu_zero_.cols() != input.rows()) {
+            dfdu_zero_.setZero(approx.dfdx.rows(), input.rows());
+        }
+        approx.dfdu = dfdu_zero_;
         return approx;
     }
 
    private:
     // Underlying state constraint
     std::unique_ptr<ocs2::StateConstraint> constraint_ptr_;
+    // Cached zero input Jacobian; clones are per solver thread, so the
+    // mutable resize is not contended.
+    mutable MatXd dfdu_zero_;
 };
 
 }  // namespace upright
@@ -17,10 +17,16 @@
 
 #include <upright_control/constraint/obstacle_constraint.h>
 #include <upright_control/controller_settings.h>
+#include <upright_control/rti_monitor.h>
+#include <upright_control/solve_timing.h>
+#include <upright_control/rigid_body_state_kinematics.h>
 #include <upright_control/types.h>
 
 namespace upright {
 
+class ObstacleBroadphase;
+class ProjectileArcCache;
+
 class ControllerInterface final : public ocs2::RobotInterface {
    public:
     explicit ControllerInterface(const ControllerSettings& settings);
@@ -53,6 +59,18 @@ class ControllerInterface final : public ocs2::RobotInterface {
         return *end_effector_kinematics_ptr_;
     }
 
+    // Per-term solve-time accumulators for the cost, constraint, and
+    // dynamics terms assembled by this interface.
+    std::shared_ptr<SolveTimingRegistry> get_timing_registry() const {
+        return timing_registry_;
+    }
+
+    // Per-solve convergence statistics, recorded by the module registered in
+    // get_mpc(). Null until get_mpc() has been called.
+    std::shared_ptr<RtiMonitor> get_rti_monitor() const {
+        return rti_monitor_ptr_;
+    }
+
    private:
     std::unique_ptr<ocs2::StateInputCost> get_quadratic_state_input_cost();
 
@@ -80,36 +98,31 @@ class ControllerInterface final : public ocs2::RobotInterface {
 
     // Hard balancing inequality constraints.
     std::unique_ptr<ocs2::StateInputConstraint> get_balancing_constraint(
-        const ocs2::PinocchioEndEffectorKinematicsCppAd&
-            end_effector_kinematics,
-        bool recompileLibraries);
+        const RigidBodyStateKinematicsCppAd& kinematics,
+        const std::string& library_folder, bool recompileLibraries);
 
     // Soft version of the balancing constraints (i.e. formulated as a cost via
     // penalty functions).
     std::unique_ptr<ocs2::StateInputCost> get_soft_balancing_constraint(
-        const ocs2::PinocchioEndEffectorKinematicsCppAd&
-            end_effector_kinematics,
-        bool recompileLibraries);
+        const RigidBodyStateKinematicsCppAd& kinematics,
+        const std::string& library_folder, bool recompileLibraries);
 
     std::unique_ptr<ocs2::StateInputConstraint> get_object_dynamics_constraint(
-        const ocs2::PinocchioEndEffectorKinematicsCppAd&
-            end_effector_kinematics,
-        bool recompileLibraries);
+        const RigidBodyStateKinematicsCppAd& kinematics,
+        const std::string& library_folder, bool recompileLibraries);
 
     std::unique_ptr<ocs2::StateInputCost> get_soft_object_dynamics_constraint(
-        const ocs2::PinocchioEndEffectorKinematicsCppAd&
-            end_effector_kinematics,
-        bool recompileLibraries);
+        const RigidBodyStateKinematicsCppAd& kinematics,
+        const std::string& library_folder, bool recompileLibraries);
 
+    // The frictionless and linearized-cone models are linear in the inputs,
+    // so they are analytical and ignore the library arguments; the exact
+    // cone goes through the generated-model path.
     std::unique_ptr<ocs2::StateInputConstraint> get_contact_force_constraint(
-        const ocs2::PinocchioEndEffectorKinematicsCppAd&
-            end_effector_kinematics,
-        bool recompileLibraries);
+        const std::string& library_folder, bool recompileLibraries);
 
     std::unique_ptr<ocs2::StateInputCost> get_soft_contact_force_constraint(
-        const ocs2::PinocchioEndEffectorKinematicsCppAd&
-            end_effector_kinematics,
-        bool recompileLibraries);
+        const std::string& library_folder, bool recompileLibraries);
 
     ControllerSettings settings_;
     ocs2::OptimalControlProblem problem_;
@@ -119,6 +132,31 @@ class ControllerInterface final : public ocs2::RobotInterface {
     std::unique_ptr<ocs2::PinocchioInterface> pinocchio_interface_ptr;
     std::unique_ptr<ocs2::PinocchioEndEffectorKinematicsCppAd> end_effector_kinematics_ptr_;
 
+    // Broadphase pruning state shared between the gated obstacle constraints
+    // and the solver synchronization module registered in get_mpc(). Null
+    // unless obstacle broadphase pruning is enabled.
+    std::shared_ptr<ObstacleBroadphase> obstacle_broadphase_ptr_;
+
+    // Newton-seed cache shared between the projectile path constraint and
+    // the solver synchronization module registered in get_mpc(). Null unless
+    // the projectile path constraint is enabled.
+    std::shared_ptr<ProjectileArcCache> projectile_arc_cache_ptr_;
+
+    // Per-term horizon node schedules, re-anchored to the horizon start by
+    // the solver synchronization module registered in get_mpc(). Null unless
+    // the corresponding schedule is enabled.
+    std::shared_ptr<NodeSchedule> obstacle_node_schedule_ptr_;
+    std::shared_ptr<NodeSchedule> projectile_node_schedule_ptr_;
+    std::shared_ptr<NodeSchedule> balancing_node_schedule_ptr_;
+
+    // Per-term solve-time accumulators; the terms hold shared pointers to
+    // their timers, so the registry outlives any problem clones.
+    std::shared_ptr<SolveTimingRegistry> timing_registry_ =
+        std::make_shared<SolveTimingRegistry>();
+
+    // Per-solve convergence recorder; created in get_mpc().
+    std::shared_ptr<RtiMonitor> rti_monitor_ptr_;
+
     VecXd initial_state_;
 };
 
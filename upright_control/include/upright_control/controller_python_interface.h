@@ -8,6 +8,10 @@
 #include <upright_control/controller_interface.h>
 #include <upright_control/controller_settings.h>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 namespace upright {
 
 class ControllerPythonInterface final : public ocs2::PythonInterface {
@@ -56,10 +60,15 @@ class ControllerPythonInterface final : public ocs2::PythonInterface {
             t, x, u, *problem_.preComputationPtr);
     }
 
-    // Hard state-only inequality constraints
+    // Hard state-only inequality constraints. The state-only request
+    // variant still refreshes the precomputation cache (with a zero input):
+    // state-only terms may read the cached kinematics just like the
+    // state-input terms do.
     VecXd getStateInequalityConstraintValue(const std::string& name,
                                             ocs2::scalar_t t,
                                             Eigen::Ref<const VecXd> x) {
+        problem_.preComputationPtr->requestFinal(ocs2::Request::Constraint, t,
+                                                 x);
         return problem_.stateEqualityConstraintPtr->get(name).getValue(
             t, x, *problem_.preComputationPtr);
     }
@@ -68,12 +77,54 @@ class ControllerPythonInterface final : public ocs2::PythonInterface {
     VecXd getSoftStateInequalityConstraintValue(const std::string& name,
                                                 ocs2::scalar_t t,
                                                 Eigen::Ref<const VecXd> x) {
+        problem_.preComputationPtr->requestFinal(ocs2::Request::Constraint, t,
+                                                 x);
         return dynamic_cast<ocs2::StateSoftConstraint*>(
                    &problem_.stateSoftConstraintPtr->get(name))
             ->get()
             .getValue(t, x, *problem_.preComputationPtr);
     }
 
+    // Pull the current MPC solution out of the solver into persistent
+    // buffers, one trajectory point per row. The getters below return
+    // references into those buffers, which the bindings expose to Python as
+    // NumPy views rather than copies; the views stay valid until the next
+    // cacheMpcSolution() call, which may reallocate the buffers.
+    void cacheMpcSolution() {
+        ocs2::scalar_array_t ts;
+        ocs2::vector_array_t xs;
+        ocs2::vector_array_t us;
+        getMpcSolution(ts, xs, us);
+
+        const size_t n = ts.size();
+        ts_buffer_.resize(n);
+        xs_buffer_.resize(n, n > 0 ? xs[0].size() : 0);
+        us_buffer_.resize(n, n > 0 ? us[0].size() : 0);
+        for (size_t i = 0; i < n; ++i) {
+            ts_buffer_(i) = ts[i];
+            xs_buffer_.row(i) = xs[i];
+            us_buffer_.row(i) = us[i];
+        }
+    }
+
+    const VecXd& getCachedTimeTrajectory() const { return ts_buffer_; }
+    const MatXd& getCachedStateTrajectory() const { return xs_buffer_; }
+    const MatXd& getCachedInputTrajectory() const { return us_buffer_; }
+
+    // Accumulated per-term solve time [s] and evaluation counts since the
+    // last reset; see SolveTimingRegistry.
+    std::map<std::string, ocs2::scalar_t> getSolveTimingSeconds() const {
+        return control_interface_.get_timing_registry()->seconds();
+    }
+
+    std::map<std::string, ocs2::scalar_t> getSolveTimingCalls() const {
+        return control_interface_.get_timing_registry()->calls();
+    }
+
+    void resetSolveTimers() {
+        control_interface_.get_timing_registry()->reset();
+    }
+
     ocs2::scalar_t getCostValue(const std::string& name, ocs2::scalar_t t,
                                 Eigen::Ref<const VecXd> x,
                                 Eigen::Ref<const VecXd> u) {
@@ -83,9 +134,192 @@ class ControllerPythonInterface final : public ocs2::PythonInterface {
             t, x, u, target, *problem_.preComputationPtr);
     }
 
+    // Batch variants of the above getters, evaluating a whole trajectory of
+    // (t, x, u) points (rows of xs and us) across num_threads worker
+    // threads. Point i's constraint value is returned in row i of the
+    // output. Intended for offline analysis over logged trajectories, where
+    // per-point Python calls dominate the wall time; the bindings release
+    // the GIL for the duration of the batch.
+    MatXd getSoftStateInputInequalityConstraintValueBatch(
+        const std::string& name, const VecXd& ts, const MatXd& xs,
+        const MatXd& us, size_t num_threads) {
+        checkBatchDimensions(ts, xs, us);
+        return evaluateBatch(
+            [&](ocs2::OptimalControlProblem& problem, size_t i) -> VecXd {
+                const VecXd x = xs.row(i);
+                const VecXd u = us.row(i);
+                problem.preComputationPtr->request(ocs2::Request::Constraint,
+                                                   ts(i), x, u);
+                return dynamic_cast<ocs2::StateInputSoftConstraint*>(
+                           &problem.softConstraintPtr->get(name))
+                    ->get()
+                    .getValue(ts(i), x, u, *problem.preComputationPtr);
+            },
+            ts.size(), num_threads);
+    }
+
+    MatXd getStateInputInequalityConstraintValueBatch(
+        const std::string& name, const VecXd& ts, const MatXd& xs,
+        const MatXd& us, size_t num_threads) {
+        checkBatchDimensions(ts, xs, us);
+        return evaluateBatch(
+            [&](ocs2::OptimalControlProblem& problem, size_t i) -> VecXd {
+                const VecXd x = xs.row(i);
+                const VecXd u = us.row(i);
+                problem.preComputationPtr->request(ocs2::Request::Constraint,
+                                                   ts(i), x, u);
+                return problem.inequalityConstraintPtr->get(name).getValue(
+                    ts(i), x, u, *problem.preComputationPtr);
+            },
+            ts.size(), num_threads);
+    }
+
+    MatXd getStateInputEqualityConstraintValueBatch(const std::string& name,
+                                                    const VecXd& ts,
+                                                    const MatXd& xs,
+                                                    const MatXd& us,
+                                                    size_t num_threads) {
+        checkBatchDimensions(ts, xs, us);
+        return evaluateBatch(
+            [&](ocs2::OptimalControlProblem& problem, size_t i) -> VecXd {
+                const VecXd x = xs.row(i);
+                const VecXd u = us.row(i);
+                problem.preComputationPtr->request(ocs2::Request::Constraint,
+                                                   ts(i), x, u);
+                return problem.equalityConstraintPtr->get(name).getValue(
+                    ts(i), x, u, *problem.preComputationPtr);
+            },
+            ts.size(), num_threads);
+    }
+
+    MatXd getStateInequalityConstraintValueBatch(const std::string& name,
+                                                 const VecXd& ts,
+                                                 const MatXd& xs,
+                                                 size_t num_threads) {
+        if (xs.rows() != ts.size()) {
+            throw std::runtime_error(
+                "[ControllerPythonInterface] ts and xs must have the same "
+                "number of rows.");
+        }
+        return evaluateBatch(
+            [&](ocs2::OptimalControlProblem& problem, size_t i) -> VecXd {
+                const VecXd x = xs.row(i);
+                problem.preComputationPtr->requestFinal(
+                    ocs2::Request::Constraint, ts(i), x);
+                return problem.stateEqualityConstraintPtr->get(name).getValue(
+                    ts(i), x, *problem.preComputationPtr);
+            },
+            ts.size(), num_threads);
+    }
+
+    MatXd getSoftStateInequalityConstraintValueBatch(const std::string& name,
+                                                     const VecXd& ts,
+                                                     const MatXd& xs,
+                                                     size_t num_threads) {
+        if (xs.rows() != ts.size()) {
+            throw std::runtime_error(
+                "[ControllerPythonInterface] ts and xs must have the same "
+                "number of rows.");
+        }
+        return evaluateBatch(
+            [&](ocs2::OptimalControlProblem& problem, size_t i) -> VecXd {
+                const VecXd x = xs.row(i);
+                problem.preComputationPtr->requestFinal(
+                    ocs2::Request::Constraint, ts(i), x);
+                return dynamic_cast<ocs2::StateSoftConstraint*>(
+                           &problem.stateSoftConstraintPtr->get(name))
+                    ->get()
+                    .getValue(ts(i), x, *problem.preComputationPtr);
+            },
+            ts.size(), num_threads);
+    }
+
+    VecXd getCostValueBatch(const std::string& name, const VecXd& ts,
+                            const MatXd& xs, const MatXd& us,
+                            size_t num_threads) {
+        checkBatchDimensions(ts, xs, us);
+        // Target trajectories are shared across threads; access is
+        // read-only.
+        const auto& target = control_interface_.getReferenceManagerPtr()
+                                 ->getTargetTrajectories();
+        MatXd costs = evaluateBatch(
+            [&](ocs2::OptimalControlProblem& problem, size_t i) -> VecXd {
+                const VecXd x = xs.row(i);
+                const VecXd u = us.row(i);
+                VecXd value(1);
+                value(0) = problem.costPtr->get(name).getValue(
+                    ts(i), x, u, target, *problem.preComputationPtr);
+                return value;
+            },
+            ts.size(), num_threads);
+        return costs.col(0);
+    }
+
    private:
+    static void checkBatchDimensions(const VecXd& ts, const MatXd& xs,
+                                       const MatXd& us) {
+        if (xs.rows() != ts.size() || us.rows() != ts.size()) {
+            throw std::runtime_error(
+                "[ControllerPythonInterface] ts, xs, and us must have the "
+                "same number of rows.");
+        }
+    }
+
+    // Shared driver for the batch getters: evaluates eval(problem, i) for
+    // each point index i < n across a pool of worker threads. Evaluation of
+    // the compiled auto-diff models is stateful, so each worker operates on
+    // its own deep copy of the optimal control problem; the first point is
+    // evaluated up front to size the output.
+    template <typename Func>
+    MatXd evaluateBatch(Func eval, size_t n, size_t num_threads) {
+        if (n == 0) {
+            return MatXd(0, 0);
+        }
+
+        const VecXd first = eval(problem_, 0);
+        MatXd values(n, first.size());
+        values.row(0) = first.transpose();
+
+        num_threads = std::max(size_t(1), std::min(num_threads, n - 1));
+        std::atomic<size_t> next_index{1};
+        std::exception_ptr worker_exception;
+        std::mutex exception_mutex;
+
+        auto worker = [&]() {
+            try {
+                ocs2::OptimalControlProblem problem = problem_;
+                size_t i;
+                while ((i = next_index.fetch_add(1)) < n) {
+                    values.row(i) = eval(problem, i).transpose();
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                if (!worker_exception) {
+                    worker_exception = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_threads; ++i) {
+            threads.emplace_back(worker);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (worker_exception) {
+            std::rethrow_exception(worker_exception);
+        }
+        return values;
+    }
+
     ControllerInterface control_interface_;
     ocs2::OptimalControlProblem problem_;
+
+    // Buffers backing the cached-solution views; see cacheMpcSolution().
+    VecXd ts_buffer_;
+    MatXd xs_buffer_;
+    MatXd us_buffer_;
 };
 
 }  // namespace upright
@@ -16,6 +16,29 @@
 
 namespace upright {
 
+// Real-time scheduling applied at node startup. Priorities are SCHED_FIFO
+// priorities (1-99); zero leaves the default CFS scheduling in place. CPU
+// lists pin the process and every thread it subsequently spawns; empty
+// lists leave placement to the kernel. Application is best-effort: missing
+// privileges are reported at startup, not fatal.
+struct RealtimeSettings {
+    // SCHED_FIFO priority for the tracking (MRT) node's control loop.
+    int control_priority = 0;
+
+    // SCHED_FIFO priority for the MPC node. Keep this below the control
+    // priority so a long solve cannot delay the command loop.
+    int mpc_priority = 0;
+
+    // Cores for the tracking node and for the MPC node (whose solver worker
+    // pool inherits the mask). Use disjoint sets to keep the solver from
+    // preempting the control loop.
+    std::vector<int> control_cpus;
+    std::vector<int> mpc_cpus;
+
+    // Lock current and future pages into RAM (mlockall) so page faults
+    // cannot stall the control loop.
+    bool lock_memory = false;
+};
 
 struct TrackingSettings {
 
@@ -40,6 +63,27 @@ struct TrackingSettings {
     ocs2::scalar_t state_violation_margin = 0.1;
     ocs2::scalar_t input_violation_margin = 1.0;
     ocs2::scalar_t ee_position_violation_margin = 0.1;
+
+    // True to audit the hot tracking loop for heap allocations and abort if
+    // any occur in the sections that are supposed to be allocation-free.
+    bool realtime_strict = false;
+
+    // True to precompute a steady-state Kalman gain for the tracking
+    // estimator at the nominal loop timestep, instead of propagating the
+    // covariance and solving for the gain every tick.
+    bool use_steady_state_gain = false;
+
+    // Fall back to the time-varying filter update when the measured timestep
+    // deviates from the nominal one by more than this fraction of it.
+    ocs2::scalar_t steady_state_dt_tolerance = 0.2;
+
+    // True to exchange observations and policies with the MPC node through
+    // a shared-memory segment instead of ROS messages. Requires both nodes
+    // to run on the same host; leave false when they do not.
+    bool use_shm_transport = false;
+
+    // Scheduling applied by the MPC and tracking nodes at startup.
+    RealtimeSettings realtime;
 };
 
 struct EstimationSettings {
@@ -59,13 +103,39 @@ struct ControllerSettings {
     VecXd initial_state;
     Vec3d gravity;
 
-    // True to recompile the auto-diff libraries at the start of each run.
+    // True to force recompilation of all auto-diff libraries at the start of
+    // each run. When false, each model tracks a hash of the settings its tape
+    // consumes and recompiles only if those settings changed since the
+    // library was generated.
     bool recompile_libraries = true;
 
+    // True to cache generated libraries keyed by a hash of the settings that
+    // affect them, so byte-identical models are reused across runs and
+    // configs instead of being recompiled. Takes precedence over
+    // recompile_libraries when enabled.
+    bool use_library_cache = false;
+
+    // True to persist the solver's final trajectory on shutdown and reuse it
+    // as the initializer on the next run with the same settings and target,
+    // so the first solves after a restart do not start from scratch.
+    bool use_warm_start_store = false;
+
+    // Folder in which the warm-start trajectories are stored.
+    std::string warm_start_folder = "/tmp/upright/warm_start";
+
     // True will print/publish additional debugging info. This should be turned
     // off for higher performance.
     bool debug = false;
 
+    // Real-time iteration mode: cap every solve at a fixed SQP iteration
+    // budget so solve latency is bounded and predictable instead of varying
+    // with convergence. Each solve warm starts from the previous solution,
+    // so optimality is recovered across consecutive solves rather than
+    // within one; the residual suboptimality is reported per solve through
+    // the convergence diagnostics.
+    bool realtime_iteration = false;
+    int realtime_iteration_budget = 1;
+
     SolverMethod solver_method = SolverMethod::SQP;
     ocs2::mpc::Settings mpc;
     ocs2::multiple_shooting::Settings sqp;
@@ -78,6 +148,13 @@ struct ControllerSettings {
     MatXd state_weight;
     MatXd end_effector_weight;
 
+    // True to use the generated full-Hessian end effector pose cost instead
+    // of the analytical Gauss-Newton one. The exact Hessian converges in
+    // fewer SQP iterations on high-curvature reorientation segments at a
+    // higher cost per evaluation; compare the two on a given task with
+    // mpc_replay.
+    bool use_full_hessian_end_effector_cost = false;
+
     // Limits
     ConstraintType limit_constraint_type = ConstraintType::Soft;
     VecXd input_limit_lower;
@@ -101,6 +178,24 @@ struct ControllerSettings {
     ocs2::scalar_t projectile_path_scale;
     std::vector<std::string> projectile_path_collision_links;
 
+    // Horizon node schedule for the projectile path constraint; see
+    // NodeScheduleSettings.
+    NodeScheduleSettings projectile_path_node_schedule;
+
+    // Horizon node schedule shared by the input-dependent balancing terms
+    // (the balancing constraints and, in force mode, the friction cones).
+    // This is a move-blocking-style coarsening of the input parameterization:
+    // the solver still carries an input per node, but beyond the dense window
+    // the inputs are only constrained at every stride-th node, which shrinks
+    // the QP enough to run a longer horizon at equal solve time. The dense
+    // window guards the part of the plan that is actually executed before the
+    // next solve; keep it at least as long as the solve period. Off by
+    // default: enabling it relaxes the balancing guarantees in the far
+    // horizon. Only the hard and soft inequality rows are scheduled -- the
+    // object dynamics equality stays dense so the contact forces remain
+    // coupled to the object motion at every node.
+    NodeScheduleSettings balancing_node_schedule;
+
     // We can linearize around a set of operating points instead of just using
     // a stationary trajectory.
     bool use_operating_points = false;
@@ -151,8 +246,8 @@ struct ControllerSettings {
     }
 };
 
-std::ostream& operator<<(std::ostream& out,
-                         const ControllerSettings& settings) {
+inline std::ostream& operator<<(std::ostream& out,
+                                const ControllerSettings& settings) {
     out << "gravity = " << settings.gravity.transpose() << std::endl
         << "x0 = " << settings.initial_state.transpose() << std::endl
         << "input_weight = " << settings.input_weight << std::endl
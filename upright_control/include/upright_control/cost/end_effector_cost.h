@@ -6,6 +6,7 @@
 #include <ocs2_pinocchio_interface/PinocchioEndEffectorKinematicsCppAd.h>
 #include <ocs2_robotic_tools/end_effector/EndEffectorKinematics.h>
 
+#include <upright_control/precomputation.h>
 #include <upright_control/reference_trajectory.h>
 #include <upright_control/types.h>
 
@@ -32,12 +33,19 @@ class EndEffectorCost final : public ocs2::StateCost {
 
     ocs2::scalar_t getValue(ocs2::scalar_t time, const VecXd& state,
                             const ocs2::TargetTrajectories& target,
-                            const ocs2::PreComputation&) const override {
-        const auto desired_pose = interpolate_end_effector_pose(time, target);
+                            const ocs2::PreComputation& pre_comp) const override {
+        const auto desired_pose =
+            compiled_reference_.interpolate_pose(time, target);
+
+        // Use the position cached by the shared pre-computation if available.
+        const auto* precomputation =
+            dynamic_cast<const UprightPreComputation*>(&pre_comp);
+        const Vec3d position =
+            precomputation ? precomputation->getEndEffectorState().pose.position
+                           : kinematics_ptr_->getPosition(state).front();
 
         VecXd err = VecXd::Zero(6);
-        err.head<3>() =
-            kinematics_ptr_->getPosition(state).front() - desired_pose.first;
+        err.head<3>() = position - desired_pose.first;
         err.tail<3>() =
             kinematics_ptr_->getOrientationError(state, {desired_pose.second})
                 .front();
@@ -48,8 +56,9 @@ class EndEffectorCost final : public ocs2::StateCost {
     ocs2::ScalarFunctionQuadraticApproximation getQuadraticApproximation(
         ocs2::scalar_t time, const VecXd& state,
         const ocs2::TargetTrajectories& target,
-        const ocs2::PreComputation&) const override {
-        const auto desired_pose = interpolate_end_effector_pose(time, target);
+        const ocs2::PreComputation& pre_comp) const override {
+        const auto desired_pose =
+            compiled_reference_.interpolate_pose(time, target);
 
         // NOTE: input is not used in this state cost, so we give it a
         // dimension of zero.
@@ -57,9 +66,17 @@ class EndEffectorCost final : public ocs2::StateCost {
             ocs2::ScalarFunctionQuadraticApproximation(state.rows(), 0);
         approximation.setZero(state.rows(), 0);
 
-        // Linear approximations of position and orientation error
+        // Linear approximations of position and orientation error. The
+        // position approximation is read from the shared pre-computation if
+        // available; the orientation error depends on the target and so
+        // cannot be cached there.
+        const auto* precomputation =
+            dynamic_cast<const UprightPreComputation*>(&pre_comp);
         const auto eePosition =
-            kinematics_ptr_->getPositionLinearApproximation(state).front();
+            (precomputation && precomputation->hasApproximation())
+                ? precomputation->getEndEffectorPositionApproximation()
+                : kinematics_ptr_->getPositionLinearApproximation(state)
+                      .front();
         const auto eeOrientationError =
             kinematics_ptr_
                 ->getOrientationErrorLinearApproximation(state,
@@ -89,28 +106,44 @@ class EndEffectorCost final : public ocs2::StateCost {
     MatXd W_;  // weight matrix
     std::unique_ptr<ocs2::EndEffectorKinematics<ocs2::scalar_t>>
         kinematics_ptr_;
+
+    // Compiled reference tables; mutable because the const evaluation
+    // methods rebuild them lazily when the target changes. Each clone owns
+    // its own copy.
+    mutable CompiledEndEffectorReference compiled_reference_;
 };
 
-// Auto-diff version gives us the full Hessian
+// Auto-diff version of the pose cost with the full (exact) Hessian, as an
+// alternative to the Gauss-Newton approximation above. The desired pose
+// enters the generated model as a tape parameter, so reference updates do
+// not retape; only the weights, kinematics, and dimensions are baked in.
 class EndEffectorCostCppAd final : public ocs2::StateCostCppAd {
    public:
     EndEffectorCostCppAd(
         const MatXd& W,
         const ocs2::PinocchioEndEffectorKinematicsCppAd& kinematics,
-        const OptimizationDimensions& dims, bool recompileLibraries)
-        : W_(W), kinematics_ptr_(kinematics.clone()), dims_(dims) {
+        const OptimizationDimensions& dims, const std::string& library_folder,
+        bool recompileLibraries)
+        : W_(W),
+          kinematics_ptr_(kinematics.clone()),
+          dims_(dims),
+          library_folder_(library_folder) {
+        // Parameters: desired position (3) and orientation quaternion (4).
         const size_t num_params = 7;
-        initialize(dims.x(), num_params, "end_effector_cost_cppad", "/tmp/ocs2",
-                   recompileLibraries, true);
+        initialize(dims.x(), num_params, "end_effector_cost_cppad",
+                   library_folder, recompileLibraries, true);
     }
 
     EndEffectorCostCppAd* clone() const override {
-        return new EndEffectorCostCppAd(W_, *kinematics_ptr_, dims_, false);
+        // Clones reload the already-compiled library.
+        return new EndEffectorCostCppAd(W_, *kinematics_ptr_, dims_,
+                                        library_folder_, false);
     }
 
     VecXd getParameters(ocs2::scalar_t time,
                         const ocs2::TargetTrajectories& target) const override {
-        const auto desired_pose = interpolate_end_effector_pose(time, target);
+        const auto desired_pose =
+            compiled_reference_.interpolate_pose(time, target);
         VecXd p(7);
         p << desired_pose.first, desired_pose.second.coeffs();
         return p;
@@ -119,7 +152,7 @@ class EndEffectorCostCppAd final : public ocs2::StateCostCppAd {
    protected:
     ocs2::ad_scalar_t costFunction(ocs2::ad_scalar_t time_ad,
                                    const VecXad& state,
-                                   const VecXad& parameters) const {
+                                   const VecXad& parameters) const override {
         Vec3ad desired_position = parameters.head(3);
         Quatad desired_orientation;
         desired_orientation.coeffs() = parameters.tail(4);
@@ -141,6 +174,8 @@ class EndEffectorCostCppAd final : public ocs2::StateCostCppAd {
     MatXd W_;  // weight matrix
     std::unique_ptr<ocs2::PinocchioEndEffectorKinematicsCppAd> kinematics_ptr_;
     OptimizationDimensions dims_;
+    std::string library_folder_;
+    mutable CompiledEndEffectorReference compiled_reference_;
 };
 
 }  // namespace upright
@@ -14,6 +14,24 @@ struct RobotDimensions {
     size_t u = 0;  // Input dimension
 };
 
+// Compile-time dimensions for the supported robot configurations (q = 3, 6,
+// 9, each with v = u = q and x = 3q). Code paths that are hot at runtime
+// (e.g. the tracking estimator) are instantiated against these and
+// dispatched once at startup, so their Eigen kernels are fixed-size; the
+// runtime-sized struct above remains the fallback for exotic configurations.
+template <int Q>
+struct FixedRobotDimensions {
+    static constexpr int q = Q;
+    static constexpr int v = Q;
+    static constexpr int x = 3 * Q;
+    static constexpr int u = Q;
+
+    // True when the runtime dimensions match this configuration.
+    static bool matches(const RobotDimensions& dims) {
+        return dims.q == q && dims.v == v && dims.x == x && dims.u == u;
+    }
+};
+
 // Dimensions of the optimization problem
 struct OptimizationDimensions {
     // Dimensions of the (for now, single) robot
@@ -3,6 +3,7 @@
 #include <ocs2_core/dynamics/SystemDynamicsBaseAD.h>
 
 #include <upright_control/dimensions.h>
+#include <upright_control/solve_timing.h>
 #include <upright_control/types.h>
 
 namespace upright {
@@ -38,8 +39,14 @@ class ObstacleDynamics {
     }
 };
 
+// Triple integrator with a nonholonomic base: the base velocity is reduced
+// to a forward speed and a yaw rate, so the configuration has one more
+// dimension than the velocity (q = v + 1). The configuration is
+// [x, y, yaw, arm joints]; the velocity (and acceleration, and input jerk)
+// is [forward speed, yaw rate, arm joints].
 template <typename Scalar>
 class NonholonomicDynamics {
+   public:
     NonholonomicDynamics(const RobotDimensions& dims) : dims_(dims) {}
 
     VecX<Scalar> flowmap(Scalar t, const VecX<Scalar>& x, const VecX<Scalar>& u,
@@ -83,6 +90,29 @@ class SystemDynamics final : public ocs2::SystemDynamicsBaseAD {
         return new SystemDynamics<Dynamics>(*this);
     }
 
+    // Accumulate the time spent evaluating the compiled dynamics model into
+    // the given timer (shared by all clones). Null (the default) disables
+    // the instrumentation.
+    void set_timer(std::shared_ptr<TermTimer> timer) {
+        timer_ptr_ = std::move(timer);
+    }
+
+    VecXd computeFlowMap(ocs2::scalar_t time, const VecXd& state,
+                         const VecXd& input,
+                         const ocs2::PreComputation& pre_comp) override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return ocs2::SystemDynamicsBaseAD::computeFlowMap(time, state, input,
+                                                          pre_comp);
+    }
+
+    ocs2::VectorFunctionLinearApproximation linearApproximation(
+        ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+        const ocs2::PreComputation& pre_comp) override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return ocs2::SystemDynamicsBaseAD::linearApproximation(time, state,
+                                                               input, pre_comp);
+    }
+
     VecXad systemFlowMap(ocs2::ad_scalar_t time, const VecXad& state,
                          const VecXad& input,
                          const VecXad& parameters) const override {
@@ -130,6 +160,9 @@ class SystemDynamics final : public ocs2::SystemDynamicsBaseAD {
     Dynamics robot_dynamics_;
 
     ObstacleDynamics<ocs2::ad_scalar_t> obstacle_dynamics_;
+
+    // Optional per-term solve timer; copied (and thus shared) by clone().
+    std::shared_ptr<TermTimer> timer_ptr_;
 };
 
 }  // namespace upright
@@ -56,6 +56,92 @@ class TripleIntegratorPinocchioMapping final
     RobotDimensions dims_;
 };
 
+// Mapping for the nonholonomic robot model (see NonholonomicDynamics): the
+// robot velocity is reduced to [forward speed, yaw rate, arm joints] while
+// the Pinocchio model keeps its planar base with world-frame velocities, so
+// the base velocity and acceleration are rotated into the world frame by the
+// yaw angle.
+template <typename Scalar>
+class NonholonomicPinocchioMapping final
+    : public ocs2::PinocchioStateInputMapping<Scalar> {
+   public:
+    using VecXs = VecX<Scalar>;
+    using MatXs = MatX<Scalar>;
+
+    NonholonomicPinocchioMapping(const RobotDimensions& dims) : dims_(dims) {}
+
+    ~NonholonomicPinocchioMapping() override = default;
+
+    NonholonomicPinocchioMapping<Scalar>* clone() const override {
+        return new NonholonomicPinocchioMapping<Scalar>(*this);
+    }
+
+    VecXs getPinocchioJointPosition(const VecXs& state) const override {
+        return state.head(dims_.q);
+    }
+
+    VecXs getPinocchioJointVelocity(const VecXs& state,
+                                    const VecXs& input) const override {
+        const Scalar yaw = state(2);
+        const VecXs v = state.segment(dims_.q, dims_.v);
+
+        VecXs v_pin(dims_.q);
+        v_pin << cos(yaw) * v(0), sin(yaw) * v(0), v.tail(dims_.v - 1);
+        return v_pin;
+    }
+
+    VecXs getPinocchioJointAcceleration(const VecXs& state,
+                                        const VecXs& input) const override {
+        const Scalar yaw = state(2);
+        const VecXs v = state.segment(dims_.q, dims_.v);
+        const VecXs a = state.tail(dims_.v);
+
+        // Differentiating the world-frame base velocity brings in the yaw
+        // rate: d/dt (cos(yaw) * v) = cos(yaw) * a - sin(yaw) * yaw_rate * v.
+        VecXs a_pin(dims_.q);
+        a_pin << cos(yaw) * a(0) - sin(yaw) * v(1) * v(0),
+            sin(yaw) * a(0) + cos(yaw) * v(1) * v(0), a.tail(dims_.v - 1);
+        return a_pin;
+    }
+
+    // Maps the Jacobians of an arbitrary function f w.r.t q and v (generalized
+    // positions and velocities), as provided by Pinocchio as Jq and Jv, to the
+    // Jacobian of the state dfdx and Jacobian of the input dfdu.
+    std::pair<MatXs, MatXs> getOcs2Jacobian(const VecXs& state, const MatXs& Jq,
+                                            const MatXs& Jv) const override {
+        const Scalar yaw = state(2);
+        const VecXs v = state.segment(dims_.q, dims_.v);
+        const auto output_dim = Jq.rows();
+
+        // The Pinocchio velocity depends on the state velocity through the
+        // rotation into the world frame...
+        MatXs B = MatXs::Zero(dims_.q, dims_.v);
+        B(0, 0) = cos(yaw);
+        B(1, 0) = sin(yaw);
+        B.bottomRightCorner(dims_.v - 1, dims_.v - 1)
+            .diagonal()
+            .setConstant(Scalar(1));
+
+        // ... and on the yaw angle itself.
+        VecXs dv_pin_dyaw = VecXs::Zero(dims_.q);
+        dv_pin_dyaw(0) = -sin(yaw) * v(0);
+        dv_pin_dyaw(1) = cos(yaw) * v(0);
+
+        MatXs dfdx(output_dim, dims_.x);
+        dfdx << Jq, Jv * B, MatXs::Zero(output_dim, dims_.v);
+        dfdx.col(2) += Jv * dv_pin_dyaw;
+
+        // NOTE: this isn't used for collision avoidance (which is the only
+        // place this method is called)
+        MatXs dfdu = MatXs::Zero(output_dim, dims_.u);
+
+        return {dfdx, dfdu};
+    }
+
+   private:
+    RobotDimensions dims_;
+};
+
 static const RobotDimensions OBSTACLE_DIMENSIONS{3, 3, 9, 0};
 
 template <typename Scalar>
@@ -70,7 +156,20 @@ class SystemPinocchioMapping final
     using MatXs = MatX<Scalar>;
 
     explicit SystemPinocchioMapping(const OptimizationDimensions& dims)
-        : dims_(dims), robot_mapping_(dims.robot) {}
+        : dims_(dims) {
+        // The nonholonomic robot model is the only one with a reduced
+        // velocity dimension (q = v + 1, see NonholonomicDynamics); every
+        // other configuration uses the holonomic Mapping template parameter.
+        if (dims.robot.q == dims.robot.v + 1) {
+            robot_mapping_.reset(
+                new NonholonomicPinocchioMapping<Scalar>(dims.robot));
+        } else {
+            robot_mapping_.reset(new Mapping(dims.robot));
+        }
+    }
+
+    SystemPinocchioMapping(const SystemPinocchioMapping<Mapping, Scalar>& other)
+        : dims_(other.dims_), robot_mapping_(other.robot_mapping_->clone()) {}
 
     ~SystemPinocchioMapping() override = default;
 
@@ -92,14 +191,19 @@ class SystemPinocchioMapping final
         // Then we add on the robot q
         VecXs x_robot = state.head(dims_.robot.x);
         q_pin.tail(dims_.robot.q) =
-            robot_mapping_.getPinocchioJointPosition(x_robot);
+            robot_mapping_->getPinocchioJointPosition(x_robot);
 
         return q_pin;
     }
 
     VecXs getPinocchioJointVelocity(const VecXs& state,
                                     const VecXs& input) const override {
-        VecXs v_pin(dims_.v());
+        // The Pinocchio models built here always have nv == nq (planar or
+        // fixed base), so the velocity vector is sized by the configuration
+        // dimension. For the holonomic robot models these coincide; for the
+        // nonholonomic model the reduced velocity is expanded by the robot
+        // mapping.
+        VecXs v_pin(dims_.q());
         VecXs u_obs = VecXs::Zero(3);  // Obstacles have no input
 
         for (int i = 0; i < dims_.o; ++i) {
@@ -112,15 +216,17 @@ class SystemPinocchioMapping final
         // Then we add on the robot v
         VecXs x_robot = state.head(dims_.robot.x);
         VecXs u_robot = input.head(dims_.robot.u);
-        v_pin.tail(dims_.robot.v) =
-            robot_mapping_.getPinocchioJointVelocity(x_robot, u_robot);
+        v_pin.tail(dims_.robot.q) =
+            robot_mapping_->getPinocchioJointVelocity(x_robot, u_robot);
 
         return v_pin;
     }
 
     VecXs getPinocchioJointAcceleration(const VecXs& state,
                                         const VecXs& input) const override {
-        VecXs a_pin(dims_.v());
+        // Sized by the configuration dimension; see
+        // getPinocchioJointVelocity.
+        VecXs a_pin(dims_.q());
         VecXs u_obs = VecXs::Zero(3);  // Obstacles have no input
 
         for (int i = 0; i < dims_.o; ++i) {
@@ -133,8 +239,8 @@ class SystemPinocchioMapping final
         // Then we add on the robot a
         VecXs x_robot = state.head(dims_.robot.x);
         VecXs u_robot = input.head(dims_.robot.u);
-        a_pin.tail(dims_.robot.v) =
-            robot_mapping_.getPinocchioJointAcceleration(x_robot, u_robot);
+        a_pin.tail(dims_.robot.q) =
+            robot_mapping_->getPinocchioJointAcceleration(x_robot, u_robot);
 
         return a_pin;
     }
@@ -165,12 +271,14 @@ class SystemPinocchioMapping final
         }
 
         VecXs x_robot = state.head(dims_.robot.x);
-        // Recall that robot q, v are after the obstacle q, v in Pinocchio
+        // Recall that robot q, v are after the obstacle q, v in Pinocchio,
+        // and that the Pinocchio velocity dimension is the configuration
+        // dimension (see getPinocchioJointVelocity).
         MatXs Jq_pin_robot = Jq_pin.rightCols(dims_.robot.q);
-        MatXs Jv_pin_robot = Jv_pin.rightCols(dims_.robot.v);
+        MatXs Jv_pin_robot = Jv_pin.rightCols(dims_.robot.q);
         MatXs dfdx_robot, dfdu_robot;
         std::tie(dfdx_robot, dfdu_robot) =
-            robot_mapping_.getOcs2Jacobian(x_robot, Jq_pin_robot, Jv_pin_robot);
+            robot_mapping_->getOcs2Jacobian(x_robot, Jq_pin_robot, Jv_pin_robot);
 
         dfdx.leftCols(dims_.robot.x) = dfdx_robot;
         dfdu.leftCols(dims_.robot.u) = dfdu_robot;
@@ -180,7 +288,7 @@ class SystemPinocchioMapping final
 
    private:
     OptimizationDimensions dims_;
-    Mapping robot_mapping_;
+    std::unique_ptr<ocs2::PinocchioStateInputMapping<Scalar>> robot_mapping_;
 };
 
 }  // namespace upright
@@ -3,10 +3,10 @@
 #include <memory>
 
 #include <ocs2_core/automatic_differentiation/CppAdInterface.h>
-#include <ocs2_core/constraint/StateInputConstraintCppAd.h>
 #include <ocs2_core/cost/StateInputCostCppAd.h>
 #include <ocs2_pinocchio_interface/PinocchioEndEffectorKinematicsCppAd.h>
 
+#include <upright_control/constraint/robot_state_input_constraint_cppad.h>
 #include <upright_control/dimensions.h>
 #include <upright_control/types.h>
 #include <upright_core/util.h>
@@ -66,26 +66,28 @@ inline std::ostream& operator<<(std::ostream& out,
 
 // Constraint form of inertial alignment
 class InertialAlignmentConstraint final
-    : public ocs2::StateInputConstraintCppAd {
+    : public RobotStateInputConstraintCppAd {
    public:
     InertialAlignmentConstraint(
         const ocs2::PinocchioEndEffectorKinematicsCppAd& kinematics,
         const InertialAlignmentSettings& settings, const Vec3d& gravity,
-        const OptimizationDimensions& dims, bool recompile_libraries)
-        : ocs2::StateInputConstraintCppAd(ocs2::ConstraintOrder::Linear),
+        const OptimizationDimensions& dims, const std::string& library_folder,
+        bool recompile_libraries)
+        : RobotStateInputConstraintCppAd(ocs2::ConstraintOrder::Linear, dims),
           kinematics_ptr_(kinematics.clone()),
           settings_(settings),
           gravity_(gravity),
-          dims_(dims) {
-        initialize(dims.x(), dims.u(), 0, "inertial_alignment_constraint",
-                   "/tmp/ocs2", recompile_libraries, true);
+          library_folder_(library_folder) {
+        initialize(0, "inertial_alignment_constraint", library_folder_,
+                   recompile_libraries, true);
     }
 
     InertialAlignmentConstraint* clone() const override {
         // Always pass recompileLibraries = false to avoid recompiling the same
         // library just because this object is cloned.
         return new InertialAlignmentConstraint(*kinematics_ptr_, settings_,
-                                               gravity_, dims_, false);
+                                               gravity_, dims_,
+                                               library_folder_, false);
     }
 
     size_t getNumConstraints(ocs2::scalar_t time) const override { return 5; }
@@ -98,13 +100,10 @@ class InertialAlignmentConstraint final
                               const VecXad& parameters) const override;
 
    private:
-    InertialAlignmentConstraint(const InertialAlignmentConstraint& other) =
-        default;
-
     std::unique_ptr<ocs2::PinocchioEndEffectorKinematicsCppAd> kinematics_ptr_;
     InertialAlignmentSettings settings_;
     Vec3d gravity_;
-    OptimizationDimensions dims_;
+    std::string library_folder_;
 };
 
 // Constraint form of inertial alignment
@@ -117,18 +116,20 @@ class InertialAlignmentCost final : public ocs2::StateInputCostCppAd {
     InertialAlignmentCost(
         const ocs2::PinocchioEndEffectorKinematicsCppAd& kinematics,
         const InertialAlignmentSettings& settings, const Vec3d& gravity,
-        const OptimizationDimensions& dims, bool recompile_libraries)
+        const OptimizationDimensions& dims, const std::string& library_folder,
+        bool recompile_libraries)
         : kinematics_ptr_(kinematics.clone()),
           settings_(settings),
           gravity_(gravity),
-          dims_(dims) {
+          dims_(dims),
+          library_folder_(library_folder) {
         initialize(dims.x(), dims.u(), 0, "inertial_alignment_cost",
-                   "/tmp/ocs2", recompile_libraries, true);
+                   library_folder_, recompile_libraries, true);
     }
 
     InertialAlignmentCost* clone() const override {
         return new InertialAlignmentCost(*kinematics_ptr_, settings_, gravity_,
-                                         dims_, false);
+                                         dims_, library_folder_, false);
     }
 
    protected:
@@ -143,6 +144,7 @@ class InertialAlignmentCost final : public ocs2::StateInputCostCppAd {
     InertialAlignmentSettings settings_;
     Vec3d gravity_;
     OptimizationDimensions dims_;
+    std::string library_folder_;
 };
 
 // Use Gauss-Newton approximation of the cost to avoid ill-conditioned (i.e.
@@ -154,18 +156,21 @@ class InertialAlignmentCostGaussNewton final : public ocs2::StateInputCost {
     InertialAlignmentCostGaussNewton(
         const ocs2::PinocchioEndEffectorKinematicsCppAd& kinematics,
         const InertialAlignmentSettings& settings, const Vec3d& gravity,
-        const OptimizationDimensions& dims, bool recompile_libraries)
+        const OptimizationDimensions& dims, const std::string& library_folder,
+        bool recompile_libraries)
         : kinematics_ptr_(kinematics.clone()),
           settings_(settings),
           gravity_(gravity),
-          dims_(dims) {
+          dims_(dims),
+          library_folder_(library_folder) {
         initialize(dims.x(), dims.u(), 0, "inertial_alignment_cost",
-                   "/tmp/ocs2", recompile_libraries, true);
+                   library_folder_, recompile_libraries, true);
     }
 
     InertialAlignmentCostGaussNewton* clone() const override {
         return new InertialAlignmentCostGaussNewton(*kinematics_ptr_, settings_,
-                                                    gravity_, dims_, false);
+                                                    gravity_, dims_,
+                                                    library_folder_, false);
     }
 
     VecXd getParameters(ocs2::scalar_t, const ocs2::TargetTrajectories&) const {
@@ -199,6 +204,7 @@ class InertialAlignmentCostGaussNewton final : public ocs2::StateInputCost {
     InertialAlignmentSettings settings_;
     Vec3d gravity_;
     OptimizationDimensions dims_;
+    std::string library_folder_;
 
     std::unique_ptr<ocs2::CppAdInterface> ad_interface_ptr_;
 };
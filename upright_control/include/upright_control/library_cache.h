@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include <upright_control/types.h>
+
+namespace upright {
+
+// Accumulates a content hash (FNV-1a, 64-bit) over the settings that affect a
+// generated CppAD model. Two models built from the same inputs hash to the
+// same key and can share a compiled library.
+class LibraryHash {
+   public:
+    LibraryHash() : hash_(14695981039346656037ULL) {}
+
+    void add_bytes(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash_ ^= bytes[i];
+            hash_ *= 1099511628211ULL;
+        }
+    }
+
+    void add(const std::string& s) { add_bytes(s.data(), s.size()); }
+
+    void add(ocs2::scalar_t x) { add_bytes(&x, sizeof(x)); }
+
+    void add(size_t n) { add_bytes(&n, sizeof(n)); }
+
+    void add(bool b) { add(size_t(b)); }
+
+    void add(const VecXd& v) {
+        add_bytes(v.data(), v.size() * sizeof(ocs2::scalar_t));
+    }
+
+    void add(const MatXd& m) {
+        add_bytes(m.data(), m.size() * sizeof(ocs2::scalar_t));
+    }
+
+    // Hash the contents of a file (e.g. a URDF), so that editing the file
+    // invalidates models built from it.
+    void add_file(const std::string& path) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f.good()) {
+            // A missing file is still a valid key component; the model build
+            // itself will complain if the file is actually required.
+            add(path);
+            return;
+        }
+        std::string contents((std::istreambuf_iterator<char>(f)),
+                             std::istreambuf_iterator<char>());
+        add(contents);
+    }
+
+    std::string hex() const {
+        char buf[17];
+        snprintf(buf, sizeof(buf), "%016lx", hash_);
+        return std::string(buf);
+    }
+
+   private:
+    uint64_t hash_;
+};
+
+// Decides where each generated CppAD model library lives and whether it needs
+// to be (re)compiled. When caching is enabled, each model is placed in a
+// folder keyed by a hash of the settings that affect its tape, so libraries
+// are automatically reused across runs and across configs that share those
+// settings.
+class LibraryCache {
+   public:
+    LibraryCache(const std::string& root, bool enabled, bool force_recompile)
+        : root_(root), enabled_(enabled), force_recompile_(force_recompile) {}
+
+    // Folder in which the model with the given name and content key should be
+    // generated or loaded.
+    std::string folder(const std::string& model_name,
+                       const LibraryHash& key) const {
+        if (!enabled_) {
+            return root_;
+        }
+        return root_ + "/" + model_name + "/" + key.hex();
+    }
+
+    // True if the model library with the given name and content key must be
+    // regenerated. With caching enabled the content key already guarantees
+    // that an existing library matches the settings, so a model only compiles
+    // if its folder is absent (delete the folder to force a rebuild).
+    //
+    // Without the cache all models share root_, so each model records its key
+    // in a sidecar file next to the library; a model then recompiles only
+    // when forced, when its key has never been recorded, or when the recorded
+    // key differs from the current settings. Tuning one constraint's
+    // parameters therefore regenerates only the models whose tapes actually
+    // consume them.
+    bool recompile(const std::string& model_name,
+                   const LibraryHash& key) const {
+        if (enabled_) {
+            return !boost::filesystem::exists(folder(model_name, key));
+        }
+
+        const std::string key_path = root_ + "/" + model_name + ".key";
+        std::string recorded;
+        std::ifstream in(key_path);
+        in >> recorded;
+        if (!force_recompile_ && recorded == key.hex()) {
+            return false;
+        }
+
+        // Record the new key now rather than after the build: if the build is
+        // interrupted, the library file is missing and the model classes
+        // regenerate it on load regardless of the recompile flag.
+        boost::filesystem::create_directories(root_);
+        std::ofstream out(key_path);
+        out << key.hex();
+        return true;
+    }
+
+   private:
+    std::string root_;
+    bool enabled_;
+    bool force_recompile_;
+};
+
+}  // namespace upright
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ocs2_core/automatic_differentiation/CppAdInterface.h>
+
+namespace upright {
+
+// Runs a batch of independent CppAD model generation jobs on a pool of worker
+// threads. Each model's initialize() call spends most of its time in code
+// generation and a blocking C compiler invocation, so independent models
+// parallelize very well. CppAD's tape allocator is single-threaded by
+// default, so the pool registers itself with CppAD::thread_alloc for the
+// duration of a batch and restores single-threaded mode afterwards.
+class ParallelModelBuilder {
+   public:
+    explicit ParallelModelBuilder(
+        size_t num_threads = std::thread::hardware_concurrency())
+        : num_threads_(std::max<size_t>(num_threads, 1)) {}
+
+    // Queue a job for the next run(). Jobs must not depend on one another;
+    // jobs with a dependency belong in separate batches.
+    void add(std::function<void()> job) { jobs_.push_back(std::move(job)); }
+
+    // Run all queued jobs and block until every one has finished. The queue
+    // is cleared afterward so the builder can be reused for a later batch.
+    // The first exception thrown by a job is rethrown here.
+    void run() {
+        if (jobs_.empty()) {
+            return;
+        }
+
+        const size_t n = std::min(num_threads_, jobs_.size());
+        std::atomic<size_t> next_job(0);
+        std::exception_ptr first_error = nullptr;
+        std::mutex error_mutex;
+
+        // Tell CppAD how to identify the threads in this batch. This follows
+        // the scheme from CppAD's own multi-threading examples: set up the
+        // allocator and tape tables before going parallel, and have each
+        // thread free its held memory before we go back to sequential mode.
+        CppAD::thread_alloc::parallel_setup(
+            n, &ParallelModelBuilder::in_parallel,
+            &ParallelModelBuilder::thread_number);
+        CppAD::thread_alloc::hold_memory(true);
+        CppAD::parallel_ad<ocs2::ad_base_t>();
+        parallel_active() = true;
+
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < n; ++i) {
+            workers.emplace_back([this, i, &next_job, &first_error,
+                                  &error_mutex]() {
+                worker_number() = i;
+                work(next_job, first_error, error_mutex);
+            });
+        }
+        // The master thread (thread number 0) works too.
+        worker_number() = 0;
+        work(next_job, first_error, error_mutex);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        parallel_active() = false;
+        CppAD::thread_alloc::hold_memory(false);
+        CppAD::thread_alloc::parallel_setup(1, nullptr, nullptr);
+
+        jobs_.clear();
+        if (first_error) {
+            std::rethrow_exception(first_error);
+        }
+    }
+
+   private:
+    void work(std::atomic<size_t>& next_job, std::exception_ptr& first_error,
+              std::mutex& error_mutex) {
+        while (true) {
+            const size_t i = next_job.fetch_add(1);
+            if (i >= jobs_.size()) {
+                break;
+            }
+            try {
+                jobs_[i]();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!first_error) {
+                    first_error = std::current_exception();
+                }
+            }
+        }
+        CppAD::thread_alloc::free_available(worker_number());
+    }
+
+    static bool& parallel_active() {
+        static bool active = false;
+        return active;
+    }
+
+    static size_t& worker_number() {
+        static thread_local size_t number = 0;
+        return number;
+    }
+
+    static bool in_parallel() { return parallel_active(); }
+
+    static size_t thread_number() { return worker_number(); }
+
+    size_t num_threads_;
+    std::vector<std::function<void()>> jobs_;
+};
+
+}  // namespace upright
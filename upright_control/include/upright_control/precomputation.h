@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+
+#include <ocs2_core/PreComputation.h>
+#include <ocs2_core/Types.h>
+#include <ocs2_pinocchio_interface/PinocchioInterface.h>
+
+#include <upright_control/dimensions.h>
+#include <upright_control/dynamics/system_pinocchio_mapping.h>
+#include <upright_control/types.h>
+#include <upright_core/types.h>
+
+namespace upright {
+
+// Shared pre-computation for the OCP. Runs forward kinematics for the end
+// effector once per node per solver iteration and caches the resulting rigid
+// body state (and, when requested, the position Jacobian), so that the
+// analytic cost and constraint terms do not each redo the work. Note that
+// the CppAd-based terms evaluate kinematics inside their compiled libraries
+// and cannot read the cache; terms fall back to their own kinematics objects
+// when handed a plain ocs2::PreComputation.
+class UprightPreComputation final : public ocs2::PreComputation {
+   public:
+    UprightPreComputation(const ocs2::PinocchioInterface& pinocchio_interface,
+                          const std::string& frame_name,
+                          const OptimizationDimensions& dims);
+
+    ~UprightPreComputation() override = default;
+
+    UprightPreComputation* clone() const override {
+        return new UprightPreComputation(*this);
+    }
+
+    void request(ocs2::RequestSet request, ocs2::scalar_t t, const VecXd& state,
+                 const VecXd& input) override;
+
+    void requestFinal(ocs2::RequestSet request, ocs2::scalar_t t,
+                      const VecXd& state) override;
+
+    // The end effector's rigid body state at the last requested node.
+    const RigidBodyState<ocs2::scalar_t>& getEndEffectorState() const {
+        return ee_state_;
+    }
+
+    // Linear approximation of the end effector position at the last
+    // requested node. Only valid if hasApproximation() is true.
+    const ocs2::VectorFunctionLinearApproximation&
+    getEndEffectorPositionApproximation() const {
+        return position_approx_;
+    }
+
+    // True if the last request included an approximation, in which case
+    // getEndEffectorPositionApproximation() is valid.
+    bool hasApproximation() const { return has_approximation_; }
+
+   private:
+    UprightPreComputation(const UprightPreComputation& other) = default;
+
+    // Compute and cache the kinematic quantities at the given node.
+    void updateCache(ocs2::RequestSet request, const VecXd& state,
+                     const VecXd& input);
+
+    ocs2::PinocchioInterface pinocchio_interface_;
+    SystemPinocchioMapping<TripleIntegratorPinocchioMapping<ocs2::scalar_t>,
+                           ocs2::scalar_t>
+        mapping_;
+    OptimizationDimensions dims_;
+    size_t frame_id_;
+
+    // Cached values
+    RigidBodyState<ocs2::scalar_t> ee_state_;
+    ocs2::VectorFunctionLinearApproximation position_approx_;
+    bool has_approximation_ = false;
+};
+
+}  // namespace upright
@@ -5,6 +5,12 @@
 
 #include <upright_control/types.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
 namespace upright {
 
 inline Vec3d get_target_position(const VecXd& target) {
@@ -46,4 +52,154 @@ inline std::pair<VecXd, Quatd> interpolate_end_effector_pose(
     return {position, orientation};
 }
 
+// Precompiled interpolation tables for the end-effector pose reference.
+//
+// interpolate_end_effector_pose above performs a time-segment binary search,
+// two quaternion constructions from raw state segments, and a full slerp
+// (including an acos and a normalization) on every call, and it is queried
+// several times per node per SQP iteration. This class compiles a
+// TargetTrajectories once into per-node positions, normalized sign-adjusted
+// quaternions, and per-segment slerp angles, and serves queries from those
+// tables. The solver issues monotonically increasing query times within a
+// sweep, so the segment lookup advances a cached index in O(1) and only
+// falls back to a binary search when time jumps backwards.
+//
+// The tables are rebuilt lazily whenever the passed target no longer matches
+// the one they were compiled from, detected by comparing the trajectory
+// contents: a new target may be copy-assigned into the same heap storage as
+// the old one (and a reallocated one may reuse a freed address), so storage
+// identity says nothing about content identity. The trajectories are a
+// handful of waypoints, so the comparison is far cheaper than a single
+// slerp. Holders that query from const methods keep a mutable instance;
+// clones each get their own copy of the tables, so no synchronization is
+// needed.
+class CompiledEndEffectorReference {
+   public:
+    std::pair<Vec3d, Quatd> interpolate_pose(
+        ocs2::scalar_t time, const ocs2::TargetTrajectories& target) {
+        if (!compiled_from(target)) {
+            compile(target);
+        }
+
+        if (times_.size() == 1) {
+            return {positions_[0], orientations_[0]};
+        }
+
+        const size_t index = find_segment(time);
+        const ocs2::scalar_t alpha = std::max(
+            0.0,
+            std::min(1.0, (times_[index + 1] - time) /
+                              (times_[index + 1] - times_[index])));
+
+        const Vec3d position =
+            alpha * positions_[index] + (1.0 - alpha) * positions_[index + 1];
+
+        // Interpolate the orientation with the precomputed segment angle:
+        // q = (sin(alpha * theta) * q0 + sin((1 - alpha) * theta) * q1)
+        //     / sin(theta),
+        // falling back to normalized lerp for (near-)parallel quaternions,
+        // as slerp itself does.
+        Quatd orientation;
+        const ocs2::scalar_t theta = thetas_[index];
+        if (sin_thetas_[index] > SLERP_EPSILON) {
+            orientation.coeffs() =
+                (std::sin(alpha * theta) * orientations_[index].coeffs() +
+                 std::sin((1.0 - alpha) * theta) *
+                     orientations_[index + 1].coeffs()) /
+                sin_thetas_[index];
+        } else {
+            orientation.coeffs() =
+                (alpha * orientations_[index].coeffs() +
+                 (1.0 - alpha) * orientations_[index + 1].coeffs())
+                    .normalized();
+        }
+        return {position, orientation};
+    }
+
+   private:
+    static constexpr ocs2::scalar_t SLERP_EPSILON = 1e-8;
+
+    // True if the tables were compiled from a target with exactly these
+    // times and states.
+    bool compiled_from(const ocs2::TargetTrajectories& target) const {
+        if (target.timeTrajectory != times_ ||
+            target.stateTrajectory.size() != states_.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < states_.size(); ++i) {
+            const VecXd& compiled = states_[i];
+            const VecXd& queried = target.stateTrajectory[i];
+            if (compiled.size() != queried.size() ||
+                std::memcmp(compiled.data(), queried.data(),
+                            compiled.size() * sizeof(ocs2::scalar_t)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void compile(const ocs2::TargetTrajectories& target) {
+        const size_t n = target.timeTrajectory.size();
+        times_ = target.timeTrajectory;
+        states_ = target.stateTrajectory;
+        last_index_ = 0;
+
+        positions_.resize(n);
+        orientations_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            positions_[i] = get_target_position(target.stateTrajectory[i]);
+            orientations_[i] =
+                get_target_orientation(target.stateTrajectory[i]).normalized();
+            // Flip signs as needed so consecutive quaternions interpolate
+            // along the shorter arc.
+            if (i > 0 &&
+                orientations_[i - 1].dot(orientations_[i]) < 0.0) {
+                orientations_[i].coeffs() = -orientations_[i].coeffs();
+            }
+        }
+
+        thetas_.resize(n > 0 ? n - 1 : 0);
+        sin_thetas_.resize(thetas_.size());
+        for (size_t i = 0; i + 1 < n; ++i) {
+            const ocs2::scalar_t d = std::max(
+                -1.0,
+                std::min(1.0, orientations_[i].dot(orientations_[i + 1])));
+            thetas_[i] = std::acos(d);
+            sin_thetas_[i] = std::sin(thetas_[i]);
+        }
+    }
+
+    // Find the segment index such that the query time lies within
+    // [times_[i], times_[i + 1]], clamping to the first and last segments.
+    size_t find_segment(ocs2::scalar_t time) {
+        if (time < times_[last_index_]) {
+            // Time jumped backwards (e.g. a new solver sweep): rewind with a
+            // binary search over the preceding nodes.
+            last_index_ = std::upper_bound(times_.begin(),
+                                           times_.begin() + last_index_,
+                                           time) -
+                          times_.begin();
+            if (last_index_ > 0) {
+                --last_index_;
+            }
+        }
+        while (last_index_ + 2 < times_.size() &&
+               time > times_[last_index_ + 1]) {
+            ++last_index_;
+        }
+        return last_index_;
+    }
+
+    ocs2::scalar_array_t times_;
+    // Copy of the state waypoints the tables were compiled from, kept only
+    // for the content comparison above (positions_/orientations_ are
+    // transformed and cannot be compared against the source).
+    ocs2::vector_array_t states_;
+    std::vector<Vec3d> positions_;
+    std::vector<Quatd, Eigen::aligned_allocator<Quatd>> orientations_;
+    std::vector<ocs2::scalar_t> thetas_;
+    std::vector<ocs2::scalar_t> sin_thetas_;
+    size_t last_index_ = 0;
+};
+
 }  // namespace upright
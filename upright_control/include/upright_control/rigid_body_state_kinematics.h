@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+#include <ocs2_pinocchio_interface/PinocchioInterface.h>
+
+#include <upright_control/dimensions.h>
+#include <upright_control/dynamics/system_pinocchio_mapping.h>
+#include <upright_control/types.h>
+#include <upright_core/types.h>
+
+namespace upright {
+
+// Evaluates the full rigid body state (pose, twist, and classical
+// acceleration) of a single frame in one forward pass over the kinematic
+// chain. The individual PinocchioEndEffectorKinematicsCppAd accessors each
+// re-run the forward pass inside the taped function, so fusing them keeps
+// the generated constraint tapes much smaller.
+class RigidBodyStateKinematicsCppAd {
+   public:
+    RigidBodyStateKinematicsCppAd(
+        const ocs2::PinocchioInterface& pinocchio_interface,
+        const std::string& frame_name, const OptimizationDimensions& dims);
+
+    // Compute the frame's rigid body state, with all quantities expressed in
+    // the world frame. For use inside the constraintFunction of a CppAd
+    // constraint.
+    RigidBodyState<ocs2::ad_scalar_t> getRigidBodyStateCppAd(
+        const VecXad& state, const VecXad& input) const;
+
+   private:
+    // Mutable because pinocchio writes its results into the interface's data
+    // buffer.
+    mutable ocs2::PinocchioInterfaceCppAd pinocchio_interface_cppad_;
+
+    SystemPinocchioMapping<TripleIntegratorPinocchioMapping<ocs2::ad_scalar_t>,
+                           ocs2::ad_scalar_t>
+        mapping_;
+
+    size_t frame_id_;
+};
+
+}  // namespace upright
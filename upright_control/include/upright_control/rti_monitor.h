@@ -0,0 +1,72 @@
+#pragma once
+
+#include <ocs2_oc/oc_solver/SolverBase.h>
+#include <ocs2_oc/synchronized_module/SolverSynchronizedModule.h>
+
+#include <upright_control/types.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace upright {
+
+// Records the solver's convergence at the end of each solve. In real-time
+// iteration mode every solve stops at a fixed iteration budget, so the
+// performance index of the final iterate reports how suboptimal the shipped
+// policy is -- a persistently large merit or constraint violation is how a
+// too-small budget shows up. The recorder runs on the MPC thread after the
+// solve; the diagnostics reader only takes the mutex at low rate.
+class RtiMonitor {
+   public:
+    void record(const ocs2::PerformanceIndex& performance) {
+        std::ostringstream out;
+        out << performance;
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++solves_;
+        last_performance_ = out.str();
+    }
+
+    uint64_t solves() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return solves_;
+    }
+
+    // Human-readable performance index of the most recent solve.
+    std::string last_performance() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_performance_;
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    uint64_t solves_ = 0;
+    std::string last_performance_;
+};
+
+// Feeds the monitor after every solve. The raw solver pointer is safe: the
+// solver owns this module, so the module cannot outlive it.
+class RtiMonitorModule final : public ocs2::SolverSynchronizedModule {
+   public:
+    RtiMonitorModule(std::shared_ptr<RtiMonitor> monitor,
+                     const ocs2::SolverBase* solver)
+        : monitor_ptr_(std::move(monitor)), solver_(solver) {}
+
+    void preSolverRun(ocs2::scalar_t /*initTime*/, ocs2::scalar_t /*finalTime*/,
+                      const VecXd& /*currentState*/,
+                      const ocs2::ReferenceManagerInterface&
+                      /*referenceManager*/) override {}
+
+    void postSolverRun(const ocs2::PrimalSolution& /*primalSolution*/)
+        override {
+        monitor_ptr_->record(solver_->getPerformanceIndeces());
+    }
+
+   private:
+    std::shared_ptr<RtiMonitor> monitor_ptr_;
+    const ocs2::SolverBase* solver_;
+};
+
+}  // namespace upright
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ocs2_core/reference/TargetTrajectories.h>
+
+#include <upright_control/controller_settings.h>
+#include <upright_control/types.h>
+
+namespace upright {
+
+// Version of the binary settings snapshot format. Bump this whenever the
+// serialized layout changes: loading a snapshot with a mismatched version
+// fails loudly rather than misinterpreting the blob.
+constexpr uint32_t SETTINGS_SNAPSHOT_VERSION = 13;
+
+// A single desired end effector pose, relative to the end effector pose at
+// the initial state.
+struct PoseWaypoint {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    ocs2::scalar_t time = 0;
+    Vec3d position = Vec3d::Zero();
+    Quatd orientation = Quatd::Identity();
+};
+
+// The fully-parsed controller configuration: the settings plus the target
+// waypoints for the end effector. Parsing the YAML configuration requires
+// Python; serializing the parsed result to a binary snapshot lets nodes that
+// must not embed a Python interpreter (in particular the real-time tracking
+// node) load it natively.
+struct SettingsSnapshot {
+    ControllerSettings settings;
+    std::vector<PoseWaypoint> target_waypoints;
+};
+
+// Conventional location of the snapshot for a given YAML configuration file.
+std::string settings_snapshot_path(const std::string& config_path);
+
+// Conventional location of the snapshot's dependency list: every file in
+// the configuration's include closure, one path per line, recorded when the
+// snapshot was written.
+std::string settings_snapshot_deps_path(const std::string& snapshot_path);
+
+// Write the snapshot's dependency list (atomically, like the snapshot
+// itself). Call this before save_settings_snapshot so a reader never pairs
+// a new snapshot with the previous closure.
+void save_settings_snapshot_deps(const std::string& snapshot_path,
+                                 const std::vector<std::string>& files);
+
+// True if a snapshot exists at snapshot_path and is at least as new as the
+// configuration it was generated from. The configuration is assembled from
+// a chain of included files, so freshness is judged against every file in
+// the recorded dependency list, not just the top-level one; a snapshot
+// without a dependency list is considered stale.
+bool settings_snapshot_fresh(const std::string& snapshot_path,
+                             const std::string& config_path);
+
+// Write the snapshot. The file is written to a temporary location and then
+// renamed, so readers polling for the snapshot never see a partial file.
+void save_settings_snapshot(const std::string& path,
+                            const SettingsSnapshot& snapshot);
+
+SettingsSnapshot load_settings_snapshot(const std::string& path);
+
+// Version of the binary target bank format; bumped on layout changes like
+// the snapshot version above.
+constexpr uint32_t TARGET_BANK_VERSION = 1;
+
+// A bank of named waypoint sets, compiled offline from YAML task definitions
+// (see build_target_bank in upright_ros_interface). The tracking node loads
+// the bank at startup and builds one TargetTrajectories per entry, so
+// switching tasks at runtime is a target reset rather than a controller
+// restart.
+struct TargetBank {
+    std::map<std::string, std::vector<PoseWaypoint>> entries;
+};
+
+// Write the bank, atomically like save_settings_snapshot.
+void save_target_bank(const std::string& path, const TargetBank& bank);
+
+TargetBank load_target_bank(const std::string& path);
+
+// Build the target trajectory from pose waypoints, which are interpreted
+// relative to the end effector pose at the initial state x0. This is the
+// native counterpart of TargetTrajectories.from_config_file on the Python
+// side.
+ocs2::TargetTrajectories build_target_trajectory(
+    const std::vector<PoseWaypoint>& waypoints,
+    const ControllerSettings& settings, const VecXd& x0);
+
+}  // namespace upright
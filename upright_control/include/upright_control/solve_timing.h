@@ -0,0 +1,316 @@
+#pragma once
+
+#include <ocs2_core/constraint/StateConstraint.h>
+#include <ocs2_core/constraint/StateInputConstraint.h>
+#include <ocs2_core/cost/StateCost.h>
+#include <ocs2_core/cost/StateInputCost.h>
+
+#include <upright_control/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace upright {
+
+// Per-term time accumulator for the MPC solve. The solver's worker threads
+// (which share one timer through their problem clones) add samples with
+// relaxed atomic increments -- no locks -- so the instrumentation is cheap
+// enough to stay on in production; readers see a consistent-enough view for
+// diagnostics.
+class TermTimer {
+   public:
+    void add(uint64_t nanoseconds) {
+        nanoseconds_.fetch_add(nanoseconds, std::memory_order_relaxed);
+        calls_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t nanoseconds() const {
+        return nanoseconds_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t calls() const { return calls_.load(std::memory_order_relaxed); }
+
+    void reset() {
+        nanoseconds_.store(0, std::memory_order_relaxed);
+        calls_.store(0, std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<uint64_t> nanoseconds_{0};
+    std::atomic<uint64_t> calls_{0};
+};
+
+// RAII sampler: times the enclosing scope and adds the sample to the timer.
+// On Linux steady_clock::now() is a vDSO read of the hardware counter, so a
+// sample costs two counter reads and two relaxed increments. A null timer
+// makes the sampler a no-op.
+class ScopedTermTimer {
+   public:
+    explicit ScopedTermTimer(TermTimer* timer) : timer_(timer) {
+        if (timer_ != nullptr) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTermTimer() {
+        if (timer_ != nullptr) {
+            timer_->add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start_)
+                            .count());
+        }
+    }
+
+    ScopedTermTimer(const ScopedTermTimer&) = delete;
+    ScopedTermTimer& operator=(const ScopedTermTimer&) = delete;
+
+   private:
+    TermTimer* timer_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Registry of per-term timers, keyed by term name. The map itself is only
+// touched at problem-assembly time and by the low-rate diagnostics reader
+// (both guarded by a mutex); the hot path -- the worker threads adding
+// samples through shared TermTimer pointers -- never takes a lock.
+class SolveTimingRegistry {
+   public:
+    // Look up (or create) the timer for the named term. The model builder
+    // assembles terms from several threads, hence the lock.
+    std::shared_ptr<TermTimer> timer(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = timers_.find(name);
+        if (it == timers_.end()) {
+            it = timers_.emplace(name, std::make_shared<TermTimer>()).first;
+        }
+        return it->second;
+    }
+
+    // Accumulated seconds (resp. call counts) per term since the last reset.
+    std::map<std::string, ocs2::scalar_t> seconds() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::map<std::string, ocs2::scalar_t> result;
+        for (const auto& kv : timers_) {
+            result[kv.first] = 1e-9 * kv.second->nanoseconds();
+        }
+        return result;
+    }
+
+    std::map<std::string, ocs2::scalar_t> calls() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::map<std::string, ocs2::scalar_t> result;
+        for (const auto& kv : timers_) {
+            result[kv.first] = kv.second->calls();
+        }
+        return result;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& kv : timers_) {
+            kv.second->reset();
+        }
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<TermTimer>> timers_;
+};
+
+// Decorators timing the evaluation methods of the wrapped term. Clones share
+// the wrapped term's timer, so per-thread samples accumulate into one
+// counter. The soft-constraint penalty wrappers are left untouched (the
+// Python interface downcasts them by name); the decorator goes around the
+// inner constraint instead.
+class TimedStateConstraint final : public ocs2::StateConstraint {
+   public:
+    TimedStateConstraint(std::unique_ptr<ocs2::StateConstraint> constraint,
+                         std::shared_ptr<TermTimer> timer)
+        : ocs2::StateConstraint(constraint->getOrder()),
+          constraint_ptr_(std::move(constraint)),
+          timer_ptr_(std::move(timer)) {}
+
+    TimedStateConstraint(const TimedStateConstraint& other)
+        : ocs2::StateConstraint(other),
+          constraint_ptr_(other.constraint_ptr_->clone()),
+          timer_ptr_(other.timer_ptr_) {}
+
+    TimedStateConstraint* clone() const override {
+        return new TimedStateConstraint(*this);
+    }
+
+    bool isActive(ocs2::scalar_t time) const override {
+        return constraint_ptr_->isActive(time);
+    }
+
+    size_t getNumConstraints(ocs2::scalar_t time) const override {
+        return constraint_ptr_->getNumConstraints(time);
+    }
+
+    VecXd getValue(ocs2::scalar_t time, const VecXd& state,
+                   const ocs2::PreComputation& pre_comp) const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return constraint_ptr_->getValue(time, state, pre_comp);
+    }
+
+    ocs2::VectorFunctionLinearApproximation getLinearApproximation(
+        ocs2::scalar_t time, const VecXd& state,
+        const ocs2::PreComputation& pre_comp) const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return constraint_ptr_->getLinearApproximation(time, state, pre_comp);
+    }
+
+    ocs2::VectorFunctionQuadraticApproximation getQuadraticApproximation(
+        ocs2::scalar_t time, const VecXd& state,
+        const ocs2::PreComputation& pre_comp) const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return constraint_ptr_->getQuadraticApproximation(time, state,
+                                                          pre_comp);
+    }
+
+   private:
+    std::unique_ptr<ocs2::StateConstraint> constraint_ptr_;
+    std::shared_ptr<TermTimer> timer_ptr_;
+};
+
+class TimedStateInputConstraint final : public ocs2::StateInputConstraint {
+   public:
+    TimedStateInputConstraint(
+        std::unique_ptr<ocs2::StateInputConstraint> constraint,
+        std::shared_ptr<TermTimer> timer)
+        : ocs2::StateInputConstraint(constraint->getOrder()),
+          constraint_ptr_(std::move(constraint)),
+          timer_ptr_(std::move(timer)) {}
+
+    TimedStateInputConstraint(const TimedStateInputConstraint& other)
+        : ocs2::StateInputConstraint(other),
+          constraint_ptr_(other.constraint_ptr_->clone()),
+          timer_ptr_(other.timer_ptr_) {}
+
+    TimedStateInputConstraint* clone() const override {
+        return new TimedStateInputConstraint(*this);
+    }
+
+    bool isActive(ocs2::scalar_t time) const override {
+        return constraint_ptr_->isActive(time);
+    }
+
+    size_t getNumConstraints(ocs2::scalar_t time) const override {
+        return constraint_ptr_->getNumConstraints(time);
+    }
+
+    VecXd getValue(ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+                   const ocs2::PreComputation& pre_comp) const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return constraint_ptr_->getValue(time, state, input, pre_comp);
+    }
+
+    ocs2::VectorFunctionLinearApproximation getLinearApproximation(
+        ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+        const ocs2::PreComputation& pre_comp) const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return constraint_ptr_->getLinearApproximation(time, state, input,
+                                                       pre_comp);
+    }
+
+    ocs2::VectorFunctionQuadraticApproximation getQuadraticApproximation(
+        ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+        const ocs2::PreComputation& pre_comp) const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return constraint_ptr_->getQuadraticApproximation(time, state, input,
+                                                          pre_comp);
+    }
+
+   private:
+    std::unique_ptr<ocs2::StateInputConstraint> constraint_ptr_;
+    std::shared_ptr<TermTimer> timer_ptr_;
+};
+
+class TimedStateCost final : public ocs2::StateCost {
+   public:
+    TimedStateCost(std::unique_ptr<ocs2::StateCost> cost,
+                   std::shared_ptr<TermTimer> timer)
+        : cost_ptr_(std::move(cost)), timer_ptr_(std::move(timer)) {}
+
+    TimedStateCost(const TimedStateCost& other)
+        : ocs2::StateCost(other),
+          cost_ptr_(other.cost_ptr_->clone()),
+          timer_ptr_(other.timer_ptr_) {}
+
+    TimedStateCost* clone() const override {
+        return new TimedStateCost(*this);
+    }
+
+    bool isActive(ocs2::scalar_t time) const override {
+        return cost_ptr_->isActive(time);
+    }
+
+    ocs2::scalar_t getValue(ocs2::scalar_t time, const VecXd& state,
+                            const ocs2::TargetTrajectories& target,
+                            const ocs2::PreComputation& pre_comp)
+        const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return cost_ptr_->getValue(time, state, target, pre_comp);
+    }
+
+    ocs2::ScalarFunctionQuadraticApproximation getQuadraticApproximation(
+        ocs2::scalar_t time, const VecXd& state,
+        const ocs2::TargetTrajectories& target,
+        const ocs2::PreComputation& pre_comp) const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return cost_ptr_->getQuadraticApproximation(time, state, target,
+                                                    pre_comp);
+    }
+
+   private:
+    std::unique_ptr<ocs2::StateCost> cost_ptr_;
+    std::shared_ptr<TermTimer> timer_ptr_;
+};
+
+class TimedStateInputCost final : public ocs2::StateInputCost {
+   public:
+    TimedStateInputCost(std::unique_ptr<ocs2::StateInputCost> cost,
+                        std::shared_ptr<TermTimer> timer)
+        : cost_ptr_(std::move(cost)), timer_ptr_(std::move(timer)) {}
+
+    TimedStateInputCost(const TimedStateInputCost& other)
+        : ocs2::StateInputCost(other),
+          cost_ptr_(other.cost_ptr_->clone()),
+          timer_ptr_(other.timer_ptr_) {}
+
+    TimedStateInputCost* clone() const override {
+        return new TimedStateInputCost(*this);
+    }
+
+    bool isActive(ocs2::scalar_t time) const override {
+        return cost_ptr_->isActive(time);
+    }
+
+    ocs2::scalar_t getValue(ocs2::scalar_t time, const VecXd& state,
+                            const VecXd& input,
+                            const ocs2::TargetTrajectories& target,
+                            const ocs2::PreComputation& pre_comp)
+        const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return cost_ptr_->getValue(time, state, input, target, pre_comp);
+    }
+
+    ocs2::ScalarFunctionQuadraticApproximation getQuadraticApproximation(
+        ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+        const ocs2::TargetTrajectories& target,
+        const ocs2::PreComputation& pre_comp) const override {
+        ScopedTermTimer sample(timer_ptr_.get());
+        return cost_ptr_->getQuadraticApproximation(time, state, input, target,
+                                                    pre_comp);
+    }
+
+   private:
+    std::unique_ptr<ocs2::StateInputCost> cost_ptr_;
+    std::shared_ptr<TermTimer> timer_ptr_;
+};
+
+}  // namespace upright
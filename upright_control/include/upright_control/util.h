@@ -12,7 +12,7 @@
 
 namespace upright {
 
-ocs2::PinocchioInterface build_pinocchio_interface(
+inline ocs2::PinocchioInterface build_pinocchio_interface(
     const std::string& urdf_path, const RobotBaseType base_type,
     const std::map<std::string, ocs2::scalar_t>& locked_joints,
     const Vec3d& base_pose) {
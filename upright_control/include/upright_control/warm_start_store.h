@@ -0,0 +1,155 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include <ocs2_core/Types.h>
+
+#include <upright_control/library_cache.h>
+#include <upright_control/types.h>
+
+namespace upright {
+
+// Version of the binary warm-start file format. Bump this whenever the
+// layout changes: a file with a mismatched version is treated as a miss
+// rather than misinterpreted.
+constexpr uint32_t WARM_START_FORMAT_VERSION = 1;
+
+constexpr uint32_t WARM_START_MAGIC = 0x55575354;  // "UWST"
+
+// Fixed-size header of a warm-start file. The trajectory data follows
+// immediately: num_nodes times, then num_nodes states of dimension nx, then
+// num_nodes inputs of dimension nu, all as native scalars. Like the settings
+// snapshot, the format is a local cache, not an interchange format.
+struct WarmStartFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t num_nodes;
+    uint64_t nx;
+    uint64_t nu;
+};
+
+// Persists the solver's final primal trajectory across controller restarts,
+// keyed by a content hash of the settings and target, so that repeated runs
+// of the same task start the SQP near the previous solution instead of from
+// scratch. Files are loaded with mmap and copied out directly, so a hit
+// costs microseconds at startup.
+class WarmStartStore {
+   public:
+    explicit WarmStartStore(const std::string& folder) : folder_(folder) {}
+
+    std::string path(const LibraryHash& key) const {
+        return folder_ + "/warm_start_" + key.hex() + ".bin";
+    }
+
+    // Write the trajectory for the given key. The file is written to a
+    // temporary location and then renamed, so a concurrent load never sees a
+    // partial file.
+    void save(const LibraryHash& key, const ocs2::scalar_array_t& times,
+              const ocs2::vector_array_t& states,
+              const ocs2::vector_array_t& inputs) const {
+        if (times.size() < 2 || states.size() != times.size() ||
+            inputs.size() != times.size()) {
+            return;
+        }
+        boost::filesystem::create_directories(folder_);
+
+        WarmStartFileHeader header;
+        header.magic = WARM_START_MAGIC;
+        header.version = WARM_START_FORMAT_VERSION;
+        header.num_nodes = times.size();
+        header.nx = states.front().size();
+        header.nu = inputs.front().size();
+
+        const std::string final_path = path(key);
+        const std::string tmp_path = final_path + ".tmp";
+        {
+            std::ofstream out(tmp_path, std::ios::binary);
+            if (!out.good()) {
+                throw std::runtime_error("Failed to open " + tmp_path +
+                                         " for writing.");
+            }
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(times.data()),
+                      times.size() * sizeof(ocs2::scalar_t));
+            for (const auto& x : states) {
+                out.write(reinterpret_cast<const char*>(x.data()),
+                          header.nx * sizeof(ocs2::scalar_t));
+            }
+            for (const auto& u : inputs) {
+                out.write(reinterpret_cast<const char*>(u.data()),
+                          header.nu * sizeof(ocs2::scalar_t));
+            }
+        }
+        boost::filesystem::rename(tmp_path, final_path);
+    }
+
+    // Load the trajectory for the given key. Returns false (leaving the
+    // outputs untouched) when no file exists for the key or the file does
+    // not match the expected format and dimensions.
+    bool load(const LibraryHash& key, size_t nx, size_t nu,
+              ocs2::scalar_array_t& times, ocs2::vector_array_t& states,
+              ocs2::vector_array_t& inputs) const {
+        const std::string p = path(key);
+        const int fd = open(p.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 ||
+            static_cast<size_t>(st.st_size) < sizeof(WarmStartFileHeader)) {
+            close(fd);
+            return false;
+        }
+        const size_t file_size = st.st_size;
+        void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+
+        const auto* header = static_cast<const WarmStartFileHeader*>(addr);
+        const size_t n = header->num_nodes;
+        const size_t expected_size =
+            sizeof(WarmStartFileHeader) +
+            (n + n * nx + n * nu) * sizeof(ocs2::scalar_t);
+        if (header->magic != WARM_START_MAGIC ||
+            header->version != WARM_START_FORMAT_VERSION || header->nx != nx ||
+            header->nu != nu || n < 2 || file_size != expected_size) {
+            munmap(addr, file_size);
+            return false;
+        }
+
+        const auto* data = reinterpret_cast<const ocs2::scalar_t*>(
+            static_cast<const char*>(addr) + sizeof(WarmStartFileHeader));
+        times.assign(data, data + n);
+        states.clear();
+        states.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            states.push_back(
+                Eigen::Map<const VecXd>(data + n + i * nx, nx));
+        }
+        inputs.clear();
+        inputs.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            inputs.push_back(
+                Eigen::Map<const VecXd>(data + n + n * nx + i * nu, nu));
+        }
+        munmap(addr, file_size);
+        return true;
+    }
+
+   private:
+    std::string folder_;
+};
+
+}  // namespace upright
@@ -17,43 +17,61 @@ std::ostream& operator<<(std::ostream& out, const BalancingSettings& settings) {
         << std::endl
         << "ZMP enabled = " << settings.constraints_enabled.zmp << std::endl
         << "num objects = " << settings.objects.size() << std::endl
+        << "friction model = " << friction_model_to_string(settings.friction_model)
+        << std::endl
         << "mu = " << settings.mu << std::endl
         << "delta = " << settings.delta << std::endl;
     return out;
 }
 
-RigidBodyState<ocs2::ad_scalar_t> get_rigid_body_state(
-    const std::unique_ptr<ocs2::PinocchioEndEffectorKinematicsCppAd>&
-        kinematics_ptr,
-    const VecXad& state, const VecXad& input) {
-    RigidBodyState<ocs2::ad_scalar_t> X;
-    X.pose.position = kinematics_ptr->getPositionCppAd(state);
-    X.pose.orientation = kinematics_ptr->getOrientationCppAd(state);
-
-    X.velocity.linear = kinematics_ptr->getVelocityCppAd(state, input);
-    X.velocity.angular = kinematics_ptr->getAngularVelocityCppAd(state, input);
-
-    X.acceleration.linear = kinematics_ptr->getAccelerationCppAd(state, input);
-    X.acceleration.angular =
-        kinematics_ptr->getAngularAccelerationCppAd(state, input);
-    return X;
+// Number of contact force constraints produced per contact by each friction
+// model.
+static size_t num_force_constraints_per_contact(FrictionModel model) {
+    switch (model) {
+        case FrictionModel::Frictionless:
+            return 1;
+        case FrictionModel::ExactCone:
+            return NUM_FRICTION_CONSTRAINTS_PER_CONTACT;
+        default:
+            return NUM_LINEARIZED_FRICTION_CONSTRAINTS_PER_CONTACT;
+    }
+}
+
+// The friction model and the per-contact force dimension are configured
+// separately but must agree; catch mismatches at construction rather than
+// producing garbage constraint values.
+static void check_friction_model_dimensions(
+    FrictionModel model, const OptimizationDimensions& dims) {
+    const size_t expected_nf =
+        (model == FrictionModel::Frictionless) ? 1 : 3;
+    if (dims.nf != expected_nf) {
+        throw std::runtime_error(
+            "Friction model " + friction_model_to_string(model) +
+            " requires nf = " + std::to_string(expected_nf) + ", but nf = " +
+            std::to_string(dims.nf) + ".");
+    }
 }
 
 NominalBalancingConstraints::NominalBalancingConstraints(
-    const ocs2::PinocchioEndEffectorKinematicsCppAd& pinocchioEEKinematics,
+    const RigidBodyStateKinematicsCppAd& kinematics,
     const BalancingSettings& settings, const Vec3d& gravity,
-    const OptimizationDimensions& dims, bool recompileLibraries)
-    : ocs2::StateInputConstraintCppAd(ocs2::ConstraintOrder::Linear),
-      pinocchioEEKinPtr_(pinocchioEEKinematics.clone()),
+    const OptimizationDimensions& dims, const std::string& library_folder,
+    bool recompileLibraries)
+    : RobotStateInputConstraintCppAd(ocs2::ConstraintOrder::Linear, dims),
+      kinematics_(kinematics),
       gravity_(gravity),
       settings_(settings),
       arrangement_(settings.objects, settings.constraints_enabled, gravity),
-      dims_(dims) {
-    if (pinocchioEEKinematics.getIds().size() != 1) {
-        throw std::runtime_error(
-            "[TrayBalanaceConstraint] endEffectorKinematics has wrong "
-            "number of end effector IDs.");
-    }
+      library_folder_(library_folder) {
+    // Cast the arrangement to the AD type once; constraintFunction uses it
+    // only for the arrangement's structure (object names, iteration order,
+    // and per-object parameter counts).
+    ad_arrangement_ = arrangement_.cast<ocs2::ad_scalar_t>();
+
+    // The object properties (and gravity) are runtime parameters of the
+    // generated model, so swapping an arrangement with the same structure
+    // reuses the compiled library.
+    parameters_ = arrangement_.get_parameters();
 
     // NOTE: workaround for CppADCodeGen slow compilation for single objects
     // if (arrangement_.objects.size() == 1) {
@@ -62,50 +80,75 @@ NominalBalancingConstraints::NominalBalancingConstraints(
     // }
 
     // compile the CppAD library
-    initialize(dims.x(), dims.u(), 0, "upright_nominal_balancing_constraints",
-               "/tmp/ocs2", recompileLibraries, true);
+    initialize(parameters_.size(), "upright_nominal_balancing_constraints",
+               library_folder_, recompileLibraries, true);
 }
 
 VecXad NominalBalancingConstraints::constraintFunction(
     ocs2::ad_scalar_t time, const VecXad& state, const VecXad& input,
     const VecXad& parameters) const {
     RigidBodyState<ocs2::ad_scalar_t> X =
-        get_rigid_body_state(pinocchioEEKinPtr_, state, input);
+        kinematics_.getRigidBodyStateCppAd(state, input);
 
-    BalancedObjectArrangement<ocs2::ad_scalar_t> ad_arrangement =
-        arrangement_.cast<ocs2::ad_scalar_t>();
-    return ad_arrangement.balancing_constraints(X);
+    // Rebuild the arrangement from the runtime parameters (layout matches
+    // BalancedObjectArrangement::get_parameters), so that the object
+    // properties are tape variables rather than baked constants.
+    Vec3ad gravity = parameters.head(3);
+    std::map<std::string, BalancedObject<ocs2::ad_scalar_t>> objects;
+    size_t index = 3;
+    for (const auto& kv : ad_arrangement_.objects) {
+        const size_t n = kv.second.num_parameters();
+        objects.emplace(kv.first,
+                        BalancedObject<ocs2::ad_scalar_t>::from_parameters(
+                            parameters.segment(index, n)));
+        index += n;
+    }
+    BalancedObjectArrangement<ocs2::ad_scalar_t> arrangement(
+        objects, settings_.constraints_enabled, gravity);
+    return arrangement.balancing_constraints(X);
 }
 
 ContactForceBalancingConstraints::ContactForceBalancingConstraints(
     const ocs2::PinocchioEndEffectorKinematicsCppAd& pinocchioEEKinematics,
     const BalancingSettings& settings, const Vec3d& gravity,
-    const OptimizationDimensions& dims, bool recompileLibraries)
-    : ocs2::StateInputConstraintCppAd(ocs2::ConstraintOrder::Linear),
+    const OptimizationDimensions& dims, const std::string& library_folder,
+    bool recompileLibraries)
+    : RobotStateInputConstraintCppAd(ocs2::ConstraintOrder::Linear, dims),
       pinocchioEEKinPtr_(pinocchioEEKinematics.clone()),
       gravity_(gravity),
       settings_(settings),
-      dims_(dims) {
+      library_folder_(library_folder) {
     if (pinocchioEEKinematics.getIds().size() != 1) {
         throw std::runtime_error(
             "[TrayBalanaceConstraint] endEffectorKinematics has wrong "
             "number of end effector IDs.");
     }
 
-    // Important: this needs to come before the call to initialize, because it
-    // is used in the constraintFunction which is called therein
-    const bool frictionless = (dims.nf == 1);
-    if (frictionless) {
-        num_constraints_ = settings_.contacts.size();
-    } else {
-        num_constraints_ = settings_.contacts.size() *
-                           NUM_LINEARIZED_FRICTION_CONSTRAINTS_PER_CONTACT;
+    // Important: everything below needs to come before the call to
+    // initialize, because it is used in the constraintFunction which is
+    // called therein. The contact properties are runtime parameters of the
+    // generated model; only the number of contacts is baked into the tape.
+    size_t num_params = 0;
+    for (const auto& contact : settings_.contacts) {
+        num_params += contact.num_parameters();
+    }
+    parameters_.resize(num_params);
+    size_t index = 0;
+    for (const auto& contact : settings_.contacts) {
+        parameters_.segment(index, contact.num_parameters()) =
+            contact.get_parameters();
+        index += contact.num_parameters();
     }
 
+    check_friction_model_dimensions(settings_.friction_model, dims);
+    num_constraints_ =
+        settings_.contacts.size() *
+        num_force_constraints_per_contact(settings_.friction_model);
+
     // compile the CppAD library
     const std::string lib_name = "upright_contact_force_constraints";
-    initialize(dims.x(), dims.u(), 0, lib_name, "/tmp/ocs2", recompileLibraries,
-               true);
+    initialize(parameters_.size(), lib_name, library_folder_,
+               recompileLibraries, true);
 }
 
 VecXad ContactForceBalancingConstraints::constraintFunction(
@@ -114,28 +157,125 @@ VecXad ContactForceBalancingConstraints::constraintFunction(
     // All forces are expressed in the EE frame
     VecXad forces = input.tail(dims_.f());
 
-    std::vector<ContactPoint<ocs2::ad_scalar_t>> ad_contacts;
-    for (auto& contact : settings_.contacts) {
-        ad_contacts.push_back(contact.template cast<ocs2::ad_scalar_t>());
+    // Rebuild the contacts from the runtime parameters. The friction
+    // constraints do not track object wrenches, so the batch is built without
+    // wrench maps.
+    std::vector<ContactPoint<ocs2::ad_scalar_t>> contacts;
+    size_t index = 0;
+    for (size_t i = 0; i < settings_.contacts.size(); ++i) {
+        contacts.push_back(
+            ContactPoint<ocs2::ad_scalar_t>::from_parameters(parameters,
+                                                             index));
+        index += contacts.back().num_parameters();
+    }
+    const ContactBatch<ocs2::ad_scalar_t> batch(contacts, 0);
+
+    // The switch resolves once at taping time, so each generated tape
+    // contains only its own friction model's kernel.
+    switch (settings_.friction_model) {
+        case FrictionModel::Frictionless:
+            return compute_contact_force_constraints(FrictionlessTag{}, batch,
+                                                     forces);
+        case FrictionModel::ExactCone:
+            return compute_contact_force_constraints(ExactConeTag{}, batch,
+                                                     forces);
+        default:
+            return compute_contact_force_constraints(LinearizedConeTag{},
+                                                     batch, forces);
     }
+}
+
+LinearContactForceBalancingConstraints::LinearContactForceBalancingConstraints(
+    const BalancingSettings& settings, const OptimizationDimensions& dims)
+    : ocs2::StateInputConstraint(ocs2::ConstraintOrder::Linear) {
+    if (settings.friction_model == FrictionModel::ExactCone) {
+        throw std::runtime_error(
+            "[LinearContactForceBalancingConstraints] The exact friction "
+            "cone is quadratic in the forces; use "
+            "ContactForceBalancingConstraints instead.");
+    }
+    check_friction_model_dimensions(settings.friction_model, dims);
+
+    const size_t num_contacts = settings.contacts.size();
+    const bool frictionless =
+        (settings.friction_model == FrictionModel::Frictionless);
+    num_constraints_ =
+        num_contacts * num_force_constraints_per_contact(settings.friction_model);
 
-    ocs2::ad_scalar_t n(ad_contacts.size());
-    return compute_contact_force_constraints_linearized(ad_contacts, forces);
+    // The forces occupy the tail of the input vector. Row ordering matches
+    // compute_contact_force_constraints_linearized: per contact, the normal
+    // force followed by the four facets of the pyramidal cone.
+    dfdu_ = MatXd::Zero(num_constraints_, dims.u());
+    const size_t force_start = dims.u() - dims.f();
+    for (size_t i = 0; i < num_contacts; ++i) {
+        const auto& contact = settings.contacts[i];
+        if (frictionless) {
+            dfdu_(i, force_start + i) = 1.0;
+            continue;
+        }
+
+        const Eigen::RowVector3d normal = contact.normal.transpose();
+        const Eigen::RowVector3d s1 = contact.span.row(0);
+        const Eigen::RowVector3d s2 = contact.span.row(1);
+
+        auto block = dfdu_.block<5, 3>(5 * i, force_start + 3 * i);
+        block.row(0) = normal;
+        block.row(1) = contact.mu * normal - s1 - s2;
+        block.row(2) = contact.mu * normal - s1 + s2;
+        block.row(3) = contact.mu * normal + s1 - s2;
+        block.row(4) = contact.mu * normal + s1 + s2;
+    }
 }
 
 ObjectDynamicsConstraints::ObjectDynamicsConstraints(
-    const ocs2::PinocchioEndEffectorKinematicsCppAd& pinocchioEEKinematics,
+    const RigidBodyStateKinematicsCppAd& kinematics,
     const BalancingSettings& settings, const Vec3d& gravity,
-    const OptimizationDimensions& dims, bool recompileLibraries)
-    : ocs2::StateInputConstraintCppAd(ocs2::ConstraintOrder::Linear),
-      pinocchioEEKinPtr_(pinocchioEEKinematics.clone()),
+    const OptimizationDimensions& dims, const std::string& library_folder,
+    bool recompileLibraries)
+    : RobotStateInputConstraintCppAd(ocs2::ConstraintOrder::Linear, dims),
+      kinematics_(kinematics),
       gravity_(gravity),
       settings_(settings),
-      dims_(dims) {
-    if (pinocchioEEKinematics.getIds().size() != 1) {
-        throw std::runtime_error(
-            "[TrayBalanaceConstraint] endEffectorKinematics has wrong "
-            "number of end effector IDs.");
+      library_folder_(library_folder) {
+    check_friction_model_dimensions(settings_.friction_model, dims);
+
+    // Cast contacts, objects, and gravity to the AD type once; only their
+    // structure (names, iteration order, contact topology) is consumed while
+    // taping. The numeric properties enter as runtime parameters below.
+    for (const auto& contact : settings_.contacts) {
+        ad_contacts_.push_back(contact.template cast<ocs2::ad_scalar_t>());
+    }
+    for (const auto& kv : settings_.objects) {
+        ad_objects_.emplace(kv.first,
+                            kv.second.template cast<ocs2::ad_scalar_t>());
+    }
+    ad_gravity_ = gravity_.template cast<ocs2::ad_scalar_t>();
+
+    // Resolve contact object names to indices once; the per-evaluation
+    // wrench maps are then keyed by index.
+    resolve_contact_object_indices(ad_objects_, ad_contacts_);
+
+    // Parameter vector: the object parameters in map iteration order,
+    // followed by the per-contact parameters. Changing a mass, CoM, or
+    // contact position is then a parameter update, not a recompile.
+    size_t num_params = 0;
+    for (const auto& kv : settings_.objects) {
+        num_params += kv.second.num_parameters();
+    }
+    for (const auto& contact : settings_.contacts) {
+        num_params += contact.num_parameters();
+    }
+    parameters_.resize(num_params);
+    size_t index = 0;
+    for (const auto& kv : settings_.objects) {
+        const size_t n = kv.second.num_parameters();
+        parameters_.segment(index, n) = kv.second.get_parameters();
+        index += n;
+    }
+    for (const auto& contact : settings_.contacts) {
+        parameters_.segment(index, contact.num_parameters()) =
+            contact.get_parameters();
+        index += contact.num_parameters();
     }
 
     // Six constraints per object: three linear and three rotational.
@@ -144,8 +284,8 @@ ObjectDynamicsConstraints::ObjectDynamicsConstraints(
 
     // compile the CppAD library
     const std::string lib_name = "upright_object_dynamics_constraints";
-    initialize(dims.x(), dims.u(), 0, lib_name, "/tmp/ocs2", recompileLibraries,
-               true);
+    initialize(parameters_.size(), lib_name, library_folder_,
+               recompileLibraries, true);
 }
 
 VecXad ObjectDynamicsConstraints::constraintFunction(
@@ -155,29 +295,50 @@ VecXad ObjectDynamicsConstraints::constraintFunction(
     VecXad forces = input.tail(dims_.f());
 
     RigidBodyState<ocs2::ad_scalar_t> X =
-        get_rigid_body_state(pinocchioEEKinPtr_, state, input);
+        kinematics_.getRigidBodyStateCppAd(state, input);
 
-    // Convert contact points to AD type
-    std::vector<ContactPoint<ocs2::ad_scalar_t>> ad_contacts;
-    for (const auto& contact : settings_.contacts) {
-        ad_contacts.push_back(contact.template cast<ocs2::ad_scalar_t>());
+    // Rebuild the objects and contacts from the runtime parameters (layout
+    // matches the constructor), carrying over the structural fields from the
+    // AD copies made at construction.
+    std::map<std::string, BalancedObject<ocs2::ad_scalar_t>> objects;
+    size_t index = 0;
+    for (const auto& kv : ad_objects_) {
+        const size_t n = kv.second.num_parameters();
+        objects.emplace(kv.first,
+                        BalancedObject<ocs2::ad_scalar_t>::from_parameters(
+                            parameters.segment(index, n)));
+        index += n;
     }
-
-    // Convert objects to AD type
-    std::map<std::string, BalancedObject<ocs2::ad_scalar_t>> ad_objects;
-    for (const auto& kv : settings_.objects) {
-        auto obj_ad = kv.second.template cast<ocs2::ad_scalar_t>();
-        ad_objects.emplace(kv.first, obj_ad);
+    std::vector<ContactPoint<ocs2::ad_scalar_t>> contacts;
+    for (const auto& skeleton : ad_contacts_) {
+        ContactPoint<ocs2::ad_scalar_t> contact =
+            ContactPoint<ocs2::ad_scalar_t>::from_parameters(parameters,
+                                                             index);
+        contact.object1_index = skeleton.object1_index;
+        contact.object2_index = skeleton.object2_index;
+        index += contact.num_parameters();
+        contacts.push_back(contact);
     }
 
-    Vec3ad ad_gravity = gravity_.template cast<ocs2::ad_scalar_t>();
+    // Pack the contacts into a structure-of-arrays batch with wrench maps,
+    // so the constraint reduces to dense matrix expressions.
+    const ContactBatch<ocs2::ad_scalar_t> batch(contacts, objects.size());
 
     // Normalizing by the number of constraints appears to improve the
     // convergence of the controller (cost landscape is better behaved)
     // TODO
-    ocs2::ad_scalar_t n(sqrt(6 * ad_objects.size()));
-    return compute_object_dynamics_constraints(ad_objects, ad_contacts, forces,
-                                               X, ad_gravity) / n;
+    ocs2::ad_scalar_t n(sqrt(6 * objects.size()));
+
+    // The wrench map is selected by the friction model once at taping time;
+    // both cone models use the full per-contact forces.
+    if (settings_.friction_model == FrictionModel::Frictionless) {
+        return compute_object_dynamics_constraints(FrictionlessTag{}, objects,
+                                                   batch, forces, X,
+                                                   ad_gravity_) / n;
+    }
+    return compute_object_dynamics_constraints(LinearizedConeTag{}, objects,
+                                               batch, forces, X,
+                                               ad_gravity_) / n;
 }
 
 }  // namespace upright
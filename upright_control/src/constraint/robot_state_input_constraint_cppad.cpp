@@ -0,0 +1,70 @@
+#include "upright_control/constraint/robot_state_input_constraint_cppad.h"
+
+#include <cassert>
+
+namespace upright {
+
+void RobotStateInputConstraintCppAd::initialize(size_t num_params,
+                                                const std::string& model_name,
+                                                const std::string& model_folder,
+                                                bool recompile_libraries,
+                                                bool verbose) {
+    const size_t nrx = dims_.robot.x;
+    const size_t nx = dims_.x();
+    const size_t nu = dims_.u();
+    auto ad_func = [=](const VecXad& taped_vars, const VecXad& p, VecXad& y) {
+        assert(taped_vars.rows() == 1 + nrx + nu);
+        const ocs2::ad_scalar_t t = taped_vars(0);
+        // Expand to the full state. The obstacle entries are AD constants, so
+        // their (structurally zero) Jacobian columns never enter the tape.
+        VecXad x = VecXad::Zero(nx);
+        x.head(nrx) = taped_vars.segment(1, nrx);
+        const VecXad u = taped_vars.tail(nu);
+        y = this->constraintFunction(t, x, u, p);
+    };
+    ad_interface_ptr_.reset(new ocs2::CppAdInterface(
+        ad_func, 1 + nrx + nu, num_params, model_name, model_folder));
+
+    if (recompile_libraries) {
+        ad_interface_ptr_->createModels(
+            ocs2::CppAdInterface::ApproximationOrder::First, verbose);
+    } else {
+        ad_interface_ptr_->loadModelsIfAvailable(
+            ocs2::CppAdInterface::ApproximationOrder::First, verbose);
+    }
+}
+
+VecXd RobotStateInputConstraintCppAd::getValue(
+    ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+    const ocs2::PreComputation&) const {
+    const size_t nrx = dims_.robot.x;
+    VecXd taped_time_state_input(1 + nrx + input.rows());
+    taped_time_state_input << time, state.head(nrx), input;
+    return ad_interface_ptr_->getFunctionValue(taped_time_state_input,
+                                               getParameters(time));
+}
+
+ocs2::VectorFunctionLinearApproximation
+RobotStateInputConstraintCppAd::getLinearApproximation(
+    ocs2::scalar_t time, const VecXd& state, const VecXd& input,
+    const ocs2::PreComputation&) const {
+    const size_t nrx = dims_.robot.x;
+    const size_t nu = input.rows();
+    const VecXd params = getParameters(time);
+    VecXd taped_time_state_input(1 + nrx + nu);
+    taped_time_state_input << time, state.head(nrx), input;
+
+    const MatXd J =
+        ad_interface_ptr_->getJacobian(taped_time_state_input, params);
+
+    ocs2::VectorFunctionLinearApproximation approximation(
+        getNumConstraints(time), state.rows(), nu);
+    approximation.f =
+        ad_interface_ptr_->getFunctionValue(taped_time_state_input, params);
+    approximation.dfdx.setZero();
+    approximation.dfdx.leftCols(nrx) = J.middleCols(1, nrx);
+    approximation.dfdu = J.rightCols(nu);
+    return approximation;
+}
+
+}  // namespace upright
@@ -27,6 +27,8 @@
 #include <upright_control/constraint/bounded_balancing_constraints.h>
 #include <upright_control/constraint/end_effector_box_constraint.h>
 #include <upright_control/constraint/joint_state_input_limits.h>
+#include <upright_control/constraint/node_schedule.h>
+#include <upright_control/constraint/obstacle_broadphase.h>
 #include <upright_control/constraint/obstacle_constraint.h>
 #include <upright_control/constraint/projectile_path_constraint.h>
 #include <upright_control/constraint/projectile_plane_constraint.h>
@@ -37,6 +39,9 @@
 #include <upright_control/dynamics/system_dynamics.h>
 #include <upright_control/dynamics/system_pinocchio_mapping.h>
 #include <upright_control/inertial_alignment.h>
+#include <upright_control/library_cache.h>
+#include <upright_control/parallel_model_builder.h>
+#include <upright_control/precomputation.h>
 #include <upright_control/util.h>
 
 #include <pinocchio/algorithm/frames.hpp>
@@ -99,6 +104,20 @@ void add_ground_plane(const ocs2::PinocchioInterface::Model& model,
     geom_model.addGeometryObject(ground_obj);
 }
 
+// Build the system dynamics with the given robot model and attach the solve
+// timer, returning the result through the base pointer.
+template <typename RobotDynamics>
+static std::unique_ptr<ocs2::SystemDynamicsBase> build_system_dynamics(
+    const std::string& model_name, const OptimizationDimensions& dims,
+    const std::string& model_folder, bool recompile_libraries,
+    std::shared_ptr<TermTimer> timer) {
+    std::unique_ptr<SystemDynamics<RobotDynamics>> dynamics(
+        new SystemDynamics<RobotDynamics>(model_name, dims, model_folder,
+                                          recompile_libraries, true));
+    dynamics->set_timer(std::move(timer));
+    return std::move(dynamics);
+}
+
 ControllerInterface::ControllerInterface(const ControllerSettings& settings)
     : settings_(settings) {
     std::cerr << "library folder = " << settings_.lib_folder << std::endl;
@@ -113,26 +132,97 @@ ControllerInterface::ControllerInterface(const ControllerSettings& settings)
     const bool recompile_libraries = settings_.recompile_libraries;
     settings_.sqp.integratorType = ocs2::SensitivityIntegratorType::RK4;
 
-    // Dynamics
-    // NOTE: we don't have any branches here because every system we use
-    // currently is an integrator
-    std::unique_ptr<ocs2::SystemDynamicsBase> dynamics_ptr(
-        new SystemDynamics<TripleIntegratorDynamics<ocs2::ad_scalar_t>>(
-            "system_dynamics", settings_.dims, settings_.lib_folder,
-            recompile_libraries, true));
+    // Content-addressed cache for the generated model libraries. Each model
+    // is keyed by the settings that affect its tape, so when the cache is
+    // enabled an unchanged model is reused rather than recompiled.
+    const LibraryCache lib_cache(settings_.lib_folder,
+                                 settings_.use_library_cache,
+                                 recompile_libraries);
+
+    // Key for models that depend only on the problem dimensions.
+    LibraryHash dims_key;
+    dims_key.add(settings_.dims.robot.q);
+    dims_key.add(settings_.dims.robot.v);
+    dims_key.add(settings_.dims.robot.x);
+    dims_key.add(settings_.dims.robot.u);
+    dims_key.add(settings_.dims.o);
+    dims_key.add(settings_.dims.c);
+    dims_key.add(settings_.dims.nf);
+
+    // Key for models that additionally depend on the robot kinematics.
+    LibraryHash robot_key = dims_key;
+    robot_key.add_file(settings_.robot_urdf_path);
+    robot_key.add(robot_base_type_to_string(settings_.robot_base_type));
+    robot_key.add(VecXd(settings_.base_pose));
+    for (const auto& kv : settings_.locked_joints) {
+        robot_key.add(kv.first);
+        robot_key.add(kv.second);
+    }
+
+    LibraryHash kinematics_key = robot_key;
+    kinematics_key.add(settings_.end_effector_link_name);
+
+    // The CppAD models below are independent of one another, but each one
+    // blocks on code generation and a C compiler invocation while it is
+    // built. Farm the builds out to a pool of worker threads: first the
+    // models that need only the Pinocchio interface, then (after a join) the
+    // ones that depend on the compiled end effector kinematics. The OCP
+    // collections are not thread-safe, so jobs lock problem_mutex to add
+    // their terms.
+    ParallelModelBuilder model_builder;
+    std::mutex problem_mutex;
+
+    // Dynamics: a nonholonomic base uses the reduced-velocity model with its
+    // own generated library; every other base type is a plain triple
+    // integrator.
+    const bool nonholonomic =
+        settings_.robot_base_type == RobotBaseType::Nonholonomic;
+    if (nonholonomic !=
+        (settings_.dims.robot.q == settings_.dims.robot.v + 1)) {
+        throw std::runtime_error(
+            "The nonholonomic base type requires robot dimensions with "
+            "q = v + 1; all other base types require q = v.");
+    }
+    const std::string dynamics_name =
+        nonholonomic ? "nonholonomic_system_dynamics" : "system_dynamics";
+    const std::string dynamics_folder =
+        lib_cache.folder(dynamics_name, dims_key);
+    const bool recompile_dynamics =
+        lib_cache.recompile(dynamics_name, dims_key);
+    const auto dynamics_timer = timing_registry_->timer("system_dynamics");
+    model_builder.add([this, &problem_mutex, nonholonomic, dynamics_name,
+                       dynamics_folder, recompile_dynamics, dynamics_timer]() {
+        std::unique_ptr<ocs2::SystemDynamicsBase> dynamics_ptr;
+        if (nonholonomic) {
+            dynamics_ptr =
+                build_system_dynamics<NonholonomicDynamics<ocs2::ad_scalar_t>>(
+                    dynamics_name, settings_.dims, dynamics_folder,
+                    recompile_dynamics, dynamics_timer);
+        } else {
+            dynamics_ptr = build_system_dynamics<
+                TripleIntegratorDynamics<ocs2::ad_scalar_t>>(
+                dynamics_name, settings_.dims, dynamics_folder,
+                recompile_dynamics, dynamics_timer);
+        }
+
+        // Rollout
+        rollout_ptr_.reset(
+            new ocs2::TimeTriggeredRollout(*dynamics_ptr, settings_.rollout));
 
-    // Rollout
-    rollout_ptr_.reset(
-        new ocs2::TimeTriggeredRollout(*dynamics_ptr, settings_.rollout));
+        // Optimal control problem
+        std::lock_guard<std::mutex> lock(problem_mutex);
+        problem_.dynamicsPtr = std::move(dynamics_ptr);
+    });
 
     // Reference manager
     reference_manager_ptr_.reset(new ocs2::ReferenceManager);
 
-    // Optimal control problem
-    problem_.dynamicsPtr = std::move(dynamics_ptr);
-
     // Regularization cost
-    problem_.costPtr->add("state_input_cost", get_quadratic_state_input_cost());
+    problem_.costPtr->add(
+        "state_input_cost",
+        std::unique_ptr<ocs2::StateInputCost>(new TimedStateInputCost(
+            get_quadratic_state_input_cost(),
+            timing_registry_->timer("state_input_cost"))));
 
     // Build the end effector kinematics
     SystemPinocchioMapping<TripleIntegratorPinocchioMapping<ocs2::ad_scalar_t>,
@@ -174,6 +264,18 @@ ControllerInterface::ControllerInterface(const ControllerSettings& settings)
 
     // Collision avoidance
     if (settings_.obstacle_settings.enabled) {
+        if (settings_.obstacle_settings.node_schedule.enabled) {
+            obstacle_node_schedule_ptr_.reset(
+                new NodeSchedule(settings_.obstacle_settings.node_schedule,
+                                 settings_.sqp.dt));
+            std::cerr << "Obstacle constraints evaluated at every "
+                      << settings_.obstacle_settings.node_schedule.stride
+                      << "th node beyond "
+                      << settings_.obstacle_settings.node_schedule
+                             .dense_horizon
+                      << " s." << std::endl;
+        }
+
         ocs2::PinocchioGeometryInterface geom_interface(
             *pinocchio_interface_ptr);
 
@@ -213,30 +315,170 @@ ControllerInterface::ControllerInterface(const ControllerSettings& settings)
 
         std::cout << *pinocchio_interface_ptr << std::endl;
 
-        if (settings_.obstacle_settings.constraint_type ==
-            ConstraintType::Soft) {
-            problem_.stateSoftConstraintPtr->add(
-                "obstacle_avoidance",
-                get_soft_obstacle_constraint(
-                    *pinocchio_interface_ptr, geom_interface,
-                    settings_.obstacle_settings, settings_.lib_folder,
-                    recompile_libraries));
+        LibraryHash obstacle_key = robot_key;
+        obstacle_key.add_file(settings_.obstacle_settings.obstacle_urdf_path);
+        obstacle_key.add(settings_.obstacle_settings.minimum_distance);
+        for (const auto& pair :
+             settings_.obstacle_settings.collision_link_pairs) {
+            obstacle_key.add(pair.first);
+            obstacle_key.add(pair.second);
+        }
+        for (const auto& sphere : settings_.obstacle_settings.extra_spheres) {
+            obstacle_key.add(sphere.name);
+            obstacle_key.add(sphere.parent_frame_name);
+            obstacle_key.add(VecXd(sphere.offset));
+            obstacle_key.add(sphere.radius);
+        }
+        for (const auto& obstacle :
+             settings_.obstacle_settings.dynamic_obstacles) {
+            obstacle_key.add(obstacle.name);
+            obstacle_key.add(obstacle.radius);
+        }
+        const std::string obstacle_folder =
+            lib_cache.folder("obstacle_avoidance", obstacle_key);
+
+        // The geometry interface must outlive the asynchronous constraint
+        // build below, so move it to the heap.
+        auto geom_interface_ptr =
+            std::make_shared<ocs2::PinocchioGeometryInterface>(geom_interface);
+        const bool recompile_obstacles =
+            lib_cache.recompile("obstacle_avoidance", obstacle_key);
+
+        if (settings_.obstacle_settings.use_broadphase) {
+            // Broadphase pruning: group the collision pairs by obstacle link
+            // and gate each group's narrowphase constraint on a temporal-
+            // coherence distance certificate, refreshed at the measured
+            // state before every solve by the synchronization module
+            // registered in get_mpc(). Far-away groups then drop out of the
+            // problem seen by the solver.
+            add_extra_collision_spheres(*pinocchio_interface_ptr,
+                                        *geom_interface_ptr,
+                                        settings_.obstacle_settings);
+
+            std::vector<std::string> group_names;
+            std::vector<std::vector<std::pair<std::string, std::string>>>
+                groups;
+            std::vector<size_t> pair_groups;
+            for (const auto& pair :
+                 settings_.obstacle_settings.collision_link_pairs) {
+                size_t g = group_names.size();
+                for (size_t k = 0; k < group_names.size(); ++k) {
+                    if (group_names[k] == pair.second) {
+                        g = k;
+                        break;
+                    }
+                }
+                if (g == group_names.size()) {
+                    group_names.push_back(pair.second);
+                    groups.emplace_back();
+                }
+                groups[g].push_back(pair);
+                pair_groups.push_back(g);
+            }
+
+            // The broadphase itself tracks every pair.
+            ocs2::PinocchioGeometryInterface broadphase_geom(
+                *geom_interface_ptr);
+            broadphase_geom.addCollisionPairsByName(
+                settings_.obstacle_settings.collision_link_pairs);
+            obstacle_broadphase_ptr_.reset(new ObstacleBroadphase(
+                *pinocchio_interface_ptr, broadphase_geom,
+                settings_.obstacle_settings, settings_.dims, pair_groups,
+                group_names.size()));
+
+            for (size_t g = 0; g < groups.size(); ++g) {
+                auto group_geom_ptr =
+                    std::make_shared<ocs2::PinocchioGeometryInterface>(
+                        *geom_interface_ptr);
+                group_geom_ptr->addCollisionPairsByName(groups[g]);
+                const std::string name =
+                    "obstacle_avoidance_group" + std::to_string(g);
+                const std::string group_folder =
+                    lib_cache.folder(name, obstacle_key);
+                const bool recompile_group =
+                    lib_cache.recompile(name, obstacle_key);
+
+                model_builder.add([this, &problem_mutex, group_geom_ptr,
+                                   name, group_folder, recompile_group, g]() {
+                    SystemPinocchioMapping<
+                        TripleIntegratorPinocchioMapping<ocs2::scalar_t>,
+                        ocs2::scalar_t>
+                        mapping(settings_.dims);
+                    std::unique_ptr<ocs2::StateConstraint> constraint(
+                        new ocs2::SelfCollisionConstraintCppAd(
+                            *pinocchio_interface_ptr, mapping,
+                            *group_geom_ptr,
+                            settings_.obstacle_settings.minimum_distance,
+                            name, group_folder, recompile_group, false));
+                    std::unique_ptr<ocs2::StateConstraint> gated(
+                        new BroadphaseGatedConstraint(std::move(constraint),
+                                                      obstacle_broadphase_ptr_,
+                                                      g));
+                    if (obstacle_node_schedule_ptr_) {
+                        gated.reset(new NodeScheduledConstraint(
+                            std::move(gated), obstacle_node_schedule_ptr_));
+                    }
+                    // All groups accumulate into one timer.
+                    gated.reset(new TimedStateConstraint(
+                        std::move(gated),
+                        timing_registry_->timer("obstacle_avoidance")));
+
+                    std::lock_guard<std::mutex> lock(problem_mutex);
+                    if (settings_.obstacle_settings.constraint_type ==
+                        ConstraintType::Soft) {
+                        std::unique_ptr<ocs2::PenaltyBase> penalty(
+                            new ocs2::RelaxedBarrierPenalty(
+                                {settings_.obstacle_settings.mu,
+                                 settings_.obstacle_settings.delta}));
+                        problem_.stateSoftConstraintPtr->add(
+                            name, std::unique_ptr<ocs2::StateCost>(
+                                      new ocs2::StateSoftConstraint(
+                                          std::move(gated),
+                                          std::move(penalty))));
+                    } else {
+                        problem_.inequalityConstraintPtr->add(
+                            name,
+                            std::unique_ptr<ocs2::StateInputConstraint>(
+                                new StateToStateInputConstraint(*gated)));
+                    }
+                });
+            }
+            std::cerr << "Obstacle avoidance with broadphase pruning is "
+                      << "enabled (" << group_names.size() << " groups)."
+                      << std::endl;
+        } else if (settings_.obstacle_settings.constraint_type ==
+                   ConstraintType::Soft) {
+            model_builder.add([this, &problem_mutex, geom_interface_ptr,
+                               obstacle_folder, recompile_obstacles]() {
+                auto obstacle_cost = get_soft_obstacle_constraint(
+                    *pinocchio_interface_ptr, *geom_interface_ptr,
+                    settings_.obstacle_settings, obstacle_folder,
+                    recompile_obstacles);
+                std::lock_guard<std::mutex> lock(problem_mutex);
+                problem_.stateSoftConstraintPtr->add(
+                    "obstacle_avoidance", std::move(obstacle_cost));
+            });
             std::cerr << "Soft obstacle avoidance constraints are enabled."
                       << std::endl;
         } else {
-            // Get the usual state constraint
-            std::unique_ptr<ocs2::StateConstraint> obstacle_constraint =
-                get_obstacle_constraint(
-                    *pinocchio_interface_ptr, geom_interface,
-                    settings_.obstacle_settings, settings_.lib_folder,
-                    recompile_libraries);
-
-            // Map it to a state-input constraint so it works with the current
-            // implementation of the hard inequality constraints
-            problem_.inequalityConstraintPtr->add(
-                "obstacle_avoidance",
-                std::unique_ptr<ocs2::StateInputConstraint>(
-                    new StateToStateInputConstraint(*obstacle_constraint)));
+            model_builder.add([this, &problem_mutex, geom_interface_ptr,
+                               obstacle_folder, recompile_obstacles]() {
+                // Get the usual state constraint
+                std::unique_ptr<ocs2::StateConstraint> obstacle_constraint =
+                    get_obstacle_constraint(
+                        *pinocchio_interface_ptr, *geom_interface_ptr,
+                        settings_.obstacle_settings, obstacle_folder,
+                        recompile_obstacles);
+
+                // Map it to a state-input constraint so it works with the
+                // current implementation of the hard inequality constraints
+                std::lock_guard<std::mutex> lock(problem_mutex);
+                problem_.inequalityConstraintPtr->add(
+                    "obstacle_avoidance",
+                    std::unique_ptr<ocs2::StateInputConstraint>(
+                        new StateToStateInputConstraint(
+                            *obstacle_constraint)));
+            });
             std::cerr << "Hard obstacle avoidance constraints are enabled."
                       << std::endl;
         }
@@ -244,27 +486,67 @@ ControllerInterface::ControllerInterface(const ControllerSettings& settings)
         std::cerr << "Obstacle avoidance is disabled." << std::endl;
     }
 
-    ocs2::PinocchioEndEffectorKinematicsCppAd end_effector_kinematics(
-        *pinocchio_interface_ptr, mapping, {settings_.end_effector_link_name},
-        settings_.dims.x(), settings_.dims.u(), "end_effector_kinematics",
-        settings_.lib_folder, recompile_libraries, false);
-
-    // Store for possible use by other callers.
-    end_effector_kinematics_ptr_.reset(end_effector_kinematics.clone());
-
-    // End effector pose cost
-    std::unique_ptr<ocs2::StateCost> end_effector_cost(new EndEffectorCost(
-        settings_.end_effector_weight, end_effector_kinematics));
-    problem_.stateCostPtr->add("end_effector_cost",
-                               std::move(end_effector_cost));
-
-    // Alternative auto-diff version with full Hessian
-    // std::unique_ptr<ocs2::StateCost> end_effector_cost(new
-    // EndEffectorCostCppAd(
-    //     settings_.end_effector_weight, end_effector_kinematics,
-    //     settings_.dims, recompile_libraries));
-    // problem_.stateCostPtr->add("end_effector_cost",
-    //                            std::move(end_effector_cost));
+    // Everything beyond this point needs the compiled end effector
+    // kinematics, so it is built as part of the first batch and the batch is
+    // joined here.
+    const std::string kinematics_folder =
+        lib_cache.folder("end_effector_kinematics", kinematics_key);
+    const bool recompile_kinematics =
+        lib_cache.recompile("end_effector_kinematics", kinematics_key);
+    model_builder.add([this, &mapping, kinematics_folder,
+                       recompile_kinematics]() {
+        end_effector_kinematics_ptr_.reset(
+            new ocs2::PinocchioEndEffectorKinematicsCppAd(
+                *pinocchio_interface_ptr, mapping,
+                {settings_.end_effector_link_name}, settings_.dims.x(),
+                settings_.dims.u(), "end_effector_kinematics",
+                kinematics_folder, recompile_kinematics, false));
+    });
+    model_builder.run();
+    ocs2::PinocchioEndEffectorKinematicsCppAd& end_effector_kinematics =
+        *end_effector_kinematics_ptr_;
+
+    // Fused kinematics for the balancing constraints: evaluates the full
+    // rigid body state of the EE in a single forward pass, rather than one
+    // pass per quantity.
+    RigidBodyStateKinematicsCppAd rigid_body_kinematics(
+        *pinocchio_interface_ptr, settings_.end_effector_link_name,
+        settings_.dims);
+
+    // Shared pre-computation: forward kinematics is evaluated once per node
+    // and cached for the analytic cost and constraint terms below.
+    problem_.preComputationPtr.reset(new UprightPreComputation(
+        *pinocchio_interface_ptr, settings_.end_effector_link_name,
+        settings_.dims));
+
+    // End effector pose cost. The default variant is analytical with a
+    // Gauss-Newton Hessian; the generated variant tapes the exact Hessian,
+    // which converges in fewer SQP iterations on high-curvature
+    // reorientation segments at a higher cost per evaluation. The desired
+    // pose enters the generated tape as a parameter, so reference updates do
+    // not retape.
+    std::unique_ptr<ocs2::StateCost> end_effector_cost;
+    if (settings_.use_full_hessian_end_effector_cost) {
+        // The weights are baked into the tape, so they are part of the key.
+        LibraryHash ee_cost_key = kinematics_key;
+        ee_cost_key.add(settings_.end_effector_weight);
+        const std::string ee_cost_folder =
+            lib_cache.folder("end_effector_cost_cppad", ee_cost_key);
+        const bool recompile_ee_cost =
+            lib_cache.recompile("end_effector_cost_cppad", ee_cost_key);
+        end_effector_cost.reset(new EndEffectorCostCppAd(
+            settings_.end_effector_weight, end_effector_kinematics,
+            settings_.dims, ee_cost_folder, recompile_ee_cost));
+        std::cerr << "Using full-Hessian end effector cost." << std::endl;
+    } else {
+        end_effector_cost.reset(new EndEffectorCost(
+            settings_.end_effector_weight, end_effector_kinematics));
+    }
+    problem_.stateCostPtr->add(
+        "end_effector_cost",
+        std::unique_ptr<ocs2::StateCost>(new TimedStateCost(
+            std::move(end_effector_cost),
+            timing_registry_->timer("end_effector_cost"))));
 
     // End effector position box constraint
     if (settings_.end_effector_box_constraint_enabled) {
@@ -283,56 +565,187 @@ ControllerInterface::ControllerInterface(const ControllerSettings& settings)
 
     // Experimental: projectile avoidance constraint
     if (settings_.projectile_path_constraint_enabled) {
+        // One seed bucket per shooting node over the horizon.
+        const size_t num_buckets =
+            static_cast<size_t>(
+                std::ceil(settings_.mpc.timeHorizon_ / settings_.sqp.dt)) +
+            1;
+        projectile_arc_cache_ptr_.reset(new ProjectileArcCache(
+            settings_.projectile_path_collision_links.size(), num_buckets));
+
+        if (settings_.projectile_path_node_schedule.enabled) {
+            projectile_node_schedule_ptr_.reset(new NodeSchedule(
+                settings_.projectile_path_node_schedule, settings_.sqp.dt));
+        }
+
         // TODO: hardcoded link name
-        ocs2::PinocchioEndEffectorKinematicsCppAd
-            end_effector_collision_kinematics(
-                *pinocchio_interface_ptr, mapping,
-                settings_.projectile_path_collision_links, settings_.dims.x(),
-                settings_.dims.u(), "end_effector_collision_kinematics",
-                settings_.lib_folder, recompile_libraries, false);
-
-        std::unique_ptr<ocs2::StateConstraint> projectile_constraint(
-            new ProjectilePathConstraint(end_effector_collision_kinematics,
-                                         *reference_manager_ptr_,
-                                         settings_.projectile_path_distances,
-                                         settings_.projectile_path_scale));
-        // new ProjectilePlaneConstraint(end_effector_collision_kinematics,
-        //                              *reference_manager_ptr_,
-        //                              settings_.projectile_path_distance));
-        problem_.inequalityConstraintPtr->add(
-            "projectile_constraint",
-            std::unique_ptr<ocs2::StateInputConstraint>(
-                new StateToStateInputConstraint(*projectile_constraint)));
+        LibraryHash collision_kinematics_key = robot_key;
+        for (const auto& link : settings_.projectile_path_collision_links) {
+            collision_kinematics_key.add(link);
+        }
+        const std::string collision_kinematics_folder = lib_cache.folder(
+            "end_effector_collision_kinematics", collision_kinematics_key);
+        const bool recompile_collision_kinematics = lib_cache.recompile(
+            "end_effector_collision_kinematics", collision_kinematics_key);
+        model_builder.add([this, &mapping, &problem_mutex,
+                           collision_kinematics_folder,
+                           recompile_collision_kinematics]() {
+            ocs2::PinocchioEndEffectorKinematicsCppAd
+                end_effector_collision_kinematics(
+                    *pinocchio_interface_ptr, mapping,
+                    settings_.projectile_path_collision_links,
+                    settings_.dims.x(), settings_.dims.u(),
+                    "end_effector_collision_kinematics",
+                    collision_kinematics_folder,
+                    recompile_collision_kinematics, false);
+
+            std::unique_ptr<ocs2::StateConstraint> projectile_constraint(
+                new ProjectilePathConstraint(
+                    end_effector_collision_kinematics, *reference_manager_ptr_,
+                    settings_.projectile_path_distances,
+                    settings_.projectile_path_scale,
+                    projectile_arc_cache_ptr_));
+            // new ProjectilePlaneConstraint(end_effector_collision_kinematics,
+            //                              *reference_manager_ptr_,
+            //                              settings_.projectile_path_distance));
+            if (projectile_node_schedule_ptr_) {
+                projectile_constraint.reset(new NodeScheduledConstraint(
+                    std::move(projectile_constraint),
+                    projectile_node_schedule_ptr_));
+            }
+            projectile_constraint.reset(new TimedStateConstraint(
+                std::move(projectile_constraint),
+                timing_registry_->timer("projectile_constraint")));
+            std::lock_guard<std::mutex> lock(problem_mutex);
+            problem_.inequalityConstraintPtr->add(
+                "projectile_constraint",
+                std::unique_ptr<ocs2::StateInputConstraint>(
+                    new StateToStateInputConstraint(*projectile_constraint)));
+        });
     }
 
     // Inertial alignment
+    LibraryHash alignment_key = kinematics_key;
+    alignment_key.add(VecXd(settings_.gravity));
+    alignment_key.add(settings_.inertial_alignment_settings.use_angular_acceleration);
+    alignment_key.add(settings_.inertial_alignment_settings.align_with_fixed_vector);
+    alignment_key.add(settings_.inertial_alignment_settings.alpha);
+    alignment_key.add(VecXd(settings_.inertial_alignment_settings.contact_plane_normal));
+    alignment_key.add(MatXd(settings_.inertial_alignment_settings.contact_plane_span));
+    alignment_key.add(VecXd(settings_.inertial_alignment_settings.com));
+
     if (settings_.inertial_alignment_settings.cost_enabled) {
-        std::unique_ptr<ocs2::StateInputCost> inertial_alignment_cost(
-            new InertialAlignmentCostGaussNewton(
-                end_effector_kinematics, settings_.inertial_alignment_settings,
-                settings_.gravity, settings_.dims, true));
-        problem_.costPtr->add("inertial_alignment_cost",
-                              std::move(inertial_alignment_cost));
+        const std::string alignment_cost_folder =
+            lib_cache.folder("inertial_alignment_cost", alignment_key);
+        const bool recompile_alignment_cost =
+            lib_cache.recompile("inertial_alignment_cost", alignment_key);
+        model_builder.add([this, &end_effector_kinematics, &problem_mutex,
+                           alignment_cost_folder, recompile_alignment_cost]() {
+            std::unique_ptr<ocs2::StateInputCost> inertial_alignment_cost(
+                new InertialAlignmentCostGaussNewton(
+                    end_effector_kinematics,
+                    settings_.inertial_alignment_settings, settings_.gravity,
+                    settings_.dims, alignment_cost_folder,
+                    recompile_alignment_cost));
+            std::lock_guard<std::mutex> lock(problem_mutex);
+            problem_.costPtr->add(
+                "inertial_alignment_cost",
+                std::unique_ptr<ocs2::StateInputCost>(new TimedStateInputCost(
+                    std::move(inertial_alignment_cost),
+                    timing_registry_->timer("inertial_alignment_cost"))));
+        });
         std::cout << "Inertial alignment cost enabled." << std::endl;
     }
     if (settings_.inertial_alignment_settings.constraint_enabled) {
-        std::unique_ptr<ocs2::StateInputConstraint>
-            inertial_alignment_constraint(new InertialAlignmentConstraint(
-                end_effector_kinematics, settings_.inertial_alignment_settings,
-                settings_.gravity, settings_.dims, recompile_libraries));
-        problem_.inequalityConstraintPtr->add(
-            "inertial_alignment_constraint",
-            std::move(inertial_alignment_constraint));
+        const std::string alignment_constraint_folder =
+            lib_cache.folder("inertial_alignment_constraint", alignment_key);
+        const bool recompile_alignment_constraint =
+            lib_cache.recompile("inertial_alignment_constraint", alignment_key);
+        model_builder.add([this, &end_effector_kinematics, &problem_mutex,
+                           alignment_constraint_folder,
+                           recompile_alignment_constraint]() {
+            std::unique_ptr<ocs2::StateInputConstraint>
+                inertial_alignment_constraint(new InertialAlignmentConstraint(
+                    end_effector_kinematics,
+                    settings_.inertial_alignment_settings, settings_.gravity,
+                    settings_.dims, alignment_constraint_folder,
+                    recompile_alignment_constraint));
+            std::lock_guard<std::mutex> lock(problem_mutex);
+            problem_.inequalityConstraintPtr->add(
+                "inertial_alignment_constraint",
+                std::unique_ptr<ocs2::StateInputConstraint>(
+                    new TimedStateInputConstraint(
+                        std::move(inertial_alignment_constraint),
+                        timing_registry_->timer(
+                            "inertial_alignment_constraint"))));
+        });
         std::cout << "Inertial alignment constraint enabled." << std::endl;
     }
 
     // TODO we're getting too nested here
     if (settings_.balancing_settings.enabled) {
+        if (settings_.balancing_node_schedule.enabled) {
+            balancing_node_schedule_ptr_.reset(new NodeSchedule(
+                settings_.balancing_node_schedule, settings_.sqp.dt));
+            std::cerr << "Balancing constraints evaluated at every "
+                      << settings_.balancing_node_schedule.stride
+                      << "th node beyond "
+                      << settings_.balancing_node_schedule.dense_horizon
+                      << " s." << std::endl;
+        }
+        // The balancing models depend on the kinematics plus the structure of
+        // the arrangement being balanced: object names and parameter counts
+        // (e.g. support area vertex counts) and the contact topology. The
+        // object and contact properties themselves are runtime parameters of
+        // the generated models, so swapping payload values reuses the
+        // compiled libraries.
+        LibraryHash balancing_key = kinematics_key;
+        balancing_key.add(VecXd(settings_.gravity));
+        balancing_key.add(
+            friction_model_to_string(settings_.balancing_settings.friction_model));
+        balancing_key.add(settings_.balancing_settings.constraints_enabled.normal);
+        balancing_key.add(settings_.balancing_settings.constraints_enabled.friction);
+        balancing_key.add(settings_.balancing_settings.constraints_enabled.zmp);
+        for (const auto& kv : settings_.balancing_settings.objects) {
+            balancing_key.add(kv.first);
+            balancing_key.add(kv.second.num_parameters());
+        }
+        for (const auto& contact : settings_.balancing_settings.contacts) {
+            balancing_key.add(contact.object1_name);
+            balancing_key.add(contact.object2_name);
+        }
+
         if (settings_.balancing_settings.use_force_constraints) {
-            problem_.equalityConstraintPtr->add(
-                "object_dynamics",
-                get_object_dynamics_constraint(end_effector_kinematics,
-                                               recompile_libraries));
+            const std::string object_dynamics_folder =
+                lib_cache.folder("object_dynamics_constraints", balancing_key);
+            const bool recompile_object_dynamics = lib_cache.recompile(
+                "object_dynamics_constraints", balancing_key);
+            model_builder.add([this, &rigid_body_kinematics, &problem_mutex,
+                               object_dynamics_folder,
+                               recompile_object_dynamics]() {
+                auto object_dynamics_constraint = get_object_dynamics_constraint(
+                    rigid_body_kinematics, object_dynamics_folder,
+                    recompile_object_dynamics);
+                std::lock_guard<std::mutex> lock(problem_mutex);
+                problem_.equalityConstraintPtr->add(
+                    "object_dynamics", std::move(object_dynamics_constraint));
+            });
+
+            // The exact friction cone is quadratic in the forces, so it is a
+            // codegen job like the other generated models; the frictionless
+            // and linearized-cone constraints are analytical and are
+            // constructed inline.
+            const bool exact_cone =
+                settings_.balancing_settings.friction_model ==
+                FrictionModel::ExactCone;
+            std::string contact_force_folder;
+            bool recompile_contact_forces = false;
+            if (exact_cone) {
+                contact_force_folder =
+                    lib_cache.folder("contact_force_constraints", balancing_key);
+                recompile_contact_forces = lib_cache.recompile(
+                    "contact_force_constraints", balancing_key);
+            }
 
             // Inequalities for the friction cones
             // NOTE: the hard inequality constraints appear to work much better
@@ -342,15 +755,32 @@ ControllerInterface::ControllerInterface(const ControllerSettings& settings)
                 std::cerr
                     << "Soft contact force-based balancing constraints enabled."
                     << std::endl;
-                problem_.softConstraintPtr->add(
-                    "contact_forces",
-                    get_soft_contact_force_constraint(end_effector_kinematics,
-                                                      recompile_libraries));
+                if (exact_cone) {
+                    model_builder.add([this, &problem_mutex,
+                                       contact_force_folder,
+                                       recompile_contact_forces]() {
+                        auto contact_force_constraint =
+                            get_soft_contact_force_constraint(
+                                contact_force_folder,
+                                recompile_contact_forces);
+                        std::lock_guard<std::mutex> lock(problem_mutex);
+                        problem_.softConstraintPtr->add(
+                            "contact_forces",
+                            std::move(contact_force_constraint));
+                    });
+                } else {
+                    problem_.softConstraintPtr->add(
+                        "contact_forces",
+                        get_soft_contact_force_constraint(
+                            contact_force_folder, recompile_contact_forces));
+                }
             } else {
                 std::cerr
                     << "Hard contact force-based balancing constraints enabled."
                     << std::endl;
-                const bool frictionless = (settings_.dims.nf == 1);
+                const bool frictionless =
+                    settings_.balancing_settings.friction_model ==
+                    FrictionModel::Frictionless;
                 if (frictionless) {
                     // lower bounds are already zero, make the upper ones
                     // arbitrary high values
@@ -368,11 +798,26 @@ ControllerInterface::ControllerInterface(const ControllerSettings& settings)
                     std::cout
                         << problem_.boundConstraintPtr->input_ub_.transpose()
                         << std::endl;
+                } else if (exact_cone) {
+                    model_builder.add([this, &problem_mutex,
+                                       contact_force_folder,
+                                       recompile_contact_forces]() {
+                        auto contact_force_constraint =
+                            get_contact_force_constraint(
+                                contact_force_folder,
+                                recompile_contact_forces);
+                        std::lock_guard<std::mutex> lock(problem_mutex);
+                        problem_.inequalityConstraintPtr->add(
+                            "contact_forces",
+                            std::move(contact_force_constraint));
+                    });
                 } else {
+                    // Analytical constraint: constructed inline since there
+                    // is no codegen job to parallelize.
                     problem_.inequalityConstraintPtr->add(
                         "contact_forces",
-                        get_contact_force_constraint(end_effector_kinematics,
-                                                     recompile_libraries));
+                        get_contact_force_constraint(contact_force_folder,
+                                                     recompile_contact_forces));
                 }
             }
         } else {
@@ -382,25 +827,49 @@ ControllerInterface::ControllerInterface(const ControllerSettings& settings)
                              "constraints enabled."
                           << std::endl;
 
-                problem_.softConstraintPtr->add(
-                    "balancing",
-                    get_soft_balancing_constraint(end_effector_kinematics,
-                                                  recompile_libraries));
+                const std::string balancing_folder = lib_cache.folder(
+                    "nominal_balancing_constraints", balancing_key);
+                const bool recompile_balancing = lib_cache.recompile(
+                    "nominal_balancing_constraints", balancing_key);
+                model_builder.add([this, &rigid_body_kinematics,
+                                   &problem_mutex, balancing_folder,
+                                   recompile_balancing]() {
+                    auto balancing_constraint = get_soft_balancing_constraint(
+                        rigid_body_kinematics, balancing_folder,
+                        recompile_balancing);
+                    std::lock_guard<std::mutex> lock(problem_mutex);
+                    problem_.softConstraintPtr->add(
+                        "balancing", std::move(balancing_constraint));
+                });
 
             } else {
                 std::cerr << "Hard ZMP/limit surface-based balancing "
                              "constraints enabled."
                           << std::endl;
-                problem_.inequalityConstraintPtr->add(
-                    "balancing",
-                    get_balancing_constraint(end_effector_kinematics,
-                                             recompile_libraries));
+                const std::string balancing_folder = lib_cache.folder(
+                    "nominal_balancing_constraints", balancing_key);
+                const bool recompile_balancing = lib_cache.recompile(
+                    "nominal_balancing_constraints", balancing_key);
+                model_builder.add([this, &rigid_body_kinematics,
+                                   &problem_mutex, balancing_folder,
+                                   recompile_balancing]() {
+                    auto balancing_constraint = get_balancing_constraint(
+                        rigid_body_kinematics, balancing_folder,
+                        recompile_balancing);
+                    std::lock_guard<std::mutex> lock(problem_mutex);
+                    problem_.inequalityConstraintPtr->add(
+                        "balancing", std::move(balancing_constraint));
+                });
             }
         }
     } else {
         std::cerr << "Balancing constraints disabled." << std::endl;
     }
 
+    // Join the second batch of model builds before the interface is handed to
+    // the solver.
+    model_builder.run();
+
     // Initialization state
     if (settings_.use_operating_points) {
         initializer_ptr_.reset(new ocs2::OperatingPoints(
@@ -422,10 +891,70 @@ std::unique_ptr<ocs2::MPC_BASE> ControllerInterface::get_mpc() {
     //     return std::unique_ptr<ocs2::MPC_BASE>(new ocs2::GaussNewtonDDP_MPC(
     //         mpcSettings_, ddpSettings_, *rollout_ptr_, problem_,
     //         *initializer_ptr_));
-    // } else {
-    return std::unique_ptr<ocs2::MPC_BASE>(new ocs2::MultipleShootingMpc(
-        settings_.mpc, settings_.sqp, problem_, *initializer_ptr_));
     // }
+    // With sqp.nThreads > 1 the solver linearizes the problem in parallel
+    // across the shooting nodes, giving each worker thread its own clone of
+    // the problem. All upright terms support this: they deep-copy their
+    // kinematics objects and compiled-model interfaces on clone(), so no
+    // evaluation workspace is shared between threads. The only object shared
+    // between clones is the obstacle broadphase, which is only written
+    // between solves (see ObstacleBroadphase::update).
+    // Real-time iteration mode: cap the per-solve SQP iteration count at a
+    // fixed budget so solve latency is bounded by the budget instead of
+    // varying with convergence. Each solve warm starts from the previous
+    // solution, so optimality is recovered across consecutive solves rather
+    // than within one; the initial solve keeps its configured (larger)
+    // iteration count since nothing is waiting on it yet.
+    ocs2::mpc::Settings mpc_settings = settings_.mpc;
+    ocs2::multiple_shooting::Settings sqp_settings = settings_.sqp;
+    if (settings_.realtime_iteration) {
+        if (settings_.realtime_iteration_budget < 1) {
+            throw std::runtime_error(
+                "realtime_iteration_budget must be positive.");
+        }
+        sqp_settings.sqpIteration = settings_.realtime_iteration_budget;
+        mpc_settings.coldStart_ = false;
+    }
+    std::unique_ptr<ocs2::MPC_BASE> mpc(new ocs2::MultipleShootingMpc(
+        mpc_settings, sqp_settings, problem_, *initializer_ptr_));
+
+    // Record the final iterate's performance index after every solve, so the
+    // suboptimality introduced by the iteration budget can be monitored.
+    rti_monitor_ptr_ = std::make_shared<RtiMonitor>();
+    mpc->getSolverPtr()->addSynchronizedModule(
+        std::make_shared<RtiMonitorModule>(rti_monitor_ptr_,
+                                           mpc->getSolverPtr()));
+
+    // Refresh the obstacle broadphase certificates before every solve.
+    if (obstacle_broadphase_ptr_ != nullptr) {
+        mpc->getSolverPtr()->addSynchronizedModule(
+            std::make_shared<ObstacleBroadphaseModule>(
+                obstacle_broadphase_ptr_));
+    }
+
+    // Re-anchor the projectile Newton-seed cache to each solve's horizon.
+    if (projectile_arc_cache_ptr_ != nullptr) {
+        mpc->getSolverPtr()->addSynchronizedModule(
+            std::make_shared<ProjectileArcCacheModule>(
+                projectile_arc_cache_ptr_));
+    }
+
+    // Re-anchor the per-term node schedules to each solve's horizon start.
+    std::vector<std::shared_ptr<NodeSchedule>> node_schedules;
+    if (obstacle_node_schedule_ptr_ != nullptr) {
+        node_schedules.push_back(obstacle_node_schedule_ptr_);
+    }
+    if (projectile_node_schedule_ptr_ != nullptr) {
+        node_schedules.push_back(projectile_node_schedule_ptr_);
+    }
+    if (balancing_node_schedule_ptr_ != nullptr) {
+        node_schedules.push_back(balancing_node_schedule_ptr_);
+    }
+    if (!node_schedules.empty()) {
+        mpc->getSolverPtr()->addSynchronizedModule(
+            std::make_shared<NodeScheduleModule>(std::move(node_schedules)));
+    }
+    return mpc;
 }
 
 std::unique_ptr<ocs2::StateInputCost>
@@ -451,21 +980,30 @@ ControllerInterface::get_quadratic_state_input_cost() {
 
 std::unique_ptr<ocs2::StateInputConstraint>
 ControllerInterface::get_balancing_constraint(
-    const ocs2::PinocchioEndEffectorKinematicsCppAd& end_effector_kinematics,
-    bool recompile_libraries) {
-    return std::unique_ptr<ocs2::StateInputConstraint>(
+    const RigidBodyStateKinematicsCppAd& kinematics,
+    const std::string& library_folder, bool recompile_libraries) {
+    std::unique_ptr<ocs2::StateInputConstraint> constraint(
         new NominalBalancingConstraints(
-            end_effector_kinematics, settings_.balancing_settings,
-            settings_.gravity, settings_.dims, recompile_libraries));
+            kinematics, settings_.balancing_settings,
+            settings_.gravity, settings_.dims, library_folder,
+            recompile_libraries));
+    if (balancing_node_schedule_ptr_) {
+        constraint.reset(new NodeScheduledStateInputConstraint(
+            std::move(constraint), balancing_node_schedule_ptr_));
+    }
+    return std::unique_ptr<ocs2::StateInputConstraint>(
+        new TimedStateInputConstraint(std::move(constraint),
+                                      timing_registry_->timer("balancing")));
 }
 
 std::unique_ptr<ocs2::StateInputCost>
 ControllerInterface::get_soft_balancing_constraint(
-    const ocs2::PinocchioEndEffectorKinematicsCppAd& end_effector_kinematics,
-    bool recompile_libraries) {
+    const RigidBodyStateKinematicsCppAd& kinematics,
+    const std::string& library_folder, bool recompile_libraries) {
     // compute the hard constraint
     std::unique_ptr<ocs2::StateInputConstraint> constraint =
-        get_balancing_constraint(end_effector_kinematics, recompile_libraries);
+        get_balancing_constraint(kinematics, library_folder,
+                                 recompile_libraries);
 
     // make it soft via penalty function
     std::vector<std::unique_ptr<ocs2::PenaltyBase>> penaltyArray(
@@ -483,21 +1021,26 @@ ControllerInterface::get_soft_balancing_constraint(
 
 std::unique_ptr<ocs2::StateInputConstraint>
 ControllerInterface::get_object_dynamics_constraint(
-    const ocs2::PinocchioEndEffectorKinematicsCppAd& end_effector_kinematics,
-    bool recompile_libraries) {
-    return std::unique_ptr<ocs2::StateInputConstraint>(
+    const RigidBodyStateKinematicsCppAd& kinematics,
+    const std::string& library_folder, bool recompile_libraries) {
+    std::unique_ptr<ocs2::StateInputConstraint> constraint(
         new ObjectDynamicsConstraints(
-            end_effector_kinematics, settings_.balancing_settings,
-            settings_.gravity, settings_.dims, recompile_libraries));
+            kinematics, settings_.balancing_settings,
+            settings_.gravity, settings_.dims, library_folder,
+            recompile_libraries));
+    return std::unique_ptr<ocs2::StateInputConstraint>(
+        new TimedStateInputConstraint(
+            std::move(constraint),
+            timing_registry_->timer("object_dynamics")));
 }
 
 std::unique_ptr<ocs2::StateInputCost>
 ControllerInterface::get_soft_object_dynamics_constraint(
-    const ocs2::PinocchioEndEffectorKinematicsCppAd& end_effector_kinematics,
-    bool recompile_libraries) {
+    const RigidBodyStateKinematicsCppAd& kinematics,
+    const std::string& library_folder, bool recompile_libraries) {
     // compute the hard constraint
     std::unique_ptr<ocs2::StateInputConstraint> constraint =
-        get_object_dynamics_constraint(end_effector_kinematics,
+        get_object_dynamics_constraint(kinematics, library_folder,
                                        recompile_libraries);
 
     // make it soft via penalty function: since this is an equality constraint,
@@ -517,22 +1060,36 @@ ControllerInterface::get_soft_object_dynamics_constraint(
 
 std::unique_ptr<ocs2::StateInputConstraint>
 ControllerInterface::get_contact_force_constraint(
-    const ocs2::PinocchioEndEffectorKinematicsCppAd& end_effector_kinematics,
-    bool recompile_libraries) {
+    const std::string& library_folder, bool recompile_libraries) {
+    std::unique_ptr<ocs2::StateInputConstraint> constraint;
+    if (settings_.balancing_settings.friction_model ==
+        FrictionModel::ExactCone) {
+        // The exact cone is quadratic in the forces, so it goes through the
+        // generated-model path rather than the analytical linear constraint.
+        constraint.reset(new ContactForceBalancingConstraints(
+            *end_effector_kinematics_ptr_, settings_.balancing_settings,
+            settings_.gravity, settings_.dims, library_folder,
+            recompile_libraries));
+    } else {
+        constraint.reset(new LinearContactForceBalancingConstraints(
+            settings_.balancing_settings, settings_.dims));
+    }
+    if (balancing_node_schedule_ptr_) {
+        constraint.reset(new NodeScheduledStateInputConstraint(
+            std::move(constraint), balancing_node_schedule_ptr_));
+    }
     return std::unique_ptr<ocs2::StateInputConstraint>(
-        new ContactForceBalancingConstraints(
-            end_effector_kinematics, settings_.balancing_settings,
-            settings_.gravity, settings_.dims, recompile_libraries));
+        new TimedStateInputConstraint(
+            std::move(constraint),
+            timing_registry_->timer("contact_forces")));
 }
 
 std::unique_ptr<ocs2::StateInputCost>
 ControllerInterface::get_soft_contact_force_constraint(
-    const ocs2::PinocchioEndEffectorKinematicsCppAd& end_effector_kinematics,
-    bool recompile_libraries) {
+    const std::string& library_folder, bool recompile_libraries) {
     // compute the hard constraint
     std::unique_ptr<ocs2::StateInputConstraint> constraint =
-        get_contact_force_constraint(end_effector_kinematics,
-                                     recompile_libraries);
+        get_contact_force_constraint(library_folder, recompile_libraries);
 
     // make it soft via penalty function
     std::vector<std::unique_ptr<ocs2::PenaltyBase>> penaltyArray(
@@ -547,12 +1104,12 @@ ControllerInterface::get_soft_contact_force_constraint(
                                            std::move(penaltyArray)));
 }
 
-std::unique_ptr<ocs2::StateConstraint>
-ControllerInterface::get_obstacle_constraint(
-    ocs2::PinocchioInterface& pinocchio_interface,
+// Attach the configured extra collision spheres to the robot body in the
+// geometry model.
+static void add_extra_collision_spheres(
+    const ocs2::PinocchioInterface& pinocchio_interface,
     ocs2::PinocchioGeometryInterface& geom_interface,
-    const ObstacleSettings& settings, const std::string& library_folder,
-    bool recompile_libraries) {
+    const ObstacleSettings& settings) {
     std::cerr << "Number of extra collision spheres = "
               << settings.extra_spheres.size() << std::endl;
 
@@ -579,6 +1136,16 @@ ControllerInterface::get_obstacle_constraint(
             sphere.name, parent_joint_id, geom_ptr, T_js));
     }
     geom_interface.addGeometryObjects(extra_spheres);
+}
+
+std::unique_ptr<ocs2::StateConstraint>
+ControllerInterface::get_obstacle_constraint(
+    ocs2::PinocchioInterface& pinocchio_interface,
+    ocs2::PinocchioGeometryInterface& geom_interface,
+    const ObstacleSettings& settings, const std::string& library_folder,
+    bool recompile_libraries) {
+    add_extra_collision_spheres(pinocchio_interface, geom_interface,
+                                settings);
 
     const auto& geom_model = geom_interface.getGeometryModel();
     for (int i = 0; i < geom_model.ngeoms; ++i) {
@@ -600,11 +1167,17 @@ ControllerInterface::get_obstacle_constraint(
                            ocs2::scalar_t>
         mapping(settings_.dims);
 
-    return std::unique_ptr<ocs2::StateConstraint>(
+    std::unique_ptr<ocs2::StateConstraint> constraint(
         new ocs2::SelfCollisionConstraintCppAd(
             pinocchio_interface, mapping, geom_interface,
             settings.minimum_distance, "obstacle_avoidance", library_folder,
             recompile_libraries, false));
+    if (obstacle_node_schedule_ptr_) {
+        constraint.reset(new NodeScheduledConstraint(
+            std::move(constraint), obstacle_node_schedule_ptr_));
+    }
+    return std::unique_ptr<ocs2::StateConstraint>(new TimedStateConstraint(
+        std::move(constraint), timing_registry_->timer("obstacle_avoidance")));
 }
 
 std::unique_ptr<ocs2::StateCost>
@@ -641,8 +1214,11 @@ ControllerInterface::get_joint_state_input_limit_constraint() {
     std::cout << "input limit upper: " << input_limit_upper.transpose()
               << std::endl;
 
-    return std::unique_ptr<ocs2::StateInputConstraint>(
+    std::unique_ptr<ocs2::StateInputConstraint> constraint(
         new JointStateInputLimits(settings_.dims));
+    return std::unique_ptr<ocs2::StateInputConstraint>(
+        new TimedStateInputConstraint(std::move(constraint),
+                                      timing_registry_->timer("joint_limits")));
 }
 
 std::unique_ptr<ocs2::StateInputCost>
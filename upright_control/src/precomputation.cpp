@@ -0,0 +1,81 @@
+// NOTE: pinocchio needs to be included before other things to prevent the
+// compiler fussing
+#include <pinocchio/algorithm/frames.hpp>
+#include <pinocchio/algorithm/jacobian.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
+
+#include "upright_control/precomputation.h"
+
+#include <stdexcept>
+
+namespace upright {
+
+UprightPreComputation::UprightPreComputation(
+    const ocs2::PinocchioInterface& pinocchio_interface,
+    const std::string& frame_name, const OptimizationDimensions& dims)
+    : pinocchio_interface_(pinocchio_interface), mapping_(dims), dims_(dims) {
+    const auto& model = pinocchio_interface_.getModel();
+    frame_id_ = model.getFrameId(frame_name);
+    if (frame_id_ == model.frames.size()) {
+        throw std::runtime_error("Robot model has no frame named " +
+                                 frame_name + ".");
+    }
+}
+
+void UprightPreComputation::request(ocs2::RequestSet request, ocs2::scalar_t t,
+                                    const VecXd& state, const VecXd& input) {
+    updateCache(request, state, input);
+}
+
+void UprightPreComputation::requestFinal(ocs2::RequestSet request,
+                                         ocs2::scalar_t t, const VecXd& state) {
+    // There is no input at the final node.
+    updateCache(request, state, VecXd::Zero(dims_.u()));
+}
+
+void UprightPreComputation::updateCache(ocs2::RequestSet request,
+                                        const VecXd& state,
+                                        const VecXd& input) {
+    const auto& model = pinocchio_interface_.getModel();
+    auto& data = pinocchio_interface_.getData();
+
+    const VecXd q = mapping_.getPinocchioJointPosition(state);
+    const VecXd v = mapping_.getPinocchioJointVelocity(state, input);
+    const VecXd a = mapping_.getPinocchioJointAcceleration(state, input);
+
+    pinocchio::forwardKinematics(model, data, q, v, a);
+    pinocchio::updateFramePlacements(model, data);
+
+    ee_state_.pose.position = data.oMf[frame_id_].translation();
+    ee_state_.pose.orientation = data.oMf[frame_id_].rotation();
+
+    const auto velocity = pinocchio::getFrameVelocity(
+        model, data, frame_id_, pinocchio::LOCAL_WORLD_ALIGNED);
+    ee_state_.velocity.linear = velocity.linear();
+    ee_state_.velocity.angular = velocity.angular();
+
+    const auto acceleration = pinocchio::getFrameClassicalAcceleration(
+        model, data, frame_id_, pinocchio::LOCAL_WORLD_ALIGNED);
+    ee_state_.acceleration.linear = acceleration.linear();
+    ee_state_.acceleration.angular = acceleration.angular();
+
+    has_approximation_ = request.contains(ocs2::Request::Approximation);
+    if (has_approximation_) {
+        // The forward pass above already populated the joint frames, so the
+        // Jacobians can be composed without recomputing the kinematics.
+        pinocchio::computeJointJacobians(model, data);
+        MatXd J = MatXd::Zero(6, model.nv);
+        pinocchio::getFrameJacobian(model, data, frame_id_,
+                                    pinocchio::LOCAL_WORLD_ALIGNED, J);
+
+        // The position depends only on the generalized positions.
+        const MatXd Jq = J.topRows(3);
+        const MatXd Jv = MatXd::Zero(3, model.nv);
+
+        position_approx_.f = ee_state_.pose.position;
+        std::tie(position_approx_.dfdx, position_approx_.dfdu) =
+            mapping_.getOcs2Jacobian(state, Jq, Jv);
+    }
+}
+
+}  // namespace upright
@@ -11,8 +11,10 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 #include <upright_control/balancing_constraint_wrapper.h>
+#include <upright_control/batch_rollout.h>
 #include <upright_control/constraint/bounded_balancing_constraints.h>
 #include <upright_control/constraint/constraint_type.h>
+#include <upright_control/constraint/friction_model.h>
 #include <upright_control/constraint/obstacle_constraint.h>
 #include <upright_control/controller_python_interface.h>
 #include <upright_control/controller_settings.h>
@@ -42,6 +44,13 @@ PYBIND11_MAKE_OPAQUE(std::vector<DynamicObstacle>)
 PYBIND11_MAKE_OPAQUE(std::vector<DynamicObstacleMode>)
 PYBIND11_MAKE_OPAQUE(std::map<std::string, ocs2::scalar_t>)
 
+// The contact/object containers are bound by upright_core (which must be
+// imported first); declaring them opaque here as well means
+// BalancingSettings.objects and .contacts are exposed as in-place views
+// instead of being copied to Python dicts/lists on every access.
+PYBIND11_MAKE_OPAQUE(std::vector<ContactPoint<scalar_t>>)
+PYBIND11_MAKE_OPAQUE(std::map<std::string, BalancedObject<scalar_t>>)
+
 /* create a python module */
 PYBIND11_MODULE(bindings, m) {
     /* bind vector types so they can be used natively in python */
@@ -74,6 +83,7 @@ PYBIND11_MODULE(bindings, m) {
         .def_readwrite("arrangement_name", &BalancingSettings::arrangement_name)
         .def_readwrite("use_force_constraints",
                        &BalancingSettings::use_force_constraints)
+        .def_readwrite("friction_model", &BalancingSettings::friction_model)
         .def_readwrite("constraints_enabled",
                        &BalancingSettings::constraints_enabled)
         .def_readwrite("objects", &BalancingSettings::objects)
@@ -90,6 +100,13 @@ PYBIND11_MODULE(bindings, m) {
     m.def("constraint_type_from_string", &constraint_type_from_string);
     m.def("constraint_type_to_string", &constraint_type_to_string);
 
+    pybind11::enum_<FrictionModel>(m, "FrictionModel")
+        .value("Frictionless", FrictionModel::Frictionless)
+        .value("LinearizedCone", FrictionModel::LinearizedCone)
+        .value("ExactCone", FrictionModel::ExactCone);
+    m.def("friction_model_from_string", &friction_model_from_string);
+    m.def("friction_model_to_string", &friction_model_to_string);
+
     pybind11::class_<CollisionSphere<scalar_t>>(m, "CollisionSphere")
         .def(pybind11::init<const std::string &, const std::string &,
                             const Eigen::Matrix<scalar_t, 3, 1> &,
@@ -114,6 +131,12 @@ PYBIND11_MODULE(bindings, m) {
         .def_readwrite("radius", &DynamicObstacle::radius)
         .def_readwrite("modes", &DynamicObstacle::modes);
 
+    pybind11::class_<NodeScheduleSettings>(m, "NodeScheduleSettings")
+        .def(pybind11::init<>())
+        .def_readwrite("enabled", &NodeScheduleSettings::enabled)
+        .def_readwrite("dense_horizon", &NodeScheduleSettings::dense_horizon)
+        .def_readwrite("stride", &NodeScheduleSettings::stride);
+
     pybind11::class_<ObstacleSettings>(m, "ObstacleSettings")
         .def(pybind11::init<>())
         .def_readwrite("enabled", &ObstacleSettings::enabled)
@@ -123,6 +146,12 @@ PYBIND11_MODULE(bindings, m) {
         .def_readwrite("constraint_type", &ObstacleSettings::constraint_type)
         .def_readwrite("mu", &ObstacleSettings::mu)
         .def_readwrite("delta", &ObstacleSettings::delta)
+        .def_readwrite("use_broadphase", &ObstacleSettings::use_broadphase)
+        .def_readwrite("broadphase_velocity_bound",
+                       &ObstacleSettings::broadphase_velocity_bound)
+        .def_readwrite("broadphase_safety_margin",
+                       &ObstacleSettings::broadphase_safety_margin)
+        .def_readwrite("node_schedule", &ObstacleSettings::node_schedule)
         .def_readwrite("obstacle_urdf_path",
                        &ObstacleSettings::obstacle_urdf_path)
         .def_readwrite("dynamic_obstacles",
@@ -236,6 +265,10 @@ PYBIND11_MODULE(bindings, m) {
             &ocs2::multiple_shooting::Settings::printSolverStatistics)
         .def_readwrite("print_line_search",
                        &ocs2::multiple_shooting::Settings::printLinesearch)
+        .def_readwrite("n_threads",
+                       &ocs2::multiple_shooting::Settings::nThreads)
+        .def_readwrite("thread_priority",
+                       &ocs2::multiple_shooting::Settings::threadPriority)
         .def_readwrite("hpipm",
                        &ocs2::multiple_shooting::Settings::hpipmSettings);
 
@@ -259,7 +292,23 @@ PYBIND11_MODULE(bindings, m) {
         .def_readwrite("input_violation_margin",
                        &TrackingSettings::input_violation_margin)
         .def_readwrite("ee_position_violation_margin",
-                       &TrackingSettings::ee_position_violation_margin);
+                       &TrackingSettings::ee_position_violation_margin)
+        .def_readwrite("realtime_strict", &TrackingSettings::realtime_strict)
+        .def_readwrite("use_steady_state_gain",
+                       &TrackingSettings::use_steady_state_gain)
+        .def_readwrite("steady_state_dt_tolerance",
+                       &TrackingSettings::steady_state_dt_tolerance)
+        .def_readwrite("use_shm_transport",
+                       &TrackingSettings::use_shm_transport)
+        .def_readwrite("realtime", &TrackingSettings::realtime);
+
+    pybind11::class_<RealtimeSettings>(m, "RealtimeSettings")
+        .def(pybind11::init<>())
+        .def_readwrite("control_priority", &RealtimeSettings::control_priority)
+        .def_readwrite("mpc_priority", &RealtimeSettings::mpc_priority)
+        .def_readwrite("control_cpus", &RealtimeSettings::control_cpus)
+        .def_readwrite("mpc_cpus", &RealtimeSettings::mpc_cpus)
+        .def_readwrite("lock_memory", &RealtimeSettings::lock_memory);
 
     pybind11::class_<EstimationSettings>(m, "EstimationSettings")
         .def(pybind11::init<>())
@@ -276,7 +325,15 @@ PYBIND11_MODULE(bindings, m) {
         .def_readwrite("solver_method", &ControllerSettings::solver_method)
         .def_readwrite("recompile_libraries",
                        &ControllerSettings::recompile_libraries)
+        .def_readwrite("use_warm_start_store",
+                       &ControllerSettings::use_warm_start_store)
+        .def_readwrite("warm_start_folder",
+                       &ControllerSettings::warm_start_folder)
         .def_readwrite("debug", &ControllerSettings::debug)
+        .def_readwrite("realtime_iteration",
+                       &ControllerSettings::realtime_iteration)
+        .def_readwrite("realtime_iteration_budget",
+                       &ControllerSettings::realtime_iteration_budget)
         .def_readwrite("mpc", &ControllerSettings::mpc)
         .def_readwrite("sqp", &ControllerSettings::sqp)
         .def_readwrite("rollout", &ControllerSettings::rollout)
@@ -291,6 +348,9 @@ PYBIND11_MODULE(bindings, m) {
         .def_readwrite("state_weight", &ControllerSettings::state_weight)
         .def_readwrite("end_effector_weight",
                        &ControllerSettings::end_effector_weight)
+        .def_readwrite(
+            "use_full_hessian_end_effector_cost",
+            &ControllerSettings::use_full_hessian_end_effector_cost)
         .def_readwrite("limit_constraint_type",
                        &ControllerSettings::limit_constraint_type)
         .def_readwrite("input_limit_lower",
@@ -319,6 +379,10 @@ PYBIND11_MODULE(bindings, m) {
                        &ControllerSettings::projectile_path_scale)
         .def_readwrite("projectile_path_collision_links",
                        &ControllerSettings::projectile_path_collision_links)
+        .def_readwrite("projectile_path_node_schedule",
+                       &ControllerSettings::projectile_path_node_schedule)
+        .def_readwrite("balancing_node_schedule",
+                       &ControllerSettings::balancing_node_schedule)
         .def_readwrite("robot_urdf_path", &ControllerSettings::robot_urdf_path)
         .def_readwrite("lib_folder", &ControllerSettings::lib_folder)
         .def_readwrite("robot_base_type", &ControllerSettings::robot_base_type)
@@ -387,7 +451,11 @@ PYBIND11_MODULE(bindings, m) {
         .def(pybind11::init<const ControllerSettings &>(), "settings"_a)
         .def("getLinearApproximation",
              &BalancingConstraintWrapper::getLinearApproximation, "t"_a, "x"_a,
-             "u"_a);
+             "u"_a)
+        .def("getLinearApproximationBatch",
+             &BalancingConstraintWrapper::getLinearApproximationBatch, "ts"_a,
+             "xs"_a, "us"_a, "num_threads"_a,
+             pybind11::call_guard<pybind11::gil_scoped_release>());
 
     /* bind TargetTrajectories class */
     pybind11::class_<ocs2::TargetTrajectories>(m, "TargetTrajectories")
@@ -419,6 +487,19 @@ PYBIND11_MODULE(bindings, m) {
         .def("advanceMpc", &ControllerPythonInterface::advanceMpc)
         .def("getMpcSolution", &ControllerPythonInterface::getMpcSolution,
              "t"_a.noconvert(), "x"_a.noconvert(), "u"_a.noconvert())
+        // Zero-copy alternative to getMpcSolution: cache once, then read
+        // the trajectories as NumPy views into buffers owned by this
+        // interface. The views are invalidated by the next cache call.
+        .def("cacheMpcSolution", &ControllerPythonInterface::cacheMpcSolution)
+        .def("getCachedTimeTrajectory",
+             &ControllerPythonInterface::getCachedTimeTrajectory,
+             pybind11::return_value_policy::reference_internal)
+        .def("getCachedStateTrajectory",
+             &ControllerPythonInterface::getCachedStateTrajectory,
+             pybind11::return_value_policy::reference_internal)
+        .def("getCachedInputTrajectory",
+             &ControllerPythonInterface::getCachedInputTrajectory,
+             pybind11::return_value_policy::reference_internal)
         .def("evaluateMpcSolution",
              &ControllerPythonInterface::evaluateMpcSolution,
              "current_time"_a.noconvert(), "current_state"_a.noconvert(),
@@ -455,6 +536,12 @@ PYBIND11_MODULE(bindings, m) {
              &ControllerPythonInterface::stateInputEqualityConstraintLagrangian,
              "t"_a, "x"_a.noconvert(), "u"_a.noconvert())
 
+        .def("getSolveTimingSeconds",
+             &ControllerPythonInterface::getSolveTimingSeconds)
+        .def("getSolveTimingCalls",
+             &ControllerPythonInterface::getSolveTimingCalls)
+        .def("resetSolveTimers", &ControllerPythonInterface::resetSolveTimers)
+
         .def("getStateInputEqualityConstraintValue",
              &ControllerPythonInterface::getStateInputEqualityConstraintValue,
              "name"_a, "t"_a, "x"_a.noconvert(), "u"_a.noconvert())
@@ -473,7 +560,51 @@ PYBIND11_MODULE(bindings, m) {
              "name"_a, "t"_a, "x"_a.noconvert())
         .def("getCostValue", &ControllerPythonInterface::getCostValue, "name"_a,
              "t"_a, "x"_a.noconvert(), "u"_a.noconvert())
+
+        // Batch variants evaluate whole trajectories across a thread pool
+        // with the GIL released.
+        .def("getStateInputEqualityConstraintValueBatch",
+             &ControllerPythonInterface::
+                 getStateInputEqualityConstraintValueBatch,
+             "name"_a, "ts"_a, "xs"_a, "us"_a, "num_threads"_a,
+             pybind11::call_guard<pybind11::gil_scoped_release>())
+        .def("getStateInputInequalityConstraintValueBatch",
+             &ControllerPythonInterface::
+                 getStateInputInequalityConstraintValueBatch,
+             "name"_a, "ts"_a, "xs"_a, "us"_a, "num_threads"_a,
+             pybind11::call_guard<pybind11::gil_scoped_release>())
+        .def("getSoftStateInputInequalityConstraintValueBatch",
+             &ControllerPythonInterface::
+                 getSoftStateInputInequalityConstraintValueBatch,
+             "name"_a, "ts"_a, "xs"_a, "us"_a, "num_threads"_a,
+             pybind11::call_guard<pybind11::gil_scoped_release>())
+        .def("getStateInequalityConstraintValueBatch",
+             &ControllerPythonInterface::getStateInequalityConstraintValueBatch,
+             "name"_a, "ts"_a, "xs"_a, "num_threads"_a,
+             pybind11::call_guard<pybind11::gil_scoped_release>())
+        .def("getSoftStateInequalityConstraintValueBatch",
+             &ControllerPythonInterface::
+                 getSoftStateInequalityConstraintValueBatch,
+             "name"_a, "ts"_a, "xs"_a, "num_threads"_a,
+             pybind11::call_guard<pybind11::gil_scoped_release>())
+        .def("getCostValueBatch", &ControllerPythonInterface::getCostValueBatch,
+             "name"_a, "ts"_a, "xs"_a, "us"_a, "num_threads"_a,
+             pybind11::call_guard<pybind11::gil_scoped_release>())
         .def("visualizeTrajectory",
              &ControllerPythonInterface::visualizeTrajectory, "t"_a.noconvert(),
              "x"_a.noconvert(), "u"_a.noconvert(), "speed"_a);
+
+    /* bind the batch rollout engine for parallel scenario sweeps */
+    pybind11::class_<BatchRolloutResult>(m, "BatchRolloutResult")
+        .def_readonly("ts", &BatchRolloutResult::ts)
+        .def_readonly("xs", &BatchRolloutResult::xs)
+        .def_readonly("us", &BatchRolloutResult::us);
+
+    pybind11::class_<BatchRollout>(m, "BatchRollout")
+        .def(pybind11::init<const ControllerSettings &, size_t>(), "settings"_a,
+             "num_instances"_a)
+        .def("getNumInstances", &BatchRollout::getNumInstances)
+        .def("rollout", &BatchRollout::rollout, "x0s"_a, "targets"_a,
+             "duration"_a, "timestep"_a,
+             pybind11::call_guard<pybind11::gil_scoped_release>());
 }
@@ -0,0 +1,56 @@
+// NOTE: pinocchio needs to be included before other things to prevent the
+// compiler fussing
+#include <pinocchio/algorithm/frames.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
+
+#include "upright_control/rigid_body_state_kinematics.h"
+
+#include <stdexcept>
+
+namespace upright {
+
+RigidBodyStateKinematicsCppAd::RigidBodyStateKinematicsCppAd(
+    const ocs2::PinocchioInterface& pinocchio_interface,
+    const std::string& frame_name, const OptimizationDimensions& dims)
+    : pinocchio_interface_cppad_(pinocchio_interface.toCppAd()),
+      mapping_(dims) {
+    const auto& model = pinocchio_interface_cppad_.getModel();
+    frame_id_ = model.getFrameId(frame_name);
+    if (frame_id_ == model.frames.size()) {
+        throw std::runtime_error("Robot model has no frame named " +
+                                 frame_name + ".");
+    }
+}
+
+RigidBodyState<ocs2::ad_scalar_t>
+RigidBodyStateKinematicsCppAd::getRigidBodyStateCppAd(
+    const VecXad& state, const VecXad& input) const {
+    const auto& model = pinocchio_interface_cppad_.getModel();
+    auto& data = pinocchio_interface_cppad_.getData();
+
+    const VecXad q = mapping_.getPinocchioJointPosition(state);
+    const VecXad v = mapping_.getPinocchioJointVelocity(state, input);
+    const VecXad a = mapping_.getPinocchioJointAcceleration(state, input);
+
+    // A single forward pass computes positions, velocities, and
+    // accelerations for the whole chain.
+    pinocchio::forwardKinematics(model, data, q, v, a);
+    pinocchio::updateFramePlacements(model, data);
+
+    RigidBodyState<ocs2::ad_scalar_t> X;
+    X.pose.position = data.oMf[frame_id_].translation();
+    X.pose.orientation = data.oMf[frame_id_].rotation();
+
+    const auto velocity = pinocchio::getFrameVelocity(
+        model, data, frame_id_, pinocchio::LOCAL_WORLD_ALIGNED);
+    X.velocity.linear = velocity.linear();
+    X.velocity.angular = velocity.angular();
+
+    const auto acceleration = pinocchio::getFrameClassicalAcceleration(
+        model, data, frame_id_, pinocchio::LOCAL_WORLD_ALIGNED);
+    X.acceleration.linear = acceleration.linear();
+    X.acceleration.angular = acceleration.angular();
+    return X;
+}
+
+}  // namespace upright
@@ -0,0 +1,817 @@
+// NOTE: pinocchio needs to be included before other things to prevent the
+// compiler fussing
+#include <pinocchio/algorithm/frames.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
+
+#include "upright_control/settings_snapshot.h"
+
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include <upright_control/util.h>
+
+namespace upright {
+namespace {
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x55505254;  // "UPRT"
+constexpr uint32_t TARGET_BANK_MAGIC = 0x5550424B;  // "UPBK"
+
+// Serializes primitive values to a flat binary stream. The format is not
+// portable across machines (native endianness and scalar widths), which is
+// fine: the snapshot is a local cache, not an interchange format.
+class SnapshotWriter {
+   public:
+    explicit SnapshotWriter(const std::string& path)
+        : out_(path, std::ios::binary) {
+        if (!out_.good()) {
+            throw std::runtime_error("Failed to open " + path +
+                                     " for writing.");
+        }
+    }
+
+    void put_bytes(const void* data, size_t size) {
+        out_.write(static_cast<const char*>(data), size);
+    }
+
+    void put_u32(uint32_t x) { put_bytes(&x, sizeof(x)); }
+
+    void put_u64(uint64_t x) { put_bytes(&x, sizeof(x)); }
+
+    void put_bool(bool b) { put_u64(b ? 1 : 0); }
+
+    void put_scalar(ocs2::scalar_t x) { put_bytes(&x, sizeof(x)); }
+
+    void put_string(const std::string& s) {
+        put_u64(s.size());
+        put_bytes(s.data(), s.size());
+    }
+
+    void put_vec(const VecXd& v) {
+        put_u64(v.size());
+        put_bytes(v.data(), v.size() * sizeof(ocs2::scalar_t));
+    }
+
+    void put_mat(const MatXd& m) {
+        put_u64(m.rows());
+        put_u64(m.cols());
+        put_bytes(m.data(), m.size() * sizeof(ocs2::scalar_t));
+    }
+
+    void close() {
+        out_.close();
+        if (!out_.good()) {
+            throw std::runtime_error("Failed to write settings snapshot.");
+        }
+    }
+
+   private:
+    std::ofstream out_;
+};
+
+class SnapshotReader {
+   public:
+    explicit SnapshotReader(const std::string& path)
+        : in_(path, std::ios::binary) {
+        if (!in_.good()) {
+            throw std::runtime_error("Failed to open settings snapshot " +
+                                     path + ".");
+        }
+    }
+
+    void get_bytes(void* data, size_t size) {
+        in_.read(static_cast<char*>(data), size);
+        if (!in_.good()) {
+            throw std::runtime_error(
+                "Settings snapshot is truncated or corrupt.");
+        }
+    }
+
+    uint32_t get_u32() {
+        uint32_t x;
+        get_bytes(&x, sizeof(x));
+        return x;
+    }
+
+    uint64_t get_u64() {
+        uint64_t x;
+        get_bytes(&x, sizeof(x));
+        return x;
+    }
+
+    bool get_bool() { return get_u64() != 0; }
+
+    ocs2::scalar_t get_scalar() {
+        ocs2::scalar_t x;
+        get_bytes(&x, sizeof(x));
+        return x;
+    }
+
+    std::string get_string() {
+        std::string s(get_u64(), '\0');
+        get_bytes(&s[0], s.size());
+        return s;
+    }
+
+    VecXd get_vec() {
+        VecXd v(get_u64());
+        get_bytes(v.data(), v.size() * sizeof(ocs2::scalar_t));
+        return v;
+    }
+
+    MatXd get_mat() {
+        const uint64_t rows = get_u64();
+        const uint64_t cols = get_u64();
+        MatXd m(rows, cols);
+        get_bytes(m.data(), m.size() * sizeof(ocs2::scalar_t));
+        return m;
+    }
+
+   private:
+    std::ifstream in_;
+};
+
+// The save/load routines below must serialize and deserialize exactly the
+// same fields in exactly the same order. When changing them, keep both sides
+// in sync and bump SETTINGS_SNAPSHOT_VERSION.
+
+void put_settings(SnapshotWriter& w, const ControllerSettings& s) {
+    w.put_vec(s.initial_state);
+    w.put_vec(VecXd(s.gravity));
+    w.put_vec(s.xd);
+    w.put_bool(s.recompile_libraries);
+    w.put_bool(s.use_library_cache);
+    w.put_bool(s.use_warm_start_store);
+    w.put_string(s.warm_start_folder);
+    w.put_bool(s.debug);
+    w.put_bool(s.realtime_iteration);
+    w.put_u64(static_cast<uint64_t>(s.realtime_iteration_budget));
+    w.put_u64(static_cast<uint64_t>(s.solver_method));
+
+    // MPC settings
+    w.put_scalar(s.mpc.timeHorizon_);
+    w.put_bool(s.mpc.debugPrint_);
+    w.put_bool(s.mpc.coldStart_);
+
+    // SQP settings
+    w.put_scalar(s.sqp.dt);
+    w.put_u64(s.sqp.sqpIteration);
+    w.put_u64(s.sqp.initSqpIteration);
+    w.put_scalar(s.sqp.deltaTol);
+    w.put_scalar(s.sqp.costTol);
+    w.put_bool(s.sqp.useFeedbackPolicy);
+    w.put_bool(s.sqp.projectStateInputEqualityConstraints);
+    w.put_bool(s.sqp.printSolverStatus);
+    w.put_bool(s.sqp.printSolverStatistics);
+    w.put_bool(s.sqp.printLinesearch);
+    w.put_u64(s.sqp.nThreads);
+    w.put_u64(s.sqp.threadPriority);
+    w.put_bool(s.sqp.hpipmSettings.warm_start);
+    w.put_u64(s.sqp.hpipmSettings.iter_max);
+    w.put_bool(s.sqp.hpipmSettings.slacks.enabled);
+    w.put_scalar(s.sqp.hpipmSettings.slacks.upper_L2_penalty);
+    w.put_scalar(s.sqp.hpipmSettings.slacks.lower_L2_penalty);
+    w.put_scalar(s.sqp.hpipmSettings.slacks.upper_L1_penalty);
+    w.put_scalar(s.sqp.hpipmSettings.slacks.lower_L1_penalty);
+    w.put_scalar(s.sqp.hpipmSettings.slacks.upper_low_bound);
+    w.put_scalar(s.sqp.hpipmSettings.slacks.lower_low_bound);
+
+    // Rollout settings
+    w.put_scalar(s.rollout.absTolODE);
+    w.put_scalar(s.rollout.relTolODE);
+    w.put_scalar(s.rollout.timeStep);
+    w.put_u64(s.rollout.maxNumStepsPerSecond);
+    w.put_bool(s.rollout.checkNumericalStability);
+
+    // Tracking settings
+    w.put_scalar(s.tracking.rate);
+    w.put_scalar(s.tracking.min_policy_update_time);
+    w.put_scalar(s.tracking.kp);
+    w.put_scalar(s.tracking.kv);
+    w.put_scalar(s.tracking.ka);
+    w.put_bool(s.tracking.enforce_state_limits);
+    w.put_bool(s.tracking.enforce_input_limits);
+    w.put_bool(s.tracking.enforce_ee_position_limits);
+    w.put_bool(s.tracking.use_projectile);
+    w.put_scalar(s.tracking.state_violation_margin);
+    w.put_scalar(s.tracking.input_violation_margin);
+    w.put_scalar(s.tracking.ee_position_violation_margin);
+    w.put_bool(s.tracking.realtime_strict);
+    w.put_bool(s.tracking.use_steady_state_gain);
+    w.put_scalar(s.tracking.steady_state_dt_tolerance);
+    w.put_bool(s.tracking.use_shm_transport);
+    w.put_u64(static_cast<uint64_t>(s.tracking.realtime.control_priority));
+    w.put_u64(static_cast<uint64_t>(s.tracking.realtime.mpc_priority));
+    w.put_u64(s.tracking.realtime.control_cpus.size());
+    for (int cpu : s.tracking.realtime.control_cpus) {
+        w.put_u64(static_cast<uint64_t>(cpu));
+    }
+    w.put_u64(s.tracking.realtime.mpc_cpus.size());
+    for (int cpu : s.tracking.realtime.mpc_cpus) {
+        w.put_u64(static_cast<uint64_t>(cpu));
+    }
+    w.put_bool(s.tracking.realtime.lock_memory);
+
+    // Estimation settings
+    w.put_scalar(s.estimation.robot_init_variance);
+    w.put_scalar(s.estimation.robot_process_variance);
+    w.put_scalar(s.estimation.robot_measurement_variance);
+
+    // Weights
+    w.put_mat(s.input_weight);
+    w.put_mat(s.state_weight);
+    w.put_mat(s.end_effector_weight);
+    w.put_bool(s.use_full_hessian_end_effector_cost);
+
+    // State and input limits
+    w.put_u64(static_cast<uint64_t>(s.limit_constraint_type));
+    w.put_vec(s.input_limit_lower);
+    w.put_vec(s.input_limit_upper);
+    w.put_scalar(s.input_limit_mu);
+    w.put_scalar(s.input_limit_delta);
+    w.put_vec(s.state_limit_lower);
+    w.put_vec(s.state_limit_upper);
+    w.put_scalar(s.state_limit_mu);
+    w.put_scalar(s.state_limit_delta);
+
+    // End effector box constraint
+    w.put_bool(s.end_effector_box_constraint_enabled);
+    w.put_vec(s.xyz_lower);
+    w.put_vec(s.xyz_upper);
+
+    // Projectile path constraint (fields beyond the flag are only
+    // initialized when the constraint is configured)
+    w.put_bool(s.projectile_path_constraint_enabled);
+    if (s.projectile_path_constraint_enabled) {
+        w.put_vec(s.projectile_path_distances);
+        w.put_scalar(s.projectile_path_scale);
+        w.put_u64(s.projectile_path_collision_links.size());
+        for (const auto& link : s.projectile_path_collision_links) {
+            w.put_string(link);
+        }
+        w.put_bool(s.projectile_path_node_schedule.enabled);
+        w.put_scalar(s.projectile_path_node_schedule.dense_horizon);
+        w.put_u64(s.projectile_path_node_schedule.stride);
+    }
+
+    // Balancing node schedule
+    w.put_bool(s.balancing_node_schedule.enabled);
+    w.put_scalar(s.balancing_node_schedule.dense_horizon);
+    w.put_u64(s.balancing_node_schedule.stride);
+
+    // Operating points
+    w.put_bool(s.use_operating_points);
+    w.put_u64(s.operating_times.size());
+    for (size_t i = 0; i < s.operating_times.size(); ++i) {
+        w.put_scalar(s.operating_times[i]);
+        w.put_vec(s.operating_states[i]);
+        w.put_vec(s.operating_inputs[i]);
+    }
+
+    // Robot settings
+    w.put_string(s.robot_urdf_path);
+    w.put_string(s.lib_folder);
+    w.put_u64(static_cast<uint64_t>(s.robot_base_type));
+    w.put_string(s.end_effector_link_name);
+    w.put_vec(VecXd(s.base_pose));
+    w.put_u64(s.locked_joints.size());
+    for (const auto& kv : s.locked_joints) {
+        w.put_string(kv.first);
+        w.put_scalar(kv.second);
+    }
+
+    // Dimensions
+    w.put_u64(s.dims.robot.q);
+    w.put_u64(s.dims.robot.v);
+    w.put_u64(s.dims.robot.x);
+    w.put_u64(s.dims.robot.u);
+    w.put_u64(s.dims.o);
+    w.put_u64(s.dims.c);
+    w.put_u64(s.dims.nf);
+
+    // Balancing settings. Objects round-trip through their parameter
+    // vectors, the same mechanism used to cast them for auto-diff.
+    w.put_bool(s.balancing_settings.enabled);
+    w.put_string(s.balancing_settings.arrangement_name);
+    w.put_bool(s.balancing_settings.constraints_enabled.normal);
+    w.put_bool(s.balancing_settings.constraints_enabled.friction);
+    w.put_bool(s.balancing_settings.constraints_enabled.zmp);
+    w.put_u64(s.balancing_settings.objects.size());
+    for (const auto& kv : s.balancing_settings.objects) {
+        w.put_string(kv.first);
+        w.put_vec(kv.second.get_parameters());
+    }
+    w.put_bool(s.balancing_settings.use_force_constraints);
+    w.put_u64(s.balancing_settings.contacts.size());
+    for (const auto& contact : s.balancing_settings.contacts) {
+        w.put_string(contact.object1_name);
+        w.put_string(contact.object2_name);
+        w.put_scalar(contact.mu);
+        w.put_vec(VecXd(contact.r_co_o1));
+        w.put_vec(VecXd(contact.r_co_o2));
+        w.put_vec(VecXd(contact.normal));
+        w.put_mat(MatXd(contact.span));
+    }
+    w.put_scalar(s.balancing_settings.force_weight);
+    w.put_u64(static_cast<uint64_t>(s.balancing_settings.friction_model));
+    w.put_u64(static_cast<uint64_t>(s.balancing_settings.constraint_type));
+    w.put_scalar(s.balancing_settings.mu);
+    w.put_scalar(s.balancing_settings.delta);
+
+    // Inertial alignment settings
+    w.put_bool(s.inertial_alignment_settings.cost_enabled);
+    w.put_bool(s.inertial_alignment_settings.constraint_enabled);
+    w.put_bool(s.inertial_alignment_settings.use_angular_acceleration);
+    w.put_bool(s.inertial_alignment_settings.align_with_fixed_vector);
+    w.put_scalar(s.inertial_alignment_settings.alpha);
+    w.put_scalar(s.inertial_alignment_settings.cost_weight);
+    w.put_vec(VecXd(s.inertial_alignment_settings.contact_plane_normal));
+    w.put_mat(MatXd(s.inertial_alignment_settings.contact_plane_span));
+    w.put_vec(VecXd(s.inertial_alignment_settings.com));
+
+    // Obstacle settings
+    w.put_bool(s.obstacle_settings.enabled);
+    w.put_u64(s.obstacle_settings.collision_link_pairs.size());
+    for (const auto& pair : s.obstacle_settings.collision_link_pairs) {
+        w.put_string(pair.first);
+        w.put_string(pair.second);
+    }
+    w.put_scalar(s.obstacle_settings.minimum_distance);
+    w.put_u64(static_cast<uint64_t>(s.obstacle_settings.constraint_type));
+    w.put_scalar(s.obstacle_settings.mu);
+    w.put_scalar(s.obstacle_settings.delta);
+    w.put_bool(s.obstacle_settings.use_broadphase);
+    w.put_scalar(s.obstacle_settings.broadphase_velocity_bound);
+    w.put_scalar(s.obstacle_settings.broadphase_safety_margin);
+    w.put_bool(s.obstacle_settings.node_schedule.enabled);
+    w.put_scalar(s.obstacle_settings.node_schedule.dense_horizon);
+    w.put_u64(s.obstacle_settings.node_schedule.stride);
+    w.put_string(s.obstacle_settings.obstacle_urdf_path);
+    w.put_u64(s.obstacle_settings.dynamic_obstacles.size());
+    for (const auto& obstacle : s.obstacle_settings.dynamic_obstacles) {
+        w.put_string(obstacle.name);
+        w.put_scalar(obstacle.radius);
+        w.put_u64(obstacle.modes.size());
+        for (const auto& mode : obstacle.modes) {
+            w.put_scalar(mode.time);
+            w.put_vec(VecXd(mode.position));
+            w.put_vec(VecXd(mode.velocity));
+            w.put_vec(VecXd(mode.acceleration));
+        }
+    }
+    w.put_u64(s.obstacle_settings.extra_spheres.size());
+    for (const auto& sphere : s.obstacle_settings.extra_spheres) {
+        w.put_string(sphere.name);
+        w.put_string(sphere.parent_frame_name);
+        w.put_vec(VecXd(sphere.offset));
+        w.put_scalar(sphere.radius);
+    }
+}
+
+ControllerSettings get_settings(SnapshotReader& r) {
+    ControllerSettings s;
+    s.initial_state = r.get_vec();
+    s.gravity = r.get_vec();
+    s.xd = r.get_vec();
+    s.recompile_libraries = r.get_bool();
+    s.use_library_cache = r.get_bool();
+    s.use_warm_start_store = r.get_bool();
+    s.warm_start_folder = r.get_string();
+    s.debug = r.get_bool();
+    s.realtime_iteration = r.get_bool();
+    s.realtime_iteration_budget = static_cast<int>(r.get_u64());
+    s.solver_method =
+        static_cast<ControllerSettings::SolverMethod>(r.get_u64());
+
+    // MPC settings
+    s.mpc.timeHorizon_ = r.get_scalar();
+    s.mpc.debugPrint_ = r.get_bool();
+    s.mpc.coldStart_ = r.get_bool();
+
+    // SQP settings
+    s.sqp.dt = r.get_scalar();
+    s.sqp.sqpIteration = r.get_u64();
+    s.sqp.initSqpIteration = r.get_u64();
+    s.sqp.deltaTol = r.get_scalar();
+    s.sqp.costTol = r.get_scalar();
+    s.sqp.useFeedbackPolicy = r.get_bool();
+    s.sqp.projectStateInputEqualityConstraints = r.get_bool();
+    s.sqp.printSolverStatus = r.get_bool();
+    s.sqp.printSolverStatistics = r.get_bool();
+    s.sqp.printLinesearch = r.get_bool();
+    s.sqp.nThreads = r.get_u64();
+    s.sqp.threadPriority = static_cast<int>(r.get_u64());
+    s.sqp.hpipmSettings.warm_start = r.get_bool();
+    s.sqp.hpipmSettings.iter_max = r.get_u64();
+    s.sqp.hpipmSettings.slacks.enabled = r.get_bool();
+    s.sqp.hpipmSettings.slacks.upper_L2_penalty = r.get_scalar();
+    s.sqp.hpipmSettings.slacks.lower_L2_penalty = r.get_scalar();
+    s.sqp.hpipmSettings.slacks.upper_L1_penalty = r.get_scalar();
+    s.sqp.hpipmSettings.slacks.lower_L1_penalty = r.get_scalar();
+    s.sqp.hpipmSettings.slacks.upper_low_bound = r.get_scalar();
+    s.sqp.hpipmSettings.slacks.lower_low_bound = r.get_scalar();
+
+    // Rollout settings
+    s.rollout.absTolODE = r.get_scalar();
+    s.rollout.relTolODE = r.get_scalar();
+    s.rollout.timeStep = r.get_scalar();
+    s.rollout.maxNumStepsPerSecond = r.get_u64();
+    s.rollout.checkNumericalStability = r.get_bool();
+
+    // Tracking settings
+    s.tracking.rate = r.get_scalar();
+    s.tracking.min_policy_update_time = r.get_scalar();
+    s.tracking.kp = r.get_scalar();
+    s.tracking.kv = r.get_scalar();
+    s.tracking.ka = r.get_scalar();
+    s.tracking.enforce_state_limits = r.get_bool();
+    s.tracking.enforce_input_limits = r.get_bool();
+    s.tracking.enforce_ee_position_limits = r.get_bool();
+    s.tracking.use_projectile = r.get_bool();
+    s.tracking.state_violation_margin = r.get_scalar();
+    s.tracking.input_violation_margin = r.get_scalar();
+    s.tracking.ee_position_violation_margin = r.get_scalar();
+    s.tracking.realtime_strict = r.get_bool();
+    s.tracking.use_steady_state_gain = r.get_bool();
+    s.tracking.steady_state_dt_tolerance = r.get_scalar();
+    s.tracking.use_shm_transport = r.get_bool();
+    s.tracking.realtime.control_priority = static_cast<int>(r.get_u64());
+    s.tracking.realtime.mpc_priority = static_cast<int>(r.get_u64());
+    s.tracking.realtime.control_cpus.resize(r.get_u64());
+    for (int& cpu : s.tracking.realtime.control_cpus) {
+        cpu = static_cast<int>(r.get_u64());
+    }
+    s.tracking.realtime.mpc_cpus.resize(r.get_u64());
+    for (int& cpu : s.tracking.realtime.mpc_cpus) {
+        cpu = static_cast<int>(r.get_u64());
+    }
+    s.tracking.realtime.lock_memory = r.get_bool();
+
+    // Estimation settings
+    s.estimation.robot_init_variance = r.get_scalar();
+    s.estimation.robot_process_variance = r.get_scalar();
+    s.estimation.robot_measurement_variance = r.get_scalar();
+
+    // Weights
+    s.input_weight = r.get_mat();
+    s.state_weight = r.get_mat();
+    s.end_effector_weight = r.get_mat();
+    s.use_full_hessian_end_effector_cost = r.get_bool();
+
+    // State and input limits
+    s.limit_constraint_type = static_cast<ConstraintType>(r.get_u64());
+    s.input_limit_lower = r.get_vec();
+    s.input_limit_upper = r.get_vec();
+    s.input_limit_mu = r.get_scalar();
+    s.input_limit_delta = r.get_scalar();
+    s.state_limit_lower = r.get_vec();
+    s.state_limit_upper = r.get_vec();
+    s.state_limit_mu = r.get_scalar();
+    s.state_limit_delta = r.get_scalar();
+
+    // End effector box constraint
+    s.end_effector_box_constraint_enabled = r.get_bool();
+    s.xyz_lower = r.get_vec();
+    s.xyz_upper = r.get_vec();
+
+    // Projectile path constraint
+    s.projectile_path_constraint_enabled = r.get_bool();
+    if (s.projectile_path_constraint_enabled) {
+        s.projectile_path_distances = r.get_vec();
+        s.projectile_path_scale = r.get_scalar();
+        const uint64_t num_links = r.get_u64();
+        for (uint64_t i = 0; i < num_links; ++i) {
+            s.projectile_path_collision_links.push_back(r.get_string());
+        }
+        s.projectile_path_node_schedule.enabled = r.get_bool();
+        s.projectile_path_node_schedule.dense_horizon = r.get_scalar();
+        s.projectile_path_node_schedule.stride = r.get_u64();
+    }
+
+    // Balancing node schedule
+    s.balancing_node_schedule.enabled = r.get_bool();
+    s.balancing_node_schedule.dense_horizon = r.get_scalar();
+    s.balancing_node_schedule.stride = r.get_u64();
+
+    // Operating points
+    s.use_operating_points = r.get_bool();
+    const uint64_t num_operating_points = r.get_u64();
+    for (uint64_t i = 0; i < num_operating_points; ++i) {
+        s.operating_times.push_back(r.get_scalar());
+        s.operating_states.push_back(r.get_vec());
+        s.operating_inputs.push_back(r.get_vec());
+    }
+
+    // Robot settings
+    s.robot_urdf_path = r.get_string();
+    s.lib_folder = r.get_string();
+    s.robot_base_type = static_cast<RobotBaseType>(r.get_u64());
+    s.end_effector_link_name = r.get_string();
+    s.base_pose = r.get_vec();
+    const uint64_t num_locked_joints = r.get_u64();
+    for (uint64_t i = 0; i < num_locked_joints; ++i) {
+        const std::string name = r.get_string();
+        s.locked_joints[name] = r.get_scalar();
+    }
+
+    // Dimensions
+    s.dims.robot.q = r.get_u64();
+    s.dims.robot.v = r.get_u64();
+    s.dims.robot.x = r.get_u64();
+    s.dims.robot.u = r.get_u64();
+    s.dims.o = r.get_u64();
+    s.dims.c = r.get_u64();
+    s.dims.nf = r.get_u64();
+
+    // Balancing settings
+    s.balancing_settings.enabled = r.get_bool();
+    s.balancing_settings.arrangement_name = r.get_string();
+    s.balancing_settings.constraints_enabled.normal = r.get_bool();
+    s.balancing_settings.constraints_enabled.friction = r.get_bool();
+    s.balancing_settings.constraints_enabled.zmp = r.get_bool();
+    const uint64_t num_objects = r.get_u64();
+    for (uint64_t i = 0; i < num_objects; ++i) {
+        const std::string name = r.get_string();
+        s.balancing_settings.objects.emplace(
+            name, BalancedObject<ocs2::scalar_t>::from_parameters(r.get_vec()));
+    }
+    s.balancing_settings.use_force_constraints = r.get_bool();
+    const uint64_t num_contacts = r.get_u64();
+    for (uint64_t i = 0; i < num_contacts; ++i) {
+        ContactPoint<ocs2::scalar_t> contact;
+        contact.object1_name = r.get_string();
+        contact.object2_name = r.get_string();
+        contact.mu = r.get_scalar();
+        contact.r_co_o1 = r.get_vec();
+        contact.r_co_o2 = r.get_vec();
+        contact.normal = r.get_vec();
+        contact.span = r.get_mat();
+        s.balancing_settings.contacts.push_back(contact);
+    }
+    s.balancing_settings.force_weight = r.get_scalar();
+    s.balancing_settings.friction_model =
+        static_cast<FrictionModel>(r.get_u64());
+    s.balancing_settings.constraint_type =
+        static_cast<ConstraintType>(r.get_u64());
+    s.balancing_settings.mu = r.get_scalar();
+    s.balancing_settings.delta = r.get_scalar();
+
+    // Inertial alignment settings
+    s.inertial_alignment_settings.cost_enabled = r.get_bool();
+    s.inertial_alignment_settings.constraint_enabled = r.get_bool();
+    s.inertial_alignment_settings.use_angular_acceleration = r.get_bool();
+    s.inertial_alignment_settings.align_with_fixed_vector = r.get_bool();
+    s.inertial_alignment_settings.alpha = r.get_scalar();
+    s.inertial_alignment_settings.cost_weight = r.get_scalar();
+    s.inertial_alignment_settings.contact_plane_normal = r.get_vec();
+    s.inertial_alignment_settings.contact_plane_span = r.get_mat();
+    s.inertial_alignment_settings.com = r.get_vec();
+
+    // Obstacle settings
+    s.obstacle_settings.enabled = r.get_bool();
+    const uint64_t num_pairs = r.get_u64();
+    for (uint64_t i = 0; i < num_pairs; ++i) {
+        const std::string first = r.get_string();
+        const std::string second = r.get_string();
+        s.obstacle_settings.collision_link_pairs.emplace_back(first, second);
+    }
+    s.obstacle_settings.minimum_distance = r.get_scalar();
+    s.obstacle_settings.constraint_type =
+        static_cast<ConstraintType>(r.get_u64());
+    s.obstacle_settings.mu = r.get_scalar();
+    s.obstacle_settings.delta = r.get_scalar();
+    s.obstacle_settings.use_broadphase = r.get_bool();
+    s.obstacle_settings.broadphase_velocity_bound = r.get_scalar();
+    s.obstacle_settings.broadphase_safety_margin = r.get_scalar();
+    s.obstacle_settings.node_schedule.enabled = r.get_bool();
+    s.obstacle_settings.node_schedule.dense_horizon = r.get_scalar();
+    s.obstacle_settings.node_schedule.stride = r.get_u64();
+    s.obstacle_settings.obstacle_urdf_path = r.get_string();
+    const uint64_t num_obstacles = r.get_u64();
+    for (uint64_t i = 0; i < num_obstacles; ++i) {
+        DynamicObstacle obstacle;
+        obstacle.name = r.get_string();
+        obstacle.radius = r.get_scalar();
+        const uint64_t num_modes = r.get_u64();
+        for (uint64_t j = 0; j < num_modes; ++j) {
+            DynamicObstacleMode mode;
+            mode.time = r.get_scalar();
+            mode.position = r.get_vec();
+            mode.velocity = r.get_vec();
+            mode.acceleration = r.get_vec();
+            obstacle.modes.push_back(mode);
+        }
+        s.obstacle_settings.dynamic_obstacles.push_back(obstacle);
+    }
+    const uint64_t num_spheres = r.get_u64();
+    for (uint64_t i = 0; i < num_spheres; ++i) {
+        CollisionSphere<ocs2::scalar_t> sphere;
+        sphere.name = r.get_string();
+        sphere.parent_frame_name = r.get_string();
+        sphere.offset = r.get_vec();
+        sphere.radius = r.get_scalar();
+        s.obstacle_settings.extra_spheres.push_back(sphere);
+    }
+
+    return s;
+}
+
+void put_waypoints(SnapshotWriter& w,
+                   const std::vector<PoseWaypoint>& waypoints) {
+    w.put_u64(waypoints.size());
+    for (const auto& waypoint : waypoints) {
+        w.put_scalar(waypoint.time);
+        w.put_vec(VecXd(waypoint.position));
+        w.put_vec(VecXd(waypoint.orientation.coeffs()));
+    }
+}
+
+std::vector<PoseWaypoint> get_waypoints(SnapshotReader& r) {
+    std::vector<PoseWaypoint> waypoints;
+    const uint64_t num_waypoints = r.get_u64();
+    for (uint64_t i = 0; i < num_waypoints; ++i) {
+        PoseWaypoint waypoint;
+        waypoint.time = r.get_scalar();
+        waypoint.position = r.get_vec();
+        const VecXd quat = r.get_vec();
+        waypoint.orientation = Quatd(quat(3), quat(0), quat(1), quat(2));
+        waypoints.push_back(waypoint);
+    }
+    return waypoints;
+}
+
+}  // namespace
+
+std::string settings_snapshot_path(const std::string& config_path) {
+    return config_path + ".snapshot";
+}
+
+std::string settings_snapshot_deps_path(const std::string& snapshot_path) {
+    return snapshot_path + ".deps";
+}
+
+void save_settings_snapshot_deps(const std::string& snapshot_path,
+                                 const std::vector<std::string>& files) {
+    const std::string path = settings_snapshot_deps_path(snapshot_path);
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path);
+        for (const auto& file : files) {
+            out << file << "\n";
+        }
+    }
+    boost::filesystem::rename(tmp_path, path);
+}
+
+bool settings_snapshot_fresh(const std::string& snapshot_path,
+                             const std::string& config_path) {
+    namespace fs = boost::filesystem;
+    if (!fs::exists(snapshot_path) || !fs::exists(config_path)) {
+        return false;
+    }
+    const std::time_t snapshot_time = fs::last_write_time(snapshot_path);
+    if (snapshot_time < fs::last_write_time(config_path)) {
+        return false;
+    }
+
+    // The configuration is assembled from a chain of included files, so the
+    // snapshot is only fresh if it is at least as new as every file in the
+    // closure recorded when it was written. A missing dependency list means
+    // the closure is unknown: force regeneration.
+    const std::string deps_path = settings_snapshot_deps_path(snapshot_path);
+    if (!fs::exists(deps_path)) {
+        return false;
+    }
+    std::ifstream deps(deps_path);
+    std::string dep;
+    while (std::getline(deps, dep)) {
+        if (dep.empty()) {
+            continue;
+        }
+        if (!fs::exists(dep) || snapshot_time < fs::last_write_time(dep)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void save_settings_snapshot(const std::string& path,
+                            const SettingsSnapshot& snapshot) {
+    const std::string tmp_path = path + ".tmp";
+    {
+        SnapshotWriter w(tmp_path);
+        w.put_u32(SNAPSHOT_MAGIC);
+        w.put_u32(SETTINGS_SNAPSHOT_VERSION);
+        put_settings(w, snapshot.settings);
+        put_waypoints(w, snapshot.target_waypoints);
+        w.close();
+    }
+    boost::filesystem::rename(tmp_path, path);
+}
+
+SettingsSnapshot load_settings_snapshot(const std::string& path) {
+    SnapshotReader r(path);
+    if (r.get_u32() != SNAPSHOT_MAGIC) {
+        throw std::runtime_error(path + " is not a settings snapshot.");
+    }
+    const uint32_t version = r.get_u32();
+    if (version != SETTINGS_SNAPSHOT_VERSION) {
+        throw std::runtime_error(
+            "Settings snapshot " + path + " has version " +
+            std::to_string(version) + " but version " +
+            std::to_string(SETTINGS_SNAPSHOT_VERSION) +
+            " is required; delete it and regenerate.");
+    }
+
+    SettingsSnapshot snapshot;
+    snapshot.settings = get_settings(r);
+    snapshot.target_waypoints = get_waypoints(r);
+    return snapshot;
+}
+
+void save_target_bank(const std::string& path, const TargetBank& bank) {
+    const std::string tmp_path = path + ".tmp";
+    {
+        SnapshotWriter w(tmp_path);
+        w.put_u32(TARGET_BANK_MAGIC);
+        w.put_u32(TARGET_BANK_VERSION);
+        w.put_u64(bank.entries.size());
+        for (const auto& entry : bank.entries) {
+            w.put_string(entry.first);
+            put_waypoints(w, entry.second);
+        }
+        w.close();
+    }
+    boost::filesystem::rename(tmp_path, path);
+}
+
+TargetBank load_target_bank(const std::string& path) {
+    SnapshotReader r(path);
+    if (r.get_u32() != TARGET_BANK_MAGIC) {
+        throw std::runtime_error(path + " is not a target bank.");
+    }
+    const uint32_t version = r.get_u32();
+    if (version != TARGET_BANK_VERSION) {
+        throw std::runtime_error(
+            "Target bank " + path + " has version " +
+            std::to_string(version) + " but version " +
+            std::to_string(TARGET_BANK_VERSION) +
+            " is required; regenerate it with build_target_bank.");
+    }
+
+    TargetBank bank;
+    const uint64_t num_entries = r.get_u64();
+    for (uint64_t i = 0; i < num_entries; ++i) {
+        const std::string name = r.get_string();
+        bank.entries[name] = get_waypoints(r);
+    }
+    return bank;
+}
+
+ocs2::TargetTrajectories build_target_trajectory(
+    const std::vector<PoseWaypoint>& waypoints,
+    const ControllerSettings& settings, const VecXd& x0) {
+    // Compute the end effector pose at the initial state. A robot-only model
+    // is built here since the waypoints do not depend on the obstacle states.
+    ocs2::PinocchioInterface interface(build_pinocchio_interface(
+        settings.robot_urdf_path, settings.robot_base_type,
+        settings.locked_joints, settings.base_pose));
+    const auto& model = interface.getModel();
+    auto& data = interface.getData();
+
+    const VecXd q = x0.head(settings.dims.robot.q);
+    pinocchio::forwardKinematics(model, data, q);
+    pinocchio::updateFramePlacements(model, data);
+
+    const auto frame_id = model.getFrameId(settings.end_effector_link_name);
+    if (frame_id == model.frames.size()) {
+        throw std::runtime_error("Robot model has no frame named " +
+                                 settings.end_effector_link_name + ".");
+    }
+    const Vec3d r_ew_w = data.oMf[frame_id].translation();
+    const Quatd Q_we(data.oMf[frame_id].rotation());
+
+    ocs2::scalar_array_t times;
+    ocs2::vector_array_t states;
+    ocs2::vector_array_t inputs;
+    const VecXd u0 = VecXd::Zero(settings.dims.robot.u);
+    for (const auto& waypoint : waypoints) {
+        const Vec3d r_ew_w_d = r_ew_w + waypoint.position;
+        const Quatd Q_we_d = Q_we * waypoint.orientation;
+
+        // Last entry is an auxiliary scalar used e.g. to activate projectile
+        // avoidance.
+        VecXd state(8);
+        state << r_ew_w_d, Q_we_d.coeffs(), 0;
+
+        times.push_back(waypoint.time);
+        states.push_back(state);
+        inputs.push_back(u0);
+    }
+    return ocs2::TargetTrajectories(times, states, inputs);
+}
+
+}  // namespace upright
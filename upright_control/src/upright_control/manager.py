@@ -16,7 +16,9 @@ class ControllerModel:
 
     def __init__(self, settings):
         self.settings = settings
-        self.objects = list(settings.objects.values())
+        # settings.objects is an opaque bound map; iterate keys rather than
+        # using .values(), which older pybind11 versions do not provide
+        self.objects = [settings.objects[name] for name in settings.objects]
         self.arrangement = core.bindings.BalancedObjectArrangement(
             settings.objects, settings.gravity
         )
@@ -180,12 +182,17 @@ class ControllerManager:
         return self.x_opt, self.u_opt
 
     def get_mpc_trajectory(self):
-        """Get the full optimal trajectory found by MPC."""
-        ts = bindings.scalar_array()
-        xs = bindings.vector_array()
-        us = bindings.vector_array()
-        self.mpc.getMpcSolution(ts, xs, us)
-        return np.array(ts), np.array(xs), np.array(us)
+        """Get the full optimal trajectory found by MPC.
+
+        Returns read-only NumPy views into buffers owned by the MPC
+        interface; they are invalidated by the next call to this method, so
+        copy them if they need to outlive it.
+        """
+        self.mpc.cacheMpcSolution()
+        ts = self.mpc.getCachedTimeTrajectory()
+        xs = self.mpc.getCachedStateTrajectory()
+        us = self.mpc.getCachedInputTrajectory()
+        return ts, xs, us
 
     def plan(self, timestep, duration):
         """Construct a new plan by rolling out the MPC.
@@ -120,6 +120,17 @@ class ControllerSettings(bindings.ControllerSettings):
         self.sqp.print_solver_statistics = config["sqp"]["print_solver_statistics"]
         self.sqp.print_line_search = config["sqp"]["print_line_search"]
 
+        # Number of worker threads used to linearize the problem across the
+        # shooting nodes. The upright cost and constraint terms are all safe
+        # to clone per thread, so this can be set up to the number of
+        # physical cores; the default keeps the solver single-threaded.
+        self.sqp.n_threads = core.parsing.parse_number(
+            config["sqp"].get("n_threads", 1), dtype=int
+        )
+        self.sqp.thread_priority = core.parsing.parse_number(
+            config["sqp"].get("thread_priority", 50), dtype=int
+        )
+
         # HPIPM (QP solver) settings
         self.sqp.hpipm.warm_start = config["sqp"]["hpipm"]["warm_start"]
         self.sqp.hpipm.iter_max = config["sqp"]["hpipm"]["iter_max"]
@@ -186,6 +197,36 @@ class ControllerSettings(bindings.ControllerSettings):
             "ee_position_violation_margin"
         ]
 
+        # fail fast if the tracking loop heap-allocates in its hot sections
+        self.tracking.realtime_strict = config["tracking"].get(
+            "realtime_strict", False
+        )
+
+        # use a precomputed steady-state Kalman gain in the tracking loop
+        self.tracking.use_steady_state_gain = config["tracking"].get(
+            "use_steady_state_gain", False
+        )
+        self.tracking.steady_state_dt_tolerance = config["tracking"].get(
+            "steady_state_dt_tolerance", 0.2
+        )
+
+        # exchange observations and policies via shared memory when the MPC
+        # and tracking nodes run on the same host
+        self.tracking.use_shm_transport = config["tracking"].get(
+            "use_shm_transport", False
+        )
+
+        # real-time scheduling applied by the nodes at startup; defaults
+        # leave CFS scheduling and kernel placement untouched
+        realtime = config["tracking"].get("realtime", {})
+        self.tracking.realtime.control_priority = realtime.get(
+            "control_priority", 0
+        )
+        self.tracking.realtime.mpc_priority = realtime.get("mpc_priority", 0)
+        self.tracking.realtime.control_cpus = realtime.get("control_cpus", [])
+        self.tracking.realtime.mpc_cpus = realtime.get("mpc_cpus", [])
+        self.tracking.realtime.lock_memory = realtime.get("lock_memory", False)
+
         # gravity
         self.gravity = config["gravity"]
 
@@ -193,6 +234,20 @@ class ControllerSettings(bindings.ControllerSettings):
         # library already exists
         self.recompile_libraries = config.get("recompile_libraries", True)
 
+        # real-time iteration mode: cap every solve at a fixed SQP iteration
+        # budget for bounded, predictable solve latency
+        self.realtime_iteration = config.get("realtime_iteration", False)
+        self.realtime_iteration_budget = core.parsing.parse_number(
+            config.get("realtime_iteration_budget", 1), dtype=int
+        )
+
+        # whether to persist the solver's final trajectory on shutdown and
+        # warm start from it on the next run of the same task
+        self.use_warm_start_store = config.get("use_warm_start_store", False)
+        self.warm_start_folder = config.get(
+            "warm_start_folder", "/tmp/upright/warm_start"
+        )
+
         # debug mode prints/publishes extra information, but may reduce
         # performance
         self.debug = config["debug"]
@@ -203,6 +258,13 @@ class ControllerSettings(bindings.ControllerSettings):
         self.dims.robot.x = config["robot"]["dims"]["x"]
         self.dims.robot.u = config["robot"]["dims"]["u"]
 
+        # the nonholonomic base model reduces the velocity to a forward speed
+        # and yaw rate, so q = v + 1; all other base types use q = v
+        if self.robot_base_type == bindings.RobotBaseType.Nonholonomic:
+            assert self.dims.robot.q == self.dims.robot.v + 1
+        else:
+            assert self.dims.robot.q == self.dims.robot.v
+
         # weights for state, input, and EE pose
         self.input_weight = core.parsing.parse_diag_matrix_dict(
             config["weights"]["input"]
@@ -217,6 +279,12 @@ class ControllerSettings(bindings.ControllerSettings):
         assert self.state_weight.shape == (self.dims.robot.x, self.dims.robot.x)
         assert self.end_effector_weight.shape == (6, 6)
 
+        # generated full-Hessian EE pose cost instead of the analytical
+        # Gauss-Newton one
+        self.use_full_hessian_end_effector_cost = config["weights"].get(
+            "use_full_hessian_end_effector_cost", False
+        )
+
         # input limits
         self.limit_constraint_type = bindings.constraint_type_from_string(
             config["limits"]["constraint_type"]
@@ -268,6 +336,21 @@ class ControllerSettings(bindings.ControllerSettings):
             assert (self.projectile_path_distances >= 0).all()
             assert self.projectile_path_scale >= 0
 
+            # horizon node schedule: subsample far-horizon nodes
+            if "node_schedule" in config["projectile_path_constraint"]:
+                schedule_config = config["projectile_path_constraint"][
+                    "node_schedule"
+                ]
+                self.projectile_path_node_schedule.enabled = schedule_config.get(
+                    "enabled", False
+                )
+                self.projectile_path_node_schedule.dense_horizon = (
+                    schedule_config.get("dense_horizon", 0.5)
+                )
+                self.projectile_path_node_schedule.stride = schedule_config.get(
+                    "stride", 4
+                )
+
         # some joints in the URDF may be locked to constant values, for example
         # to only use part of the robot for an experiment
         if "locked_joints" in config["robot"]:
@@ -316,6 +399,19 @@ class ControllerSettings(bindings.ControllerSettings):
         )
 
         self.balancing_settings.force_weight = config["balancing"]["force_weight"]
+
+        # horizon node schedule for the input-dependent balancing terms:
+        # dense for the near horizon, every stride-th node beyond it
+        if "node_schedule" in config["balancing"]:
+            schedule_config = config["balancing"]["node_schedule"]
+            self.balancing_node_schedule.enabled = schedule_config.get(
+                "enabled", False
+            )
+            self.balancing_node_schedule.dense_horizon = schedule_config.get(
+                "dense_horizon", 0.5
+            )
+            self.balancing_node_schedule.stride = schedule_config.get("stride", 4)
+
         ctrl_objects, contacts = core.parsing.parse_control_objects(config)
         self.balancing_settings.objects = ctrl_objects
         self.balancing_settings.contacts = contacts
@@ -323,9 +419,22 @@ class ControllerSettings(bindings.ControllerSettings):
         if self.balancing_settings.enabled:
             self.dims.c = len(contacts)
 
+            # friction model for the contact force constraints; the legacy
+            # boolean "frictionless" key selects between the frictionless and
+            # linearized-cone models when no model is named explicitly
+            if "friction_model" in config["balancing"]:
+                friction_model = config["balancing"]["friction_model"]
+            elif config["balancing"]["frictionless"]:
+                friction_model = "frictionless"
+            else:
+                friction_model = "linearized_cone"
+            self.balancing_settings.friction_model = (
+                bindings.friction_model_from_string(friction_model)
+            )
+
             # dimension of each force variable: only one if we assume frictionless
             # contacts; three otherwise
-            self.dims.nf = 1 if config["balancing"]["frictionless"] else 3
+            self.dims.nf = 1 if friction_model == "frictionless" else 3
         else:
             # if we aren't balancing then we don't want to augment the problem
             # with extra variables
@@ -382,6 +491,30 @@ class ControllerSettings(bindings.ControllerSettings):
                 config["obstacles"]["delta"]
             )
 
+            # broadphase pruning of far-apart collision pairs
+            self.obstacle_settings.use_broadphase = config["obstacles"].get(
+                "use_broadphase", False
+            )
+            self.obstacle_settings.broadphase_velocity_bound = config[
+                "obstacles"
+            ].get("broadphase_velocity_bound", 2.0)
+            self.obstacle_settings.broadphase_safety_margin = config[
+                "obstacles"
+            ].get("broadphase_safety_margin", 0.05)
+
+            # horizon node schedule: subsample far-horizon nodes
+            if "node_schedule" in config["obstacles"]:
+                schedule_config = config["obstacles"]["node_schedule"]
+                self.obstacle_settings.node_schedule.enabled = schedule_config.get(
+                    "enabled", False
+                )
+                self.obstacle_settings.node_schedule.dense_horizon = (
+                    schedule_config.get("dense_horizon", 0.5)
+                )
+                self.obstacle_settings.node_schedule.stride = schedule_config.get(
+                    "stride", 4
+                )
+
             if "urdf" in config["obstacles"]:
                 self.obstacle_settings.obstacle_urdf_path = (
                     core.parsing.parse_and_compile_urdf(config["obstacles"]["urdf"])
@@ -0,0 +1,320 @@
+// Microbenchmarks for the templated constraint kernels in upright_core.
+// These are the innermost code of every MPC iteration once taped, so track
+// them here to catch performance regressions before they show up as MPC
+// deadline misses on the robot. See the README in this directory for how to
+// record and compare baseline JSON output.
+#include <benchmark/benchmark.h>
+
+#include <Eigen/Eigen>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "upright_core/bounded.h"
+#include "upright_core/bounded_constraints.h"
+#include "upright_core/contact.h"
+#include "upright_core/contact_constraints.h"
+#include "upright_core/dynamics.h"
+#include "upright_core/ellipsoid.h"
+#include "upright_core/nominal.h"
+#include "upright_core/support_area.h"
+#include "upright_core/types.h"
+
+#ifdef UPRIGHT_CORE_BENCH_WITH_CPPAD
+#include <cppad/example/cppad_eigen.hpp>
+#endif
+
+namespace {
+
+using namespace upright;
+
+Mat23<double> default_span() {
+    Mat23<double> span;
+    // clang-format off
+    span << 1, 0, 0,
+            0, 1, 0;
+    // clang-format on
+    return span;
+}
+
+// A bounded object with uncertain mass and a full-rank CoM ellipsoid, atop a
+// regular polygon support area with the given number of edges.
+BoundedBalancedObject<double> make_bounded_object(size_t num_edges) {
+    Ellipsoid<double> com_ellipsoid(
+        Vec3<double>(0, 0, 0.1), {0.02, 0.02, 0.02},
+        {Vec3<double>::UnitX(), Vec3<double>::UnitY(), Vec3<double>::UnitZ()});
+    BoundedRigidBody<double> body(0.9, 1.1, Vec3<double>(0.03, 0.03, 0.03),
+                                  Vec3<double>(0.05, 0.05, 0.05),
+                                  com_ellipsoid);
+    PolygonSupportArea<double> support_area(
+        regular_polygon_vertices<double>(num_edges, 0.05),
+        Vec3<double>::UnitZ(), default_span());
+    return BoundedBalancedObject<double>(body, 0.1, support_area, 0.05, 0.5);
+}
+
+BalancedObject<double> make_nominal_object() {
+    const double mass = 1.0;
+    const Vec3<double> side_lengths(0.06, 0.06, 0.2);
+    RigidBody<double> body(mass, cuboid_inertia_matrix(mass, side_lengths),
+                           Vec3<double>(0, 0, 0.1));
+    PolygonSupportArea<double> support_area(
+        regular_polygon_vertices<double>(4, 0.05), Vec3<double>::UnitZ(),
+        default_span());
+    return BalancedObject<double>(body, 0.1, support_area,
+                                  circle_r_tau(0.05), 0.5);
+}
+
+// num_contacts contact points between the EE and a single object, as
+// produced by the parser for a flat arrangement.
+std::vector<ContactPoint<double>> make_contacts(size_t num_contacts,
+                                                const std::string& object) {
+    std::vector<ContactPoint<double>> contacts;
+    for (size_t i = 0; i < num_contacts; ++i) {
+        ContactPoint<double> contact;
+        contact.object1_name = "ee";
+        contact.object2_name = object;
+        contact.mu = 0.5;
+        contact.r_co_o1 = Vec3<double>(0.05, 0.05, 0);
+        contact.r_co_o2 = Vec3<double>(0.05, 0.05, -0.1);
+        contact.normal = Vec3<double>::UnitZ();
+        contact.span = default_span();
+        contacts.push_back(contact);
+    }
+    return contacts;
+}
+
+// A representative (non-static) EE motion for evaluating the kernels.
+struct MotionFixture {
+    MotionFixture() {
+        C_we = Eigen::AngleAxisd(0.1, Vec3<double>::UnitY())
+                   .toRotationMatrix();
+        C_ew = C_we.transpose();
+        angular_vel = Vec3<double>(0.1, -0.2, 0.3);
+        linear_acc = Vec3<double>(1.0, -0.5, 0.2);
+        angular_acc = Vec3<double>(-0.3, 0.1, 0.2);
+        ddC_we = rotation_matrix_second_derivative(C_we, angular_vel,
+                                                   angular_acc);
+        gravity = Vec3<double>(0, 0, -9.81);
+    }
+
+    Mat3<double> C_we;
+    Mat3<double> C_ew;
+    Mat3<double> ddC_we;
+    Vec3<double> angular_vel;
+    Vec3<double> linear_acc;
+    Vec3<double> angular_acc;
+    Vec3<double> gravity;
+};
+
+void BM_OptimizeLinearStEllipsoid(benchmark::State& state) {
+    const BoundedBalancedObject<double> object = make_bounded_object(4);
+    const Vec3<double> a(0.1, -0.2, 1.0);
+    const double b = 0.5;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(optimize_linear_st_ellipsoid(
+            a, b, object.body.com_ellipsoid, 1e-6, OptType::Max));
+    }
+}
+BENCHMARK(BM_OptimizeLinearStEllipsoid);
+
+void BM_OptAlphaProjection(benchmark::State& state) {
+    const BoundedBalancedObject<double> object = make_bounded_object(4);
+    const MotionFixture motion;
+    const Vec3<double> p = Vec3<double>::UnitZ();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(opt_alpha_projection(
+            p, motion.ddC_we, motion.C_ew, motion.linear_acc, motion.gravity,
+            object, 1e-6, OptType::Min));
+    }
+}
+BENCHMARK(BM_OptAlphaProjection);
+
+void BM_BoundedFrictionConstraint(benchmark::State& state) {
+    const BoundedBalancedObject<double> object = make_bounded_object(4);
+    const MotionFixture motion;
+    VecX<double> out(4);
+    for (auto _ : state) {
+        bounded_friction_constraint<double>(
+            out, motion.ddC_we, motion.C_ew, motion.angular_vel,
+            motion.linear_acc, motion.angular_acc, motion.gravity, object,
+            1e-6);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(BM_BoundedFrictionConstraint);
+
+// Parameterized by the number of support polygon edges.
+void BM_BoundedZmpConstraint(benchmark::State& state) {
+    const BoundedBalancedObject<double> object =
+        make_bounded_object(state.range(0));
+    const MotionFixture motion;
+    VecX<double> out(4 * object.support_area_min.num_constraints());
+    for (auto _ : state) {
+        bounded_zmp_constraint<double>(
+            out, motion.ddC_we, motion.C_ew, motion.angular_vel,
+            motion.linear_acc, motion.angular_acc, motion.gravity, object,
+            1e-6);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(BM_BoundedZmpConstraint)->Arg(3)->Arg(4)->Arg(8);
+
+// Parameterized by the number of balanced objects.
+void BM_BoundedBalancingConstraints(benchmark::State& state) {
+    std::vector<BoundedBalancedObject<double>> objects;
+    for (int i = 0; i < state.range(0); ++i) {
+        objects.push_back(make_bounded_object(4));
+    }
+    const MotionFixture motion;
+    const BalanceConstraintsEnabled enabled;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(balancing_constraints(
+            objects, motion.gravity, enabled, motion.C_we, motion.angular_vel,
+            motion.linear_acc, motion.angular_acc));
+    }
+}
+BENCHMARK(BM_BoundedBalancingConstraints)->Arg(1)->Arg(2)->Arg(4);
+
+// Parameterized by the number of contact points.
+void BM_ContactForceConstraintsLinearized(benchmark::State& state) {
+    const size_t num_contacts = state.range(0);
+    const std::vector<ContactPoint<double>> contacts =
+        make_contacts(num_contacts, "object");
+    const VecX<double> forces =
+        VecX<double>::LinSpaced(3 * num_contacts, -1.0, 1.0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            compute_contact_force_constraints_linearized(contacts, forces));
+    }
+}
+BENCHMARK(BM_ContactForceConstraintsLinearized)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16);
+
+// Structure-of-arrays counterpart of the benchmark above.
+void BM_ContactBatchForceConstraintsLinearized(benchmark::State& state) {
+    const size_t num_contacts = state.range(0);
+    const ContactBatch<double> batch(make_contacts(num_contacts, "object"), 0);
+    const VecX<double> forces =
+        VecX<double>::LinSpaced(3 * num_contacts, -1.0, 1.0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            compute_contact_force_constraints_linearized(batch, forces));
+    }
+}
+BENCHMARK(BM_ContactBatchForceConstraintsLinearized)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16);
+
+// Parameterized by the number of objects, each with four EE contacts.
+void BM_ObjectDynamicsConstraints(benchmark::State& state) {
+    const size_t num_objects = state.range(0);
+    std::map<std::string, BalancedObject<double>> objects;
+    std::vector<ContactPoint<double>> contacts;
+    for (size_t i = 0; i < num_objects; ++i) {
+        const std::string name = "object_" + std::to_string(i);
+        objects.emplace(name, make_nominal_object());
+        const auto object_contacts = make_contacts(4, name);
+        contacts.insert(contacts.end(), object_contacts.begin(),
+                        object_contacts.end());
+    }
+    resolve_contact_object_indices(objects, contacts);
+
+    const VecX<double> forces =
+        VecX<double>::LinSpaced(3 * contacts.size(), -1.0, 1.0);
+    RigidBodyState<double> body_state = RigidBodyState<double>::Zero();
+    body_state.acceleration.linear = Vec3<double>(1.0, -0.5, 0.2);
+    const Vec3<double> gravity(0, 0, -9.81);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compute_object_dynamics_constraints(
+            objects, contacts, forces, body_state, gravity));
+    }
+}
+BENCHMARK(BM_ObjectDynamicsConstraints)->Arg(1)->Arg(2)->Arg(4);
+
+// Structure-of-arrays counterpart: per-object wrenches come from the batch's
+// precomputed wrench maps as a single matrix-vector product.
+void BM_ContactBatchObjectDynamicsConstraints(benchmark::State& state) {
+    const size_t num_objects = state.range(0);
+    std::map<std::string, BalancedObject<double>> objects;
+    std::vector<ContactPoint<double>> contacts;
+    for (size_t i = 0; i < num_objects; ++i) {
+        const std::string name = "object_" + std::to_string(i);
+        objects.emplace(name, make_nominal_object());
+        const auto object_contacts = make_contacts(4, name);
+        contacts.insert(contacts.end(), object_contacts.begin(),
+                        object_contacts.end());
+    }
+    resolve_contact_object_indices(objects, contacts);
+    const ContactBatch<double> batch(contacts, objects.size());
+
+    const VecX<double> forces =
+        VecX<double>::LinSpaced(3 * contacts.size(), -1.0, 1.0);
+    RigidBodyState<double> body_state = RigidBodyState<double>::Zero();
+    body_state.acceleration.linear = Vec3<double>(1.0, -0.5, 0.2);
+    const Vec3<double> gravity(0, 0, -9.81);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compute_object_dynamics_constraints(
+            objects, batch, forces, body_state, gravity));
+    }
+}
+BENCHMARK(BM_ContactBatchObjectDynamicsConstraints)->Arg(1)->Arg(2)->Arg(4);
+
+#ifdef UPRIGHT_CORE_BENCH_WITH_CPPAD
+
+// Taping benchmarks: measure the cost of recording the kernels onto a CppAD
+// tape, which dominates model (re)generation time in the controller. The
+// controller uses OCS2's CppAd scalar, which wraps the same CppAD taping
+// machinery benchmarked here.
+using ADScalar = CppAD::AD<double>;
+
+void BM_TapeBoundedBalancingConstraints(benchmark::State& state) {
+    std::vector<BoundedBalancedObject<ADScalar>> objects;
+    for (int i = 0; i < state.range(0); ++i) {
+        objects.push_back(make_bounded_object(4).cast<ADScalar>());
+    }
+    const Vec3<ADScalar> gravity(0, 0, -9.81);
+    const BalanceConstraintsEnabled enabled;
+
+    for (auto _ : state) {
+        VecX<ADScalar> in = 0.1 * VecX<ADScalar>::Ones(9);
+        CppAD::Independent(in);
+        const Mat3<ADScalar> C_we = Mat3<ADScalar>::Identity();
+        VecX<ADScalar> out = balancing_constraints(
+            objects, gravity, enabled, C_we, Vec3<ADScalar>(in.segment(0, 3)),
+            Vec3<ADScalar>(in.segment(3, 3)), Vec3<ADScalar>(in.segment(6, 3)));
+        CppAD::ADFun<double> f(in, out);
+        benchmark::DoNotOptimize(f);
+    }
+}
+BENCHMARK(BM_TapeBoundedBalancingConstraints)->Arg(1)->Arg(2)->Arg(4);
+
+void BM_TapeContactForceConstraintsLinearized(benchmark::State& state) {
+    const size_t num_contacts = state.range(0);
+    std::vector<ContactPoint<ADScalar>> contacts;
+    for (const auto& contact : make_contacts(num_contacts, "object")) {
+        contacts.push_back(contact.cast<ADScalar>());
+    }
+
+    for (auto _ : state) {
+        VecX<ADScalar> forces = VecX<ADScalar>::Ones(3 * num_contacts);
+        CppAD::Independent(forces);
+        VecX<ADScalar> out =
+            compute_contact_force_constraints_linearized(contacts, forces);
+        CppAD::ADFun<double> f(forces, out);
+        benchmark::DoNotOptimize(f);
+    }
+}
+BENCHMARK(BM_TapeContactForceConstraintsLinearized)->Arg(1)->Arg(4)->Arg(8);
+
+#endif  // UPRIGHT_CORE_BENCH_WITH_CPPAD
+
+}  // namespace
+
+BENCHMARK_MAIN();
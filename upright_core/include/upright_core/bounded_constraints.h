@@ -45,8 +45,16 @@ template <typename Scalar>
 Scalar optimize_linear_st_ellipsoid(const Vec3<Scalar>& a, const Scalar& b,
                                     const Ellipsoid<Scalar>& ellipsoid,
                                     const Scalar& eps, OptType type) {
-    // TODO should we special-case ellipsoid with rank = 0 (i.e. just a point)
-    Scalar v = sqrt(a.dot(ellipsoid.Einv() * a) + eps);
+    // A rank-zero ellipsoid is a single point (the common case for tight CoM
+    // bounds): the quadratic form vanishes, leaving only the eps smoothing
+    // term, so skip it entirely. The branch resolves at taping time, which
+    // also shrinks the recorded constraint tape.
+    Scalar v;
+    if (ellipsoid.rank() == 0) {
+        v = sqrt(eps);
+    } else {
+        v = sqrt(a.dot(ellipsoid.Einv() * a) + eps);
+    }
     if (type == OptType::Min) {
         v = -v;
     }
@@ -68,16 +76,18 @@ Scalar opt_alpha_projection(const Vec3<Scalar>& p, const Mat3<Scalar>& ddC_we,
                                         type);
 }
 
+// Normal contact constraint, written into the single-entry segment out.
 template <typename Scalar>
-VecX<Scalar> bounded_contact_constraint(
-    const Mat3<Scalar>& ddC_we, const Mat3<Scalar>& C_ew,
-    const Vec3<Scalar>& linear_acc, const Vec3<Scalar>& g,
-    const BoundedBalancedObject<Scalar>& object, Scalar eps) {
+void bounded_contact_constraint(Eigen::Ref<VecX<Scalar>> out,
+                                const Mat3<Scalar>& ddC_we,
+                                const Mat3<Scalar>& C_ew,
+                                const Vec3<Scalar>& linear_acc,
+                                const Vec3<Scalar>& g,
+                                const BoundedBalancedObject<Scalar>& object,
+                                Scalar eps) {
     Vec3<Scalar> z = Vec3<Scalar>::UnitZ();
-    VecX<Scalar> contact_constraint(1);
-    contact_constraint << opt_alpha_projection(z, ddC_we, C_ew, linear_acc, g,
-                                               object, eps, OptType::Min);
-    return contact_constraint;
+    out(0) = opt_alpha_projection(z, ddC_we, C_ew, linear_acc, g, object, eps,
+                                  OptType::Min);
 }
 
 template <typename Scalar>
@@ -89,12 +99,14 @@ Mat3<Scalar> rotation_matrix_second_derivative(
     return (S_angular_acc + S_angular_vel * S_angular_vel) * C;
 }
 
+// Four friction constraints, written into the four-entry segment out.
 template <typename Scalar>
-VecX<Scalar> bounded_friction_constraint(
-    const Mat3<Scalar>& ddC_we, const Mat3<Scalar>& C_ew,
-    const Vec3<Scalar>& angular_vel, const Vec3<Scalar>& linear_acc,
-    const Vec3<Scalar>& angular_acc, const Vec3<Scalar>& g,
-    const BoundedBalancedObject<Scalar>& object, Scalar eps) {
+void bounded_friction_constraint(
+    Eigen::Ref<VecX<Scalar>> out, const Mat3<Scalar>& ddC_we,
+    const Mat3<Scalar>& C_ew, const Vec3<Scalar>& angular_vel,
+    const Vec3<Scalar>& linear_acc, const Vec3<Scalar>& angular_acc,
+    const Vec3<Scalar>& g, const BoundedBalancedObject<Scalar>& object,
+    Scalar eps) {
     // Max torque about z-axis
     Vec3<Scalar> z = Vec3<Scalar>::UnitZ();
     Mat3<Scalar> R2 = object.body.radii_of_gyration_matrix();
@@ -124,148 +136,189 @@ VecX<Scalar> bounded_friction_constraint(
     Scalar min4 = opt_alpha_projection(c4, ddC_we, C_ew, linear_acc, g, object,
                                        eps, OptType::Min);
 
-    VecX<Scalar> friction_constraint = VecX<Scalar>::Ones(4);
-
     // TODO hopefully come up with a more elegant way to handle the exact case
     if (object.body.has_exact_radii()) {
         // For the exact beta, we need to handle the sign (since in this case
         // beta is an absolute value) but can get away with sqrt(x**2 + eps),
         // since the max and min values cannot be different
         Scalar beta_positive = sqrt(squared(beta_z_max) + eps);
-        friction_constraint(0) = min1 - beta_positive / object.r_tau_min;
-        friction_constraint(1) = min2 - beta_positive / object.r_tau_min;
-        friction_constraint(2) = min3 - beta_positive / object.r_tau_min;
-        friction_constraint(3) = min4 - beta_positive / object.r_tau_min;
+        out(0) = min1 - beta_positive / object.r_tau_min;
+        out(1) = min2 - beta_positive / object.r_tau_min;
+        out(2) = min3 - beta_positive / object.r_tau_min;
+        out(3) = min4 - beta_positive / object.r_tau_min;
     } else {
         // Approximate beta_z_max is always non-negative, so we don't need to
         // handle different signs here.
-        friction_constraint(0) = min1 - beta_z_max / object.r_tau_min;
-        friction_constraint(1) = min2 - beta_z_max / object.r_tau_min;
-        friction_constraint(2) = min3 - beta_z_max / object.r_tau_min;
-        friction_constraint(3) = min4 - beta_z_max / object.r_tau_min;
+        out(0) = min1 - beta_z_max / object.r_tau_min;
+        out(1) = min2 - beta_z_max / object.r_tau_min;
+        out(2) = min3 - beta_z_max / object.r_tau_min;
+        out(3) = min4 - beta_z_max / object.r_tau_min;
     }
-
-    return friction_constraint;
 }
 
+// Robust tipping (ZMP) constraint. Four constraints per support polygon
+// edge, pairing the min/max CoM height with the min/max normal component of
+// the gravito-inertial wrench, written into the 4n-entry segment out. All
+// edges are assembled into matrix form and evaluated with dense matrix
+// products rather than one edge at a time.
 template <typename Scalar>
-VecX<Scalar> bounded_zmp_constraint(
-    const Mat3<Scalar>& ddC_we, const Mat3<Scalar>& C_ew,
-    const Vec3<Scalar>& angular_vel, const Vec3<Scalar>& linear_acc,
-    const Vec3<Scalar>& angular_acc, const Vec3<Scalar>& g,
-    const BoundedBalancedObject<Scalar>& object, Scalar eps) {
-    // Four constraints per edge
-    // std::vector<PolygonEdge<Scalar>> edges = object.support_area_min.edges();
-    // VecX<Scalar> zmp_constraints(edges.size() * 4);
-
-    // Vec3<Scalar> z = Vec3<Scalar>::UnitZ();
-    // Eigen::Matrix<Scalar, 2, 3> S;
-    // S << Scalar(0), Scalar(1), Scalar(0), Scalar(-1), Scalar(0), Scalar(0);
-    throw std::runtime_error("Bounded ZMP constraint not currently supported!");
-    Mat3<Scalar> R2 = object.body.radii_of_gyration_matrix();
+void bounded_zmp_constraint(
+    Eigen::Ref<VecX<Scalar>> out, const Mat3<Scalar>& ddC_we,
+    const Mat3<Scalar>& C_ew, const Vec3<Scalar>& angular_vel,
+    const Vec3<Scalar>& linear_acc, const Vec3<Scalar>& angular_acc,
+    const Vec3<Scalar>& g, const BoundedBalancedObject<Scalar>& object,
+    Scalar eps) {
+    using MatX3 = Eigen::Matrix<Scalar, Eigen::Dynamic, 3>;
+
+    const size_t n = object.support_area_min.num_constraints();
+
+    // NOTE: very important to use a small epsilon here
+    // TODO: ideally, we could handle this at a lower level in CppAD
+    const Scalar eps_small(1e-6);
+
+    // Inward-facing edge normals and offsets, precomputed by the support
+    // area at construction.
+    const MatX2<Scalar>& N = object.support_area_min.edge_normals();
+    const VecX<Scalar>& edge_offsets = object.support_area_min.edge_offsets();
+
+    // Normals lifted into 3D (they lie in the support plane).
+    MatX3 N3(n, 3);
+    N3 << N, VecX<Scalar>::Zero(n);
+
+    const Ellipsoid<Scalar>& com_ellipsoid = object.body.com_ellipsoid;
+    const Vec3<Scalar> com_center = com_ellipsoid.center();
+    const Mat3<Scalar> Einv = com_ellipsoid.Einv();
+
+    // Batched opt_alpha_projection (maximization) over all edge normals:
+    // row i of A is the linear coefficient a for edge i.
+    const MatX3 A = N3 * (C_ew * ddC_we);
+    const VecX<Scalar> b = N3 * (C_ew * (linear_acc - g));
+    const VecX<Scalar> alpha_xy_max =
+        A * com_center +
+        ((A * Einv).cwiseProduct(A).rowwise().sum().array() + eps)
+            .sqrt()
+            .matrix() +
+        b;
+
+    // Batched optimize_linear_st_ellipsoid (maximization): bound on the
+    // distance of the CoM from each edge.
+    const VecX<Scalar> b_r = edge_offsets - N * com_center.head(2);
+    const VecX<Scalar> r_xy_max =
+        N3 * com_center +
+        ((N3 * Einv).cwiseProduct(N3).rowwise().sum().array() + eps_small)
+            .sqrt()
+            .matrix() +
+        b_r;
+
+    // Rotational (beta) term for each edge, about the in-plane axis
+    // p = S^T * normal.
+    MatX3 P(n, 3);
+    P.col(0) = -N.col(1);
+    P.col(1) = N.col(0);
+    P.col(2).setZero();
+
+    const Mat3<Scalar> R2 = object.body.radii_of_gyration_matrix();
+    const Vec3<Scalar> w = C_ew * angular_vel;
+    const Vec3<Scalar> dw = C_ew * angular_acc;
+    const Vec3<Scalar> u = R2 * w;
+    const Vec3<Scalar> du = R2 * dw;
+
+    VecX<Scalar> beta_xy(n);
+    if (object.body.has_exact_radii()) {
+        // Batched beta_projection_exact: (p x w) . u = p . (w x u), so the
+        // whole batch is a single matrix-vector product.
+        beta_xy = P * (w.cross(u) + du);
+    } else {
+        // Batched max_beta_projection_approx, with epsilon-regularized norms
+        // taken row-wise.
+        MatX3 PxW(n, 3);
+        PxW.col(0) = P.col(1) * w(2);
+        PxW.col(1) = -P.col(0) * w(2);
+        PxW.col(2) = P.col(0) * w(1) - P.col(1) * w(0);
+        const VecX<Scalar> PxW_norms =
+            (PxW.rowwise().squaredNorm().array() + eps_small).sqrt().matrix();
+        const VecX<Scalar> P_norms =
+            (P.rowwise().squaredNorm().array() + eps_small).sqrt().matrix();
+        beta_xy = PxW_norms * epsilon_norm<Scalar>(u, eps_small) +
+                  P_norms * epsilon_norm<Scalar>(du, eps_small);
+        // The approximate beta is an upper bound on a magnitude and enters
+        // the constraint negatively; the exact beta keeps its sign.
+        beta_xy = -beta_xy;
+    }
 
-    ////
+    // Bounds on the normal component of the gravito-inertial wrench.
+    const Vec3<Scalar> z = Vec3<Scalar>::UnitZ();
+    const Scalar alpha_z_min = opt_alpha_projection(
+        z, ddC_we, C_ew, linear_acc, g, object, eps, OptType::Min);
+    const Scalar alpha_z_max = opt_alpha_projection(
+        z, ddC_we, C_ew, linear_acc, g, object, eps, OptType::Max);
+
+    const Scalar h_max = object.max_com_height();
+    const Scalar h_min = object.min_com_height();
+
+    // Interleave the four bounds per edge.
+    using StridedVec = Eigen::Map<VecX<Scalar>, 0, Eigen::InnerStride<4>>;
+    StridedVec(out.data() + 0, n) =
+        beta_xy - h_max * alpha_xy_max - alpha_z_max * r_xy_max;
+    StridedVec(out.data() + 1, n) =
+        beta_xy - h_min * alpha_xy_max - alpha_z_max * r_xy_max;
+    StridedVec(out.data() + 2, n) =
+        beta_xy - h_max * alpha_xy_max - alpha_z_min * r_xy_max;
+    StridedVec(out.data() + 3, n) =
+        beta_xy - h_min * alpha_xy_max - alpha_z_min * r_xy_max;
+}
 
-    Scalar m = object.body.mass_min;
-    Vec3<Scalar> com = object.body.com_ellipsoid.center();
-    Vec3<Scalar> alpha = m * C_ew * (linear_acc + ddC_we * com - g);
+// Number of balancing constraints contributed by a single object with the
+// given constraint families enabled.
+template <typename Scalar>
+size_t num_balancing_constraints(const BoundedBalancedObject<Scalar>& object,
+                                 const BalanceConstraintsEnabled& enabled) {
+    size_t num_constraints = 0;
+    if (enabled.normal) {
+        num_constraints += 1;
+    }
+    if (enabled.friction) {
+        num_constraints += 4;
+    }
+    if (enabled.zmp) {
+        num_constraints += 4 * object.support_area_min.num_constraints();
+    }
+    return num_constraints;
+}
 
-    Mat3<Scalar> C_we = C_we.transpose();
-    Mat3<Scalar> S_angular_vel = skew3<Scalar>(angular_vel);
-    Mat3<Scalar> Ie = m * R2;
-    Mat3<Scalar> Iw = C_we * Ie * C_ew;
-    Vec3<Scalar> beta =
-        C_ew * S_angular_vel * Iw * angular_vel + Ie * C_ew * angular_acc;
-
-    Mat2<Scalar> S;
-    S << Scalar(0), Scalar(1), Scalar(-1), Scalar(0);
-    // Vec2<Scalar> az_zmp = -object.com_height * alpha.head(2) - S *
-    // beta.head(2); return
-    // object.support_area_min.zmp_constraints_scaled(az_zmp, alpha(2));
-
-    Vec2<Scalar> zmp =
-        (-object.com_height * alpha.head(2) - S * beta.head(2)) / alpha(2);
-    return object.support_area_min.zmp_constraints(zmp);
-
-    ////
-
-    // for (int i = 0; i < edges.size(); ++i) {
-    //     Vec3<Scalar> normal3;
-    //     normal3 << edges[i].normal, Scalar(0);
-    //     Scalar alpha_xy_max = opt_alpha_projection(
-    //         normal3, ddC_we, C_ew, linear_acc, g, object, eps, OptType::Max);
-    //
-    //     // NOTE: very important to use a small epsilon here
-    //     // TODO: ideally, we could handle this at a lower level in CppAD
-    //     Scalar r_xy_max = optimize_linear_st_ellipsoid(
-    //         normal3,
-    //         -edges[i].normal.dot(object.body.com_ellipsoid.center().head(2) +
-    //                              edges[i].v1),
-    //         object.body.com_ellipsoid, Scalar(1e-6), OptType::Max);
-    //
-    //     Vec3<Scalar> p = S.transpose() * edges[i].normal;
-    //     Scalar beta_xy_max;
-    //     if (object.body.has_exact_radii()) {
-    //         beta_xy_max =
-    //             beta_projection_exact(p, R2, C_ew, angular_vel, angular_acc);
-    //     } else {
-    //         beta_xy_max = max_beta_projection_approx(p, R2, C_ew,
-    //         angular_vel,
-    //                                                  angular_acc,
-    //                                                  Scalar(1e-6));
-    //     }
-    //
-    //     Scalar alpha_z_min = opt_alpha_projection(z, ddC_we, C_ew,
-    //     linear_acc,
-    //                                               g, object, eps,
-    //                                               OptType::Min);
-    //     Scalar alpha_z_max = opt_alpha_projection(z, ddC_we, C_ew,
-    //     linear_acc,
-    //                                               g, object, eps,
-    //                                               OptType::Max);
-    //
-    //     if (object.body.has_exact_radii()) {
-    //         // When radii of gyration are exact, we remove the negative sign
-    //         // because we want to use the exact value of beta, rather than an
-    //         // upper bound. TODO as with the friction case, this can be
-    //         handled
-    //         // better
-    //         zmp_constraints(i * 4) = beta_xy_max -
-    //                                  object.max_com_height() * alpha_xy_max -
-    //                                  alpha_z_max * r_xy_max;
-    //         zmp_constraints(i * 4 + 1) =
-    //             beta_xy_max - object.min_com_height() * alpha_xy_max -
-    //             alpha_z_max * r_xy_max;
-    //         zmp_constraints(i * 4 + 2) =
-    //             beta_xy_max - object.max_com_height() * alpha_xy_max -
-    //             alpha_z_min * r_xy_max;
-    //         zmp_constraints(i * 4 + 3) =
-    //             beta_xy_max - object.min_com_height() * alpha_xy_max -
-    //             alpha_z_min * r_xy_max;
-    //     } else {
-    //         zmp_constraints(i * 4) = -beta_xy_max -
-    //                                  object.max_com_height() * alpha_xy_max -
-    //                                  alpha_z_max * r_xy_max;
-    //         zmp_constraints(i * 4 + 1) =
-    //             -beta_xy_max - object.min_com_height() * alpha_xy_max -
-    //             alpha_z_max * r_xy_max;
-    //         zmp_constraints(i * 4 + 2) =
-    //             -beta_xy_max - object.max_com_height() * alpha_xy_max -
-    //             alpha_z_min * r_xy_max;
-    //         zmp_constraints(i * 4 + 3) =
-    //             -beta_xy_max - object.min_com_height() * alpha_xy_max -
-    //             alpha_z_min * r_xy_max;
-    //     }
-    // }
-    //
-    // return zmp_constraints;
+template <typename Scalar>
+size_t num_balancing_constraints(
+    const std::vector<BoundedBalancedObject<Scalar>>& objects,
+    const BalanceConstraintsEnabled& enabled) {
+    size_t num_constraints = 0;
+    for (const auto& obj : objects) {
+        num_constraints += num_balancing_constraints(obj, enabled);
+    }
+    return num_constraints;
 }
 
+template <typename Scalar>
+size_t num_balancing_constraints(
+    const std::map<std::string, BoundedBalancedObject<Scalar>>& objects,
+    const BalanceConstraintsEnabled& enabled) {
+    size_t num_constraints = 0;
+    for (const auto& kv : objects) {
+        num_constraints += num_balancing_constraints(kv.second, enabled);
+    }
+    return num_constraints;
+}
+
+// Write the balancing constraints for one object into out, whose size must
+// equal num_balancing_constraints(object, enabled). The per-family kernels
+// write directly into segments of out, and disabled constraint families are
+// skipped outright rather than computed and then zeroed: they contribute
+// neither rows nor (when taped) recorded operations.
 // TODO make this a member of the object class
 template <typename Scalar>
-VecX<Scalar> bounded_balancing_constraints_single(
-    const Mat3<Scalar>& orientation, const Vec3<Scalar>& angular_vel,
-    const Vec3<Scalar>& linear_acc, const Vec3<Scalar>& angular_acc,
+void bounded_balancing_constraints_single(
+    Eigen::Ref<VecX<Scalar>> out, const Mat3<Scalar>& orientation,
+    const Vec3<Scalar>& angular_vel, const Vec3<Scalar>& linear_acc,
+    const Vec3<Scalar>& angular_acc,
     const BoundedBalancedObject<Scalar>& object, const Vec3<Scalar>& gravity,
     const BalanceConstraintsEnabled& enabled) {
     Mat3<Scalar> C_we = orientation;
@@ -277,53 +330,30 @@ VecX<Scalar> bounded_balancing_constraints_single(
     // values, so having small values squared makes them too close to zero.
     Scalar eps(1e-6);
 
-    // normal contact constraint
-    VecX<Scalar> g_con = bounded_contact_constraint(ddC_we, C_ew, linear_acc,
-                                                    gravity, object, eps);
-
-    // friction constraint
-    VecX<Scalar> g_fric =
-        bounded_friction_constraint(ddC_we, C_ew, angular_vel, linear_acc,
-                                    angular_acc, gravity, object, eps);
-
-    // tipping constraint
-    VecX<Scalar> g_zmp =
-        bounded_zmp_constraint(ddC_we, C_ew, angular_vel, linear_acc,
-                               angular_acc, gravity, object, eps);
+    size_t index = 0;
 
-    if (!enabled.normal) {
-        g_con.setZero();
-    }
-    if (!enabled.friction) {
-        g_fric.setZero();
-    }
-    if (!enabled.zmp) {
-        g_zmp.setZero();
+    // normal contact constraint
+    if (enabled.normal) {
+        bounded_contact_constraint<Scalar>(out.segment(index, 1), ddC_we, C_ew,
+                                   linear_acc, gravity, object, eps);
+        index += 1;
     }
 
-    VecX<Scalar> g_bal(object.num_constraints());
-    g_bal << g_con, g_fric, g_zmp;
-    return g_bal;
-}
-
-template <typename Scalar>
-size_t num_balancing_constraints(
-    const std::vector<BoundedBalancedObject<Scalar>>& objects) {
-    size_t num_constraints = 0;
-    for (const auto& obj : objects) {
-        num_constraints += obj.num_constraints();
+    // friction constraint
+    if (enabled.friction) {
+        bounded_friction_constraint<Scalar>(out.segment(index, 4), ddC_we, C_ew,
+                                    angular_vel, linear_acc, angular_acc,
+                                    gravity, object, eps);
+        index += 4;
     }
-    return num_constraints;
-}
 
-template <typename Scalar>
-size_t num_balancing_constraints(
-    const std::map<std::string, BoundedBalancedObject<Scalar>>& objects) {
-    size_t num_constraints = 0;
-    for (const auto& kv : objects) {
-        num_constraints += kv.second.num_constraints();
+    // tipping constraint
+    if (enabled.zmp) {
+        const size_t num_zmp = 4 * object.support_area_min.num_constraints();
+        bounded_zmp_constraint<Scalar>(out.segment(index, num_zmp), ddC_we, C_ew,
+                               angular_vel, linear_acc, angular_acc, gravity,
+                               object, eps);
     }
-    return num_constraints;
 }
 
 template <typename Scalar>
@@ -332,15 +362,15 @@ VecX<Scalar> balancing_constraints(
     const Vec3<Scalar>& gravity, const BalanceConstraintsEnabled& enabled,
     const Mat3<Scalar>& orientation, const Vec3<Scalar>& angular_vel,
     const Vec3<Scalar>& linear_acc, const Vec3<Scalar>& angular_acc) {
-    VecX<Scalar> constraints(num_balancing_constraints(objects));
+    VecX<Scalar> constraints(num_balancing_constraints(objects, enabled));
 
     size_t index = 0;
     for (const auto& object : objects) {
-        VecX<Scalar> v = bounded_balancing_constraints_single(
-            orientation, angular_vel, linear_acc, angular_acc, object, gravity,
-            enabled);
-        constraints.segment(index, v.rows()) = v;
-        index += v.rows();
+        const size_t n = num_balancing_constraints(object, enabled);
+        bounded_balancing_constraints_single<Scalar>(
+            constraints.segment(index, n), orientation, angular_vel,
+            linear_acc, angular_acc, object, gravity, enabled);
+        index += n;
     }
     return constraints;
 }
@@ -3,9 +3,22 @@
 #include <Eigen/Eigen>
 
 #include "upright_core/types.h"
+#include "upright_core/util.h"
 
 namespace upright {
 
+// Friction-model tags. The contact-force kernels are overloaded on these so
+// that the model is selected at compile time (or, for the generated CppAD
+// models, once at taping time): the frictionless kernels never touch the
+// cone machinery, and each tape contains only its own model's operations.
+//
+// Frictionless: one non-negative normal-force magnitude per contact.
+// LinearizedCone: full 3D force per contact, pyramidal cone facets.
+// ExactCone: full 3D force per contact, quadratic Coulomb cone.
+struct FrictionlessTag {};
+struct LinearizedConeTag {};
+struct ExactConeTag {};
+
 template <typename Scalar>
 struct ContactPoint {
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -14,6 +27,13 @@ struct ContactPoint {
     std::string object1_name;
     std::string object2_name;
 
+    // Indices of the objects in the balanced-object iteration order,
+    // resolved once from the names by resolve_contact_object_indices. A
+    // negative index marks an object that is not part of the balanced
+    // arrangement (e.g. the EE itself), whose wrench is not tracked.
+    int object1_index = -1;
+    int object2_index = -1;
+
     // Coefficient of friction
     Scalar mu;
 
@@ -30,12 +50,41 @@ struct ContactPoint {
     // the normal vector, such that span * normal = 0.
     Mat23<Scalar> span;
 
+    // Number of numeric parameters (mu, contact positions, normal, span).
+    size_t num_parameters() const { return 16; }
+
+    // Numeric parameters of the contact. The object names and resolved
+    // indices are structural and are not included.
+    VecX<Scalar> get_parameters() const {
+        VecX<Scalar> p(num_parameters());
+        p << mu, r_co_o1, r_co_o2, normal, span.row(0).transpose(),
+            span.row(1).transpose();
+        return p;
+    }
+
+    // Rebuild the numeric fields from a parameter vector, starting at the
+    // given index. Names and indices are structural, so they are left at
+    // their defaults and must be assigned by the caller if needed.
+    static ContactPoint<Scalar> from_parameters(const VecX<Scalar>& p,
+                                                const size_t index = 0) {
+        ContactPoint<Scalar> point;
+        point.mu = p(index);
+        point.r_co_o1 = p.template segment<3>(index + 1);
+        point.r_co_o2 = p.template segment<3>(index + 4);
+        point.normal = p.template segment<3>(index + 7);
+        point.span.row(0) = p.template segment<3>(index + 10).transpose();
+        point.span.row(1) = p.template segment<3>(index + 13).transpose();
+        return point;
+    }
+
     // Cast to another underlying scalar type
     template <typename T>
     ContactPoint<T> cast() const {
         ContactPoint<T> point;
         point.object1_name = object1_name;
         point.object2_name = object2_name;
+        point.object1_index = object1_index;
+        point.object2_index = object2_index;
         point.mu = T(mu);
         point.r_co_o1 = r_co_o1.template cast<T>();
         point.r_co_o2 = r_co_o2.template cast<T>();
@@ -45,4 +94,198 @@ struct ContactPoint {
     }
 };
 
+// Structure-of-arrays view of a set of contact points, built once from the
+// settings. The per-contact normals, span rows, and friction coefficients
+// are packed into dense matrices so that the friction cone constraints and
+// the per-object contact wrenches are produced by a handful of dense Eigen
+// expressions instead of a loop over ContactPoint structs. With a plain
+// scalar type the evaluation vectorizes; with the AD type the constant
+// matrices collapse the tape into linear operations.
+template <typename Scalar>
+class ContactBatch {
+   public:
+    ContactBatch() = default;
+
+    // The contacts' object indices must already have been resolved with
+    // resolve_contact_object_indices, since the wrench maps are keyed by
+    // object index.
+    ContactBatch(const std::vector<ContactPoint<Scalar>>& contacts,
+                 size_t num_objects)
+        : n_(contacts.size()), num_objects_(num_objects) {
+        normals_.resize(3, n_);
+        span1_.resize(n_, 3);
+        span2_.resize(n_, 3);
+        mus_.resize(n_);
+        for (size_t i = 0; i < n_; ++i) {
+            normals_.col(i) = contacts[i].normal;
+            span1_.row(i) = contacts[i].span.row(0);
+            span2_.row(i) = contacts[i].span.row(1);
+            mus_(i) = contacts[i].mu;
+        }
+
+        // Linear maps from the (flattened or frictionless) force vector to
+        // the stacked object wrenches [force_0; torque_0; force_1; ...].
+        // Object 1 receives the contact force, object 2 its negation; the
+        // torque contribution is r_co x f in either case.
+        wrench_map_ = MatX<Scalar>::Zero(6 * num_objects_, 3 * n_);
+        frictionless_wrench_map_ = MatX<Scalar>::Zero(6 * num_objects_, n_);
+        for (size_t i = 0; i < n_; ++i) {
+            add_wrench_map_entry(i, contacts[i].object1_index,
+                                 contacts[i].r_co_o1, Scalar(1),
+                                 contacts[i].normal);
+            add_wrench_map_entry(i, contacts[i].object2_index,
+                                 contacts[i].r_co_o2, Scalar(-1),
+                                 contacts[i].normal);
+        }
+    }
+
+    size_t size() const { return n_; }
+
+    size_t num_objects() const { return num_objects_; }
+
+    // Linearized friction cone constraints for all contacts: per contact,
+    // the non-negative normal force followed by the four facets of the
+    // pyramidal cone. Output ordering matches
+    // compute_contact_force_constraints_linearized.
+    VecX<Scalar> force_constraints_linearized(
+        const VecX<Scalar>& forces) const {
+        using Mat3N = Eigen::Matrix<Scalar, 3, Eigen::Dynamic>;
+        Eigen::Map<const Mat3N> F(forces.data(), 3, n_);
+
+        // Per-contact normal and tangential force components, all contacts
+        // at once.
+        const VecX<Scalar> f_n =
+            (normals_.array() * F.array()).colwise().sum().transpose();
+        const VecX<Scalar> f_t1 =
+            (span1_.array() * F.transpose().array()).rowwise().sum();
+        const VecX<Scalar> f_t2 =
+            (span2_.array() * F.transpose().array()).rowwise().sum();
+        const VecX<Scalar> mu_f_n = mus_.cwiseProduct(f_n);
+
+        // Column i holds contact i's five constraints, so the column-major
+        // flattening below is contact-major.
+        Eigen::Matrix<Scalar, 5, Eigen::Dynamic> constraints(5, n_);
+        constraints.row(0) = f_n.transpose();
+        constraints.row(1) = (mu_f_n - f_t1 - f_t2).transpose();
+        constraints.row(2) = (mu_f_n - f_t1 + f_t2).transpose();
+        constraints.row(3) = (mu_f_n + f_t1 - f_t2).transpose();
+        constraints.row(4) = (mu_f_n + f_t1 + f_t2).transpose();
+        return Eigen::Map<const VecX<Scalar>>(constraints.data(), 5 * n_);
+    }
+
+    // Exact (quadratic) Coulomb friction cone constraints for all contacts:
+    // per contact, the non-negative normal force followed by
+    // mu^2 f_n^2 - ||f_t||^2 >= 0. Output ordering matches
+    // compute_contact_force_constraints.
+    VecX<Scalar> force_constraints_exact(const VecX<Scalar>& forces) const {
+        using Mat3N = Eigen::Matrix<Scalar, 3, Eigen::Dynamic>;
+        Eigen::Map<const Mat3N> F(forces.data(), 3, n_);
+
+        const VecX<Scalar> f_n =
+            (normals_.array() * F.array()).colwise().sum().transpose();
+        // The squared tangential force is the squared magnitude less the
+        // squared normal component.
+        const VecX<Scalar> f_squared = F.colwise().squaredNorm().transpose();
+        const auto f_n_squared = f_n.array().square();
+
+        Eigen::Matrix<Scalar, 2, Eigen::Dynamic> constraints(2, n_);
+        constraints.row(0) = f_n.transpose();
+        constraints.row(1) = (mus_.array().square() * f_n_squared -
+                              (f_squared.array() - f_n_squared))
+                                 .transpose();
+        return Eigen::Map<const VecX<Scalar>>(constraints.data(), 2 * n_);
+    }
+
+    // Sum the forces and torques acting on each object at its contact
+    // points, as a single matrix-vector product with the precomputed wrench
+    // map. Accepts either the flattened per-contact forces or, when
+    // forces.size() equals the number of contacts, frictionless normal-force
+    // magnitudes.
+    std::vector<Wrench<Scalar>> object_wrenches(
+        const VecX<Scalar>& forces) const {
+        const bool frictionless = (size_t(forces.size()) == n_);
+        return unpack_wrenches(frictionless ? frictionless_wrench_map_ * forces
+                                            : wrench_map_ * forces);
+    }
+
+    // Tag-dispatched variants of the above: the wrench map is chosen by the
+    // friction model rather than by inspecting the force vector's size, so
+    // no branch survives into the caller's tape.
+    std::vector<Wrench<Scalar>> object_wrenches(
+        FrictionlessTag, const VecX<Scalar>& forces) const {
+        return unpack_wrenches(frictionless_wrench_map_ * forces);
+    }
+
+    std::vector<Wrench<Scalar>> object_wrenches(
+        LinearizedConeTag, const VecX<Scalar>& forces) const {
+        return unpack_wrenches(wrench_map_ * forces);
+    }
+
+    std::vector<Wrench<Scalar>> object_wrenches(
+        ExactConeTag, const VecX<Scalar>& forces) const {
+        return unpack_wrenches(wrench_map_ * forces);
+    }
+
+    // Cast to another underlying scalar type
+    template <typename T>
+    ContactBatch<T> cast() const {
+        ContactBatch<T> batch;
+        batch.n_ = n_;
+        batch.num_objects_ = num_objects_;
+        batch.normals_ = normals_.template cast<T>();
+        batch.span1_ = span1_.template cast<T>();
+        batch.span2_ = span2_.template cast<T>();
+        batch.mus_ = mus_.template cast<T>();
+        batch.wrench_map_ = wrench_map_.template cast<T>();
+        batch.frictionless_wrench_map_ =
+            frictionless_wrench_map_.template cast<T>();
+        return batch;
+    }
+
+   private:
+    template <typename T>
+    friend class ContactBatch;
+
+    std::vector<Wrench<Scalar>> unpack_wrenches(
+        const VecX<Scalar>& stacked) const {
+        std::vector<Wrench<Scalar>> wrenches(num_objects_);
+        for (size_t j = 0; j < num_objects_; ++j) {
+            wrenches[j].force = stacked.template segment<3>(6 * j);
+            wrenches[j].torque = stacked.template segment<3>(6 * j + 3);
+        }
+        return wrenches;
+    }
+
+    void add_wrench_map_entry(size_t contact_index, int object_index,
+                              const Vec3<Scalar>& r, Scalar sign,
+                              const Vec3<Scalar>& normal) {
+        if (object_index < 0) {
+            return;
+        }
+        const Mat3<Scalar> S = skew3<Scalar>(r);
+        wrench_map_.template block<3, 3>(6 * object_index,
+                                         3 * contact_index) +=
+            sign * Mat3<Scalar>::Identity();
+        wrench_map_.template block<3, 3>(6 * object_index + 3,
+                                         3 * contact_index) += sign * S;
+        frictionless_wrench_map_.template block<3, 1>(
+            6 * object_index, contact_index) += sign * normal;
+        frictionless_wrench_map_.template block<3, 1>(
+            6 * object_index + 3, contact_index) += sign * S * normal;
+    }
+
+    size_t n_ = 0;
+    size_t num_objects_ = 0;
+
+    MatX<Scalar> normals_;  // 3 x n, column i is contact i's normal
+    MatX<Scalar> span1_;    // n x 3, row i is contact i's first span row
+    MatX<Scalar> span2_;    // n x 3, row i is contact i's second span row
+    VecX<Scalar> mus_;      // friction coefficients
+
+    // (6 * num_objects) x (3 * n) and (6 * num_objects) x n maps from the
+    // contact forces to the stacked object wrenches.
+    MatX<Scalar> wrench_map_;
+    MatX<Scalar> frictionless_wrench_map_;
+};
+
 }  // namespace upright
@@ -82,6 +82,45 @@ VecX<Scalar> compute_contact_force_constraints_linearized(
     }
 }
 
+// Batch overload: the structure-of-arrays batch produces all contacts'
+// constraints with a handful of dense Eigen expressions. Output ordering
+// matches the contact-point overload above.
+template <typename Scalar>
+VecX<Scalar> compute_contact_force_constraints_linearized(
+    const ContactBatch<Scalar>& batch, const VecX<Scalar>& forces) {
+    const bool frictionless = (size_t(forces.size()) == batch.size());
+    if (frictionless) {
+        return forces;
+    }
+    return batch.force_constraints_linearized(forces);
+}
+
+// Tag-dispatched contact force constraint kernels: the friction model is
+// fixed by the overload rather than detected from the force vector's size,
+// so each caller (and each generated tape) contains only its own model.
+template <typename Scalar>
+VecX<Scalar> compute_contact_force_constraints(FrictionlessTag,
+                                               const ContactBatch<Scalar>&,
+                                               const VecX<Scalar>& forces) {
+    // The decision variables are the normal-force magnitudes themselves;
+    // constraining them non-negative requires no work per contact.
+    return forces;
+}
+
+template <typename Scalar>
+VecX<Scalar> compute_contact_force_constraints(LinearizedConeTag,
+                                               const ContactBatch<Scalar>& batch,
+                                               const VecX<Scalar>& forces) {
+    return batch.force_constraints_linearized(forces);
+}
+
+template <typename Scalar>
+VecX<Scalar> compute_contact_force_constraints(ExactConeTag,
+                                               const ContactBatch<Scalar>& batch,
+                                               const VecX<Scalar>& forces) {
+    return batch.force_constraints_exact(forces);
+}
+
 template <typename Scalar>
 Wrench<Scalar> compute_object_dynamics_constraint(
     const RigidBody<Scalar>& body, const Wrench<Scalar>& wrench,
@@ -107,14 +146,52 @@ Wrench<Scalar> compute_object_dynamics_constraint(
     return constraints;
 }
 
+// Resolve each contact point's object names to indices into the objects
+// map's (sorted) iteration order. Do this once at setup: the per-evaluation
+// wrench accumulation then indexes a flat array instead of doing string-keyed
+// map lookups per contact. Names not present in the map (e.g. the EE itself)
+// resolve to -1 and their wrenches are not tracked.
+template <typename Scalar>
+void resolve_contact_object_indices(
+    const std::map<std::string, BalancedObject<Scalar>>& objects,
+    std::vector<ContactPoint<Scalar>>& contacts) {
+    std::map<std::string, int> indices;
+    int index = 0;
+    for (const auto& kv : objects) {
+        indices[kv.first] = index++;
+    }
+    for (auto& contact : contacts) {
+        const auto it1 = indices.find(contact.object1_name);
+        contact.object1_index = (it1 == indices.end()) ? -1 : it1->second;
+        const auto it2 = indices.find(contact.object2_name);
+        contact.object2_index = (it2 == indices.end()) ? -1 : it2->second;
+    }
+}
+
+// True if the contact points' object indices have been resolved. A contact
+// with both indices negative is treated as unresolved, since a contact
+// between two objects that are both outside the arrangement is meaningless.
+template <typename Scalar>
+bool contact_object_indices_resolved(
+    const std::vector<ContactPoint<Scalar>>& contacts) {
+    for (const auto& contact : contacts) {
+        if (contact.object1_index < 0 && contact.object2_index < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // Sum the forces and torques acting on each object at their various contact
-// points.
+// points. The contacts' object indices must have been resolved with
+// resolve_contact_object_indices; wrenches are returned in the same order.
 template <typename Scalar>
-std::map<std::string, Wrench<Scalar>> compute_object_wrenches(
+std::vector<Wrench<Scalar>> compute_object_wrenches(
     const std::vector<ContactPoint<Scalar>>& contacts,
-    const VecX<Scalar>& forces) {
+    const VecX<Scalar>& forces, size_t num_objects) {
     const bool frictionless = (forces.size() == contacts.size());
-    std::map<std::string, Wrench<Scalar>> object_wrenches;
+    std::vector<Wrench<Scalar>> object_wrenches(num_objects,
+                                                Wrench<Scalar>::Zero());
     for (int i = 0; i < contacts.size(); ++i) {
         auto& contact = contacts[i];
         Vec3<Scalar> f;
@@ -125,58 +202,43 @@ std::map<std::string, Wrench<Scalar>> compute_object_wrenches(
         }
 
         // TODO this relies on object frame having same orientation as EE frame
-        if (object_wrenches.find(contact.object1_name) ==
-            object_wrenches.end()) {
-            object_wrenches[contact.object1_name].force = f;
-            object_wrenches[contact.object1_name].torque =
-                contact.r_co_o1.cross(f);
-        } else {
-            object_wrenches[contact.object1_name].force += f;
-            object_wrenches[contact.object1_name].torque +=
-                contact.r_co_o1.cross(f);
+        if (contact.object1_index >= 0) {
+            auto& wrench = object_wrenches[contact.object1_index];
+            wrench.force += f;
+            wrench.torque += contact.r_co_o1.cross(f);
         }
 
         // For the second object, the forces are negative
-        if (object_wrenches.find(contact.object2_name) ==
-            object_wrenches.end()) {
-            object_wrenches[contact.object2_name].force = -f;
-            object_wrenches[contact.object2_name].torque =
-                contact.r_co_o2.cross(-f);
-        } else {
-            object_wrenches[contact.object2_name].force -= f;
-            object_wrenches[contact.object2_name].torque +=
-                contact.r_co_o2.cross(-f);
+        if (contact.object2_index >= 0) {
+            auto& wrench = object_wrenches[contact.object2_index];
+            wrench.force -= f;
+            wrench.torque += contact.r_co_o2.cross(-f);
         }
     }
     return object_wrenches;
 }
 
-// Compute the dynamics constraints for all objects given the contact points
-// and corresponding vector of contact forces.
+// Shared tail of the compute_object_dynamics_constraints overloads: turn the
+// per-object contact wrenches into the stacked constraint vector.
 template <typename Scalar>
-VecX<Scalar> compute_object_dynamics_constraints(
+VecX<Scalar> assemble_object_dynamics_constraints(
     const std::map<std::string, BalancedObject<Scalar>>& objects,
-    const std::vector<ContactPoint<Scalar>>& contacts,
-    const VecX<Scalar>& forces, const RigidBodyState<Scalar>& state,
-    const Vec3<Scalar>& gravity) {
-    std::map<std::string, Wrench<Scalar>> object_wrenches =
-        compute_object_wrenches(contacts, forces);
-
+    const std::vector<Wrench<Scalar>>& object_wrenches,
+    const RigidBodyState<Scalar>& state, const Vec3<Scalar>& gravity,
+    size_t num_contacts) {
     VecX<Scalar> constraints(NUM_DYNAMICS_CONSTRAINTS_PER_OBJECT *
                              objects.size());
 
     // Scale force by square root of number of contacts so that L2-penalized
     // soft constraint is invariant to number of contacts
-    const Scalar force_scale(1. / sqrt(contacts.size()));
+    const Scalar force_scale(1. / sqrt(num_contacts));
 
     size_t i = 0;
     for (const auto& kv : objects) {
-        auto& name = kv.first;
         auto& body = kv.second.body;
 
-        Wrench<Scalar> wrench = object_wrenches[name];
-        Wrench<Scalar> constraint =
-            compute_object_dynamics_constraint(body, wrench, state, gravity, force_scale);
+        Wrench<Scalar> constraint = compute_object_dynamics_constraint(
+            body, object_wrenches[i], state, gravity, force_scale);
         constraints.segment(i * NUM_DYNAMICS_CONSTRAINTS_PER_OBJECT,
                             NUM_DYNAMICS_CONSTRAINTS_PER_OBJECT)
             << constraint.force,
@@ -186,4 +248,51 @@ VecX<Scalar> compute_object_dynamics_constraints(
     return constraints;
 }
 
+// Compute the dynamics constraints for all objects given the contact points
+// and corresponding vector of contact forces.
+template <typename Scalar>
+VecX<Scalar> compute_object_dynamics_constraints(
+    const std::map<std::string, BalancedObject<Scalar>>& objects,
+    const std::vector<ContactPoint<Scalar>>& contacts,
+    const VecX<Scalar>& forces, const RigidBodyState<Scalar>& state,
+    const Vec3<Scalar>& gravity) {
+    // Hot-path callers resolve the object indices once at construction.
+    // Fall back to resolving a local copy so that name-only contacts (e.g.
+    // built from the Python bindings) keep working.
+    if (!contact_object_indices_resolved(contacts)) {
+        std::vector<ContactPoint<Scalar>> resolved_contacts = contacts;
+        resolve_contact_object_indices(objects, resolved_contacts);
+        return compute_object_dynamics_constraints(objects, resolved_contacts,
+                                                   forces, state, gravity);
+    }
+
+    return assemble_object_dynamics_constraints(
+        objects, compute_object_wrenches(contacts, forces, objects.size()),
+        state, gravity, contacts.size());
+}
+
+// Batch overload: the per-object contact wrenches come from the batch's
+// precomputed wrench maps as a single matrix-vector product.
+template <typename Scalar>
+VecX<Scalar> compute_object_dynamics_constraints(
+    const std::map<std::string, BalancedObject<Scalar>>& objects,
+    const ContactBatch<Scalar>& batch, const VecX<Scalar>& forces,
+    const RigidBodyState<Scalar>& state, const Vec3<Scalar>& gravity) {
+    return assemble_object_dynamics_constraints(
+        objects, batch.object_wrenches(forces), state, gravity, batch.size());
+}
+
+// Tag-dispatched batch overload: the wrench map is chosen by the friction
+// model, so the size-based branch never enters the caller's tape.
+template <typename FrictionTag, typename Scalar>
+VecX<Scalar> compute_object_dynamics_constraints(
+    FrictionTag tag,
+    const std::map<std::string, BalancedObject<Scalar>>& objects,
+    const ContactBatch<Scalar>& batch, const VecX<Scalar>& forces,
+    const RigidBodyState<Scalar>& state, const Vec3<Scalar>& gravity) {
+    return assemble_object_dynamics_constraints(
+        objects, batch.object_wrenches(tag, forces), state, gravity,
+        batch.size());
+}
+
 }  // namespace upright
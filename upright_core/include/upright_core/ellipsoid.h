@@ -52,12 +52,12 @@ struct Ellipsoid {
         init();
     }
 
-    Mat3<Scalar> Einv() const {
-        return directions_ * Dinv * directions_.transpose();
-    }
+    // Both shape matrices are queried in the hot constraint path, so they
+    // are cached at construction rather than recomputed per call.
+    const Mat3<Scalar>& Einv() const { return Einv_; }
 
     // TODO possibly rename to .matrix() and remove Einv method
-    Mat3<Scalar> E() const { return directions_ * D * directions_.transpose(); }
+    const Mat3<Scalar>& E() const { return E_; }
 
     MatX<Scalar> rangespace() const { return directions_.leftCols(rank_); }
 
@@ -212,6 +212,9 @@ struct Ellipsoid {
         for (int i = 0; i < rank_; ++i) {
             D(i, i) = 1. / Dinv(i, i);
         }
+
+        Einv_ = directions_ * Dinv * directions_.transpose();
+        E_ = directions_ * D * directions_.transpose();
     }
 
     Vec3<Scalar> center_;
@@ -221,6 +224,11 @@ struct Ellipsoid {
     Mat3<Scalar> Dinv;  // diagonal matrix of squared half lengths
     Mat3<Scalar> D;  // inverse of D, except zero where half lengths near zero
 
+    // Cached shape matrices: Einv_ = directions * Dinv * directions^T and
+    // its (pseudo-)inverse E_.
+    Mat3<Scalar> Einv_;
+    Mat3<Scalar> E_;
+
     size_t rank_;
 };
 
@@ -92,10 +92,12 @@ BalancedObject<Scalar> BalancedObject<Scalar>::compose(
 //     return friction_constraint;
 // }
 
-// Pyramidal (linear) approximation to the limit surface
+// Pyramidal (linear) approximation to the limit surface; writes the eight
+// constraints into the segment out.
 template <typename Scalar>
-VecX<Scalar> friction_constraint_pyramidal(const BalancedObject<Scalar>& object,
-                                           const Wrench<Scalar>& giw) {
+void friction_constraint_pyramidal(Eigen::Ref<VecX<Scalar>> out,
+                                   const BalancedObject<Scalar>& object,
+                                   const Wrench<Scalar>& giw) {
     Vec3<Scalar> normal = object.support_area.normal();
     Scalar f_n = normal.dot(giw.force);
     Vec2<Scalar> f_t =
@@ -108,18 +110,15 @@ VecX<Scalar> friction_constraint_pyramidal(const BalancedObject<Scalar>& object,
     Scalar d = object.mu * f_n;
 
     // clang-format off
-    VecX<Scalar> friction_constraint(8);
-    friction_constraint << d - ( a + b + c),
-                           d - (-a + b + c),
-                           d - ( a - b + c),
-                           d - (-a - b + c),
-                           d - ( a + b - c),
-                           d - (-a + b - c),
-                           d - ( a - b - c),
-                           d - (-a - b - c);
+    out << d - ( a + b + c),
+           d - (-a + b + c),
+           d - ( a - b + c),
+           d - (-a - b + c),
+           d - ( a + b - c),
+           d - (-a + b - c),
+           d - ( a - b - c),
+           d - (-a - b - c);
     // clang-format on
-
-    return friction_constraint;
 }
 
 template <typename Scalar>
@@ -140,53 +139,55 @@ VecX<Scalar> zmp_constraint(const BalancedObject<Scalar>& object,
     return object.support_area.zmp_constraints(zmp);
 }
 
+// Write the balancing constraints for one object into out, whose size must
+// equal object.num_constraints(enabled). Disabled constraint families are
+// skipped rather than computed and discarded, so they add no work to the
+// tape recorded by the controller's auto-diff constraint.
 template <typename Scalar>
-VecX<Scalar> balancing_constraints_single(
-    const RigidBodyState<Scalar>& state, const Vec3<Scalar>& gravity,
-    const BalancedObject<Scalar>& object,
-    const BalanceConstraintsEnabled& enabled) {
+void balancing_constraints_single(Eigen::Ref<VecX<Scalar>> out,
+                                  const RigidBodyState<Scalar>& state,
+                                  const Vec3<Scalar>& gravity,
+                                  const BalancedObject<Scalar>& object,
+                                  const BalanceConstraintsEnabled& enabled) {
     Mat3<Scalar> C_we = state.pose.orientation;
     Mat3<Scalar> C_ew = C_we.transpose();
-
-    Mat3<Scalar> Ie = object.body.inertia;
-    Mat3<Scalar> Iw = C_we * Ie * C_ew;
-
-    Mat3<Scalar> S_angular_vel = skew3<Scalar>(state.velocity.angular);
     Mat3<Scalar> ddC_we = dC_dtt(state);
 
-    // gravito-inertial wrench
+    // gravito-inertial wrench; the torque only enters the friction and
+    // tipping constraints, so it is skipped when both are disabled
     Wrench<Scalar> giw;
     giw.force =
         object.body.mass * C_ew *
         (state.acceleration.linear + ddC_we * object.body.com - gravity);
 
-    giw.torque = C_ew * S_angular_vel * Iw * state.velocity.angular +
-                 Ie * C_ew * state.acceleration.angular;
+    if (enabled.friction || enabled.zmp) {
+        Mat3<Scalar> Ie = object.body.inertia;
+        Mat3<Scalar> Iw = C_we * Ie * C_ew;
+        Mat3<Scalar> S_angular_vel = skew3<Scalar>(state.velocity.angular);
+        giw.torque = C_ew * S_angular_vel * Iw * state.velocity.angular +
+                     Ie * C_ew * state.acceleration.angular;
+    }
+
+    size_t index = 0;
 
     // normal contact constraint
-    VecX<Scalar> g_con(1);
-    g_con << object.support_area.normal().dot(giw.force);
+    if (enabled.normal) {
+        out(index) = object.support_area.normal().dot(giw.force);
+        index += 1;
+    }
 
     // friction constraint
-    VecX<Scalar> g_fric = friction_constraint_pyramidal(object, giw);
+    if (enabled.friction) {
+        friction_constraint_pyramidal<Scalar>(out.segment(index, 8), object,
+                                              giw);
+        index += 8;
+    }
 
     // tipping constraint
-    VecX<Scalar> g_zmp = zmp_constraint(object, giw);
-
-    // Clear disabled constraint values.
-    if (!enabled.friction) {
-        g_fric.setZero(0);
-    }
-    if (!enabled.normal) {
-        g_con.setZero(0);
+    if (enabled.zmp) {
+        out.segment(index, object.support_area.num_constraints()) =
+            zmp_constraint(object, giw);
     }
-    if (!enabled.zmp) {
-        g_zmp.setZero(0);
-    }
-
-    VecX<Scalar> g_bal(object.num_constraints(enabled));
-    g_bal << g_con, g_fric, g_zmp;
-    return g_bal;
 }
 
 template <typename Scalar>
@@ -249,10 +250,10 @@ VecX<Scalar> BalancedObjectArrangement<Scalar>::balancing_constraints(
     size_t index = 0;
     for (const auto& kv : objects) {
         const auto& object = kv.second;
-        VecX<Scalar> v =
-            balancing_constraints_single(state, gravity, object, enabled);
-        constraints.segment(index, v.rows()) = v;
-        index += v.rows();
+        const size_t n = object.num_constraints(enabled);
+        balancing_constraints_single<Scalar>(constraints.segment(index, n),
+                                             state, gravity, object, enabled);
+        index += n;
     }
 
     return constraints;
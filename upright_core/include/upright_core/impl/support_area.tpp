@@ -80,30 +80,30 @@ Scalar distance_point_to_line_segment(const Vec2<Scalar>& point,
 }
 
 template <typename Scalar>
-Scalar distance_point_to_line_scaled(const Vec2<Scalar>& scaled_point,
-                                     Scalar scale, const Vec2<Scalar>& v1,
-                                     const Vec2<Scalar>& v2) {
-    // Compute inward-facing normal vector
-    Mat2<Scalar> S;
-    S << Scalar(0), Scalar(-1), Scalar(1), Scalar(0);
-    Vec2<Scalar> normal = S * (v2 - v1);
-    normal = normal / normal.norm();
-
-    return normal.dot(scaled_point - scale * v1);
+void PolygonSupportArea<Scalar>::compute_edge_geometry() {
+    const size_t n = vertices_.size();
+    edge_normals_.resize(n, 2);
+    edge_offsets_.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const Vec2<Scalar>& v1 = vertices_[i];
+        const Vec2<Scalar>& v2 = vertices_[(i + 1) % n];
+
+        // Inward-facing edge normal. Normalize manually rather than calling
+        // normal.normalize(), because that doesn't play nice with CppAD
+        // variables. Multiple vertices should never be equal, so this should
+        // always be well-defined.
+        Vec2<Scalar> normal(v1(1) - v2(1), v2(0) - v1(0));
+        normal = normal / normal.norm();
+
+        edge_normals_.row(i) = normal.transpose();
+        edge_offsets_(i) = -normal.dot(v1);
+    }
 }
 
 template <typename Scalar>
 VecX<Scalar> PolygonSupportArea<Scalar>::inner_distances_to_edges(
     const Vec2<Scalar>& point) const {
-    const size_t n = vertices_.size();
-    VecX<Scalar> distances(n);
-    for (int i = 0; i < n - 1; ++i) {
-        distances(i) =
-            distance_point_to_line(point, vertices_[i], vertices_[i + 1]);
-    }
-    distances(n - 1) =
-        distance_point_to_line(point, vertices_[n - 1], vertices_[0]);
-    return distances;
+    return edge_normals_ * point + edge_offsets_;
 }
 
 template <typename Scalar>
@@ -122,15 +122,9 @@ VecX<Scalar> PolygonSupportArea<Scalar>::zmp_constraints(
 template <typename Scalar>
 VecX<Scalar> PolygonSupportArea<Scalar>::zmp_constraints_scaled(
     const Vec2<Scalar>& az_zmp, Scalar& az) const {
-    const size_t n = num_constraints();
-    VecX<Scalar> constraints(n);
-    for (int i = 0; i < n - 1; ++i) {
-        constraints(i) = distance_point_to_line_scaled(az_zmp, az, vertices_[i],
-                                                       vertices_[i + 1]);
-    }
-    constraints(n - 1) = distance_point_to_line_scaled(
-        az_zmp, az, vertices_[n - 1], vertices_[0]);
-    return constraints;
+    // distance_point_to_line_scaled over all edges at once:
+    // normal_i . (az_zmp - az * v_i) = normal_i . az_zmp + az * offset_i.
+    return edge_normals_ * az_zmp + az * edge_offsets_;
 }
 
 // Minimum distance of a point from the polygon (negative if inside)
@@ -45,7 +45,14 @@ struct PolygonSupportArea {
    public:
     PolygonSupportArea(const std::vector<Vec2<Scalar>>& vertices,
                        const Vec3<Scalar>& normal, const Mat23<Scalar>& span)
-        : vertices_(vertices), normal_(normal), span_(span) {}
+        : vertices_(vertices), normal_(normal), span_(span) {
+        // Precompute the edge-normal matrix representation so that the ZMP
+        // constraints reduce to a single matrix-vector product. Every
+        // construction path (including from_parameters and offset) goes
+        // through this constructor, so the matrices are always consistent
+        // with the vertices.
+        compute_edge_geometry();
+    }
 
     PolygonSupportArea* clone() const {
         return new PolygonSupportArea(vertices_, normal_, span_);
@@ -61,6 +68,14 @@ struct PolygonSupportArea {
 
     const Mat23<Scalar> span() const { return span_; }
 
+    // Inward-facing edge normals, one row per edge spanning vertices i and
+    // i + 1 (wrapping around).
+    const MatX2<Scalar>& edge_normals() const { return edge_normals_; }
+
+    // Edge offsets -normal_i . v_i, such that the inner distance of a point
+    // p from edge i is edge_normals_.row(i) . p + edge_offsets_(i).
+    const VecX<Scalar>& edge_offsets() const { return edge_offsets_; }
+
     Vec2<Scalar> project_onto_support_plane(const Vec3<Scalar>& point) const;
 
     // Constraints on the ZMP
@@ -96,9 +111,16 @@ struct PolygonSupportArea {
    private:
     VecX<Scalar> inner_distances_to_edges(const Vec2<Scalar>& point) const;
 
+    void compute_edge_geometry();
+
     std::vector<Vec2<Scalar>> vertices_;
     Vec3<Scalar> normal_;
     Mat23<Scalar> span_;
+
+    // Precomputed edge-normal matrix representation of the polygon; see
+    // edge_normals() and edge_offsets().
+    MatX2<Scalar> edge_normals_;
+    VecX<Scalar> edge_offsets_;
 };
 
 }  // namespace upright
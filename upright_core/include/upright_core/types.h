@@ -33,6 +33,9 @@ using Mat3 = Eigen::Matrix<Scalar, 3, 3>;
 template <typename Scalar>
 using Mat23 = Eigen::Matrix<Scalar, 2, 3>;
 
+template <typename Scalar>
+using MatX2 = Eigen::Matrix<Scalar, Eigen::Dynamic, 2>;
+
 template <typename Scalar>
 struct Pose {
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
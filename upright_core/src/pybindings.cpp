@@ -1,6 +1,7 @@
 #include <pybind11/eigen.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/stl_bind.h>
 
 #include "upright_core/bounded.h"
 #include "upright_core/bounded_constraints.h"
@@ -13,6 +14,18 @@
 using namespace pybind11::literals;
 using namespace upright;
 
+// The contact and object containers are opaque: they cross the boundary as
+// views of the underlying C++ containers rather than being copied to and
+// from Python lists/dicts on every access. The constraint evaluations below
+// take them by reference, so e.g. a simulation loop editing a contact's mu
+// and re-evaluating does not copy the whole arrangement each step. They are
+// bound here (and only here); upright_control declares them opaque as well
+// to share the types.
+using ContactPointVector = std::vector<ContactPoint<double>>;
+using BalancedObjectMap = std::map<std::string, BalancedObject<double>>;
+PYBIND11_MAKE_OPAQUE(ContactPointVector)
+PYBIND11_MAKE_OPAQUE(BalancedObjectMap)
+
 PYBIND11_MODULE(bindings, m) {
     using Scalar = double;
 
@@ -62,6 +75,12 @@ PYBIND11_MODULE(bindings, m) {
         .def_readwrite("normal", &ContactPoint<Scalar>::normal)
         .def_readwrite("span", &ContactPoint<Scalar>::span);
 
+    // Note that BalancedObjectMap only supports inserting fresh keys from
+    // Python: BalancedObject is not assignable, so overwriting an existing
+    // entry would silently do nothing.
+    pybind11::bind_vector<ContactPointVector>(m, "ContactPointVector");
+    pybind11::bind_map<BalancedObjectMap>(m, "BalancedObjectMap");
+
     pybind11::class_<Pose<Scalar>>(m, "Pose")
         .def(pybind11::init<>())
         .def_readwrite("position", &Pose<Scalar>::position)
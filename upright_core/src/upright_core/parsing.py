@@ -11,8 +11,10 @@ import mobile_manipulation_central as mm
 from upright_core.bindings import (
     RigidBody,
     BalancedObject,
+    BalancedObjectMap,
     PolygonSupportArea,
     ContactPoint,
+    ContactPointVector,
 )
 from upright_core import math, polyhedron
 
@@ -67,6 +69,28 @@ def load_config(path, depth=0, max_depth=5):
     return d
 
 
+def config_include_closure(path, depth=0, max_depth=5):
+    """List every configuration file read by load_config for `path`.
+
+    This walks the same include chain as load_config. It is used to judge
+    settings snapshot freshness against the whole closure rather than just
+    the top-level file.
+    """
+    if depth > max_depth:
+        raise Exception(f"Maximum inclusion depth {max_depth} exceeded.")
+
+    paths = [Path(path).resolve().as_posix()]
+    with open(path) as f:
+        d = yaml.safe_load(f)
+
+    for include in d.get("include", []):
+        include_path = parse_ros_path(include)
+        paths.extend(
+            config_include_closure(include_path, depth=depth + 1, max_depth=max_depth)
+        )
+    return paths
+
+
 def parse_number(x, dtype=float):
     """Parse a number from the config.
 
@@ -171,7 +195,9 @@ def _parse_objects_with_contacts(wrappers, contact_conf, tol=1e-7):
     wrappers is the dict of name: object wrappers
     neighbours is a list of pairs of names specifying objects in contact
     """
-    contact_points = []
+    # opaque bound container: passed by reference into the C++ constraint
+    # evaluations rather than copied per call
+    contact_points = ContactPointVector()
     for contact in contact_conf:
         name1 = contact["first"]
         name2 = contact["second"]
@@ -227,7 +253,9 @@ def _parse_objects_with_contacts(wrappers, contact_conf, tol=1e-7):
     # constraints, but useful for (1) homogeneity of the settings API and (2)
     # allows some additional analysis on e.g. distance from support area
     mus = parse_mu_dict(contact_conf, apply_margin=True)
-    balanced_objects = {}
+    # only ever insert fresh keys here: BalancedObjectMap silently ignores
+    # overwrites of existing entries
+    balanced_objects = BalancedObjectMap()
     for name, wrapper in wrappers.items():
         if wrapper.fixture:  # includes the EE
             continue
@@ -322,7 +350,7 @@ def _parse_composite_objects(wrappers, contact_conf):
             descendants[parent_name].append((name, obj))
 
     # compose objects together
-    composites = {}
+    composites = BalancedObjectMap()
     for children in descendants.values():
         composite_name = "_".join([name for name, _ in children])
         composite = BalancedObject.compose([obj for _, obj in children])
@@ -551,4 +579,4 @@ def parse_control_objects(ctrl_conf):
         return _parse_objects_with_contacts(wrappers, contact_conf)
     else:
         composites = _parse_composite_objects(wrappers, contact_conf)
-        return composites, []
+        return composites, ContactPointVector()
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <upright_core/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+namespace upright {
+
+// Events that the fixed-rate loops may log. Formatting happens on the
+// background thread; the hot path only stores the event tag and the raw
+// numeric payload.
+enum class LogEvent : uint16_t {
+    StateLowerLimitViolated,
+    StateUpperLimitViolated,
+    InputLowerLimitViolated,
+    InputUpperLimitViolated,
+    EndEffectorPositionViolated,
+    ObstacleStateDebug,
+};
+
+// Maximum total number of scalars across a record's payload vectors.
+constexpr size_t LOG_RECORD_MAX_VALUES = 64;
+
+// Fixed-size binary log record. Up to three vector payloads are stored back
+// to back in values; counts gives the length of each.
+struct LogRecord {
+    LogEvent event;
+    ocs2::scalar_t time;
+    uint16_t counts[3];
+    ocs2::scalar_t values[LOG_RECORD_MAX_VALUES];
+};
+
+// Asynchronous logger for the fixed-rate loops. The hot path pushes
+// fixed-size binary records into a lock-free single-producer single-consumer
+// ring; a background thread pops, formats, and emits them through iostream,
+// so the unbounded cost of formatted output never lands on the control
+// thread. log() performs no allocation, locking, or system calls.
+//
+// If the ring is full the record is dropped and counted; the background
+// thread reports new drops as it notices them, so overflow is visible rather
+// than silent. Only one thread may call log().
+class AsyncLogger {
+   public:
+    AsyncLogger() : thread_(&AsyncLogger::process_records, this) {}
+
+    ~AsyncLogger() {
+        running_.store(false, std::memory_order_relaxed);
+        thread_.join();
+    }
+
+    void log(LogEvent event, ocs2::scalar_t time) {
+        LogRecord* record = claim_slot();
+        if (record == nullptr) {
+            return;
+        }
+        record->event = event;
+        record->time = time;
+        record->counts[0] = record->counts[1] = record->counts[2] = 0;
+        publish_slot();
+    }
+
+    void log(LogEvent event, ocs2::scalar_t time,
+             const Eigen::Ref<const VecXd>& v0) {
+        log_segments(event, time, v0, VecXd(), VecXd());
+    }
+
+    void log(LogEvent event, ocs2::scalar_t time,
+             const Eigen::Ref<const VecXd>& v0,
+             const Eigen::Ref<const VecXd>& v1) {
+        log_segments(event, time, v0, v1, VecXd());
+    }
+
+    void log(LogEvent event, ocs2::scalar_t time,
+             const Eigen::Ref<const VecXd>& v0,
+             const Eigen::Ref<const VecXd>& v1,
+             const Eigen::Ref<const VecXd>& v2) {
+        log_segments(event, time, v0, v1, v2);
+    }
+
+    // Total number of records dropped because the ring was full.
+    uint64_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    static constexpr size_t RING_SIZE = 256;  // power of two
+
+    // Reserve the next slot for writing, or return null (and count a drop)
+    // if the ring is full.
+    LogRecord* claim_slot() {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        const uint64_t tail = tail_.load(std::memory_order_acquire);
+        if (head - tail >= RING_SIZE) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &ring_[head % RING_SIZE];
+    }
+
+    // Make the slot returned by claim_slot visible to the consumer.
+    void publish_slot() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+    }
+
+    void log_segments(LogEvent event, ocs2::scalar_t time,
+                      const Eigen::Ref<const VecXd>& v0,
+                      const Eigen::Ref<const VecXd>& v1,
+                      const Eigen::Ref<const VecXd>& v2) {
+        if (size_t(v0.size() + v1.size() + v2.size()) >
+            LOG_RECORD_MAX_VALUES) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        LogRecord* record = claim_slot();
+        if (record == nullptr) {
+            return;
+        }
+        record->event = event;
+        record->time = time;
+        record->counts[0] = v0.size();
+        record->counts[1] = v1.size();
+        record->counts[2] = v2.size();
+
+        Eigen::Map<VecXd>(record->values, v0.size()) = v0;
+        Eigen::Map<VecXd>(record->values + v0.size(), v1.size()) = v1;
+        Eigen::Map<VecXd>(record->values + v0.size() + v1.size(), v2.size()) =
+            v2;
+        publish_slot();
+    }
+
+    // Background thread: pop, format, emit. Runs until the logger is
+    // destroyed, then drains whatever is left in the ring.
+    void process_records() {
+        uint64_t reported_drops = 0;
+        while (true) {
+            const uint64_t head = head_.load(std::memory_order_acquire);
+            uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head) {
+                if (!running_.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            while (tail != head) {
+                format_record(ring_[tail % RING_SIZE]);
+                ++tail;
+            }
+            tail_.store(tail, std::memory_order_release);
+
+            const uint64_t drops = dropped_.load(std::memory_order_relaxed);
+            if (drops != reported_drops) {
+                std::cerr << "[AsyncLogger] dropped "
+                          << (drops - reported_drops)
+                          << " log records (ring full)." << std::endl;
+                reported_drops = drops;
+            }
+        }
+    }
+
+    // Map over payload segment i of the record.
+    static Eigen::Map<const VecXd> segment(const LogRecord& record, size_t i) {
+        size_t offset = 0;
+        for (size_t j = 0; j < i; ++j) {
+            offset += record.counts[j];
+        }
+        return Eigen::Map<const VecXd>(record.values + offset,
+                                       record.counts[i]);
+    }
+
+    static void format_record(const LogRecord& record) {
+        switch (record.event) {
+            case LogEvent::StateLowerLimitViolated:
+                std::cout << "x = " << segment(record, 0).transpose()
+                          << std::endl;
+                std::cout << "State violated lower limits!" << std::endl;
+                break;
+            case LogEvent::StateUpperLimitViolated:
+                std::cout << "x = " << segment(record, 0).transpose()
+                          << std::endl;
+                std::cout << "State violated upper limits!" << std::endl;
+                break;
+            case LogEvent::InputLowerLimitViolated:
+                std::cout << "u = " << segment(record, 0).transpose()
+                          << std::endl;
+                std::cout << "Input violated lower limits!" << std::endl;
+                break;
+            case LogEvent::InputUpperLimitViolated:
+                std::cout << "u = " << segment(record, 0).transpose()
+                          << std::endl;
+                std::cout << "Input violated upper limits!" << std::endl;
+                break;
+            case LogEvent::EndEffectorPositionViolated:
+                std::cerr << "Controller violated position limits!"
+                          << std::endl;
+                std::cerr << "Controller position = "
+                          << segment(record, 0).transpose() << std::endl;
+                std::cerr << "Desired position = "
+                          << segment(record, 1).transpose() << std::endl;
+                std::cerr << "q = " << segment(record, 2).transpose()
+                          << std::endl;
+                break;
+            case LogEvent::ObstacleStateDebug:
+                std::cout << "x_obs = " << segment(record, 0).transpose()
+                          << std::endl;
+                std::cout << "xd_obs = " << segment(record, 1).transpose()
+                          << std::endl;
+                break;
+        }
+    }
+
+    LogRecord ring_[RING_SIZE];
+    std::atomic<uint64_t> head_{0};  // written by the producer
+    std::atomic<uint64_t> tail_{0};  // written by the consumer
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+};
+
+}  // namespace upright
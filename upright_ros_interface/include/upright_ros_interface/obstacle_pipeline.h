@@ -0,0 +1,276 @@
+#pragma once
+
+#include <mobile_manipulation_central/projectile.h>
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+#include <upright_control/constraint/obstacle_constraint.h>
+#include <upright_core/types.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace upright {
+
+// Per-obstacle flight state for estimator-driven obstacles.
+enum class ObstacleFlightState {
+    Preflight,
+    Flight,
+    Postflight,
+};
+
+// Target adjustment requested by the obstacle thread. The control thread
+// owns the MRT interface, so target resets happen there; the obstacle
+// thread only raises events.
+enum class ObstacleTargetEvent {
+    None,
+    // An obstacle has entered flight: switch to the avoidance target.
+    Avoid,
+    // All in-flight obstacles have landed: restore the original target.
+    Restore,
+};
+
+// Interface over an estimator that tracks several moving objects at once.
+// Obstacle i of the pipeline below is driven by target i of the estimator
+// whenever that target is being tracked.
+class MultiObstacleEstimator {
+   public:
+    virtual ~MultiObstacleEstimator() = default;
+
+    // Number of targets the estimator can track.
+    virtual size_t size() const = 0;
+
+    // True if target i currently has a valid estimate.
+    virtual bool ready(size_t i) const = 0;
+
+    virtual Vec3d position(size_t i) const = 0;
+    virtual Vec3d velocity(size_t i) const = 0;
+};
+
+// Adapter exposing mm's single-projectile Vicon estimator through the
+// multi-target interface: target 0 is the projectile, further targets are
+// never ready. A true multi-target estimator can replace this without
+// touching the pipeline.
+class ProjectileObstacleEstimator final : public MultiObstacleEstimator {
+   public:
+    explicit ProjectileObstacleEstimator(mm::ProjectileROSInterface& projectile)
+        : projectile_(projectile) {}
+
+    size_t size() const override { return 1; }
+
+    bool ready(size_t i) const override {
+        return i == 0 && projectile_.ready();
+    }
+
+    Vec3d position(size_t i) const override { return projectile_.q(); }
+
+    Vec3d velocity(size_t i) const override { return projectile_.v(); }
+
+   private:
+    mm::ProjectileROSInterface& projectile_;
+};
+
+// Event-driven obstacle state pipeline for the tracking loop.
+//
+// The obstacle region of the optimizer state is one 9-entry block
+// [position, velocity, acceleration] per obstacle, laid out exactly as
+// SystemDynamics::systemFlowMap iterates it. This pipeline maintains that
+// whole region in a staging block updated by a dedicated thread -- which
+// also drains the estimator's callback queue and runs the per-obstacle
+// flight-state machines -- and publishes it through a seqlock-protected
+// snapshot like RobotFeedback. The control loop consumes the region with
+// one vectorized, allocation-free copy and one atomic event poll per tick,
+// independent of the number of obstacles.
+class ObstaclePipeline {
+   public:
+    // The first num_estimator_targets obstacles are driven by the
+    // estimator and flight-tracked; the rest follow their scripted modes.
+    // activation/deactivation heights are the flight thresholds [m].
+    ObstaclePipeline(const std::vector<DynamicObstacle>& obstacles,
+                     size_t num_estimator_targets, double activation_height,
+                     double deactivation_height)
+        : obstacles_(obstacles),
+          num_estimator_targets_(num_estimator_targets),
+          activation_height_(activation_height),
+          deactivation_height_(deactivation_height),
+          flight_states_(obstacles.size(), ObstacleFlightState::Preflight),
+          staging_(VecXd::Zero(9 * obstacles.size())),
+          block_(VecXd::Zero(9 * obstacles.size())) {
+        for (size_t i = 0; i < obstacles_.size(); ++i) {
+            const size_t num_modes = obstacles_[i].modes.size();
+            if (estimator_driven(i)) {
+                if (num_modes != 1) {
+                    throw std::runtime_error(
+                        "Estimator-driven obstacle " + obstacles_[i].name +
+                        " must have exactly one mode.");
+                }
+            } else if (num_modes < 1 || num_modes > 2) {
+                throw std::runtime_error("Scripted obstacle " +
+                                         obstacles_[i].name +
+                                         " must have one or two modes.");
+            }
+        }
+    }
+
+    ~ObstaclePipeline() { stop(); }
+
+    ObstaclePipeline(const ObstaclePipeline&) = delete;
+    ObstaclePipeline& operator=(const ObstaclePipeline&) = delete;
+
+    // Queue on which the estimator must register its subscribers: construct
+    // it with a NodeHandle that has this queue set as its callback queue,
+    // so its callbacks run on the pipeline thread instead of the control
+    // thread's spinOnce().
+    ros::CallbackQueue& queue() { return queue_; }
+
+    // Start the pipeline thread. initial_block seeds the snapshot (the
+    // obstacle region of the initial state), t0 anchors scripted mode
+    // switching times, and rate bounds the update frequency. The estimator
+    // (which may be null when no obstacle is estimator-driven) must already
+    // have its subscribers registered on queue(), and is only accessed from
+    // the pipeline thread from here on.
+    void start(const MultiObstacleEstimator* estimator,
+               const Eigen::Ref<const VecXd>& initial_block, double t0,
+               double rate) {
+        staging_ = initial_block;
+        write(staging_);
+        t0_ = t0;
+        running_.store(true, std::memory_order_relaxed);
+        thread_ = std::thread([this, estimator, rate]() {
+            ros::Rate spin_rate(rate);
+            while (ros::ok() && running_.load(std::memory_order_relaxed)) {
+                queue_.callAvailable();
+                update(estimator, ros::Time::now().toSec());
+                spin_rate.sleep();
+            }
+        });
+    }
+
+    void stop() {
+        running_.store(false, std::memory_order_relaxed);
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    // Copy the latest obstacle block into out (size 9 * num obstacles)
+    // without ever blocking the writer, as in RobotFeedback::read. Does not
+    // allocate.
+    void read(Eigen::Ref<VecXd> out) const {
+        while (true) {
+            const uint64_t seq_before =
+                sequence_.load(std::memory_order_acquire);
+            if (seq_before % 2 != 0) {
+                continue;  // write in progress
+            }
+            out = block_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == seq_before) {
+                return;
+            }
+        }
+    }
+
+    // Consume the pending target event, if any.
+    ObstacleTargetEvent poll_target_event() {
+        return target_event_.exchange(ObstacleTargetEvent::None,
+                                      std::memory_order_acq_rel);
+    }
+
+   private:
+    bool estimator_driven(size_t i) const {
+        return i < num_estimator_targets_;
+    }
+
+    // One pipeline step: advance the flight-state machines and refresh the
+    // staging block, then publish it. Called only from the pipeline thread.
+    void update(const MultiObstacleEstimator* estimator, double t) {
+        size_t in_flight = 0;
+        bool entered_flight = false;
+        bool landed = false;
+
+        for (size_t i = 0; i < obstacles_.size(); ++i) {
+            auto segment = staging_.segment(9 * i, 9);
+            const bool tracked = estimator_driven(i) &&
+                                 estimator != nullptr &&
+                                 i < estimator->size() &&
+                                 estimator->ready(i);
+            if (tracked) {
+                const Vec3d q_obs = estimator->position(i);
+                ObstacleFlightState& state = flight_states_[i];
+                if (state == ObstacleFlightState::Preflight &&
+                    q_obs(2) > activation_height_) {
+                    state = ObstacleFlightState::Flight;
+                    entered_flight = true;
+                } else if (state == ObstacleFlightState::Flight &&
+                           q_obs(2) < deactivation_height_) {
+                    state = ObstacleFlightState::Postflight;
+                    landed = true;
+                }
+                if (state != ObstacleFlightState::Preflight) {
+                    segment.head(3) = q_obs;
+                    segment.segment(3, 3) = estimator->velocity(i);
+                    segment.tail(3) = obstacles_[i].modes[0].acceleration;
+                }
+                if (state == ObstacleFlightState::Flight) {
+                    ++in_flight;
+                }
+            } else if (!estimator_driven(i)) {
+                const auto& modes = obstacles_[i].modes;
+                if (modes.size() > 1 && t - t0_ > modes[1].time) {
+                    segment = modes[1].state();
+                } else {
+                    segment = modes[0].state();
+                }
+            }
+        }
+
+        // Raise target events on the edges of the in-flight count: switch
+        // to the avoidance target when the first obstacle takes flight, and
+        // restore the original target once none remain in flight.
+        if (entered_flight && !was_in_flight_) {
+            target_event_.store(ObstacleTargetEvent::Avoid,
+                                std::memory_order_release);
+        } else if (landed && in_flight == 0 && was_in_flight_) {
+            target_event_.store(ObstacleTargetEvent::Restore,
+                                std::memory_order_release);
+        }
+        was_in_flight_ = in_flight > 0;
+
+        write(staging_);
+    }
+
+    // Seqlock writer; called only from the pipeline thread.
+    void write(const VecXd& block) {
+        const uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_release);
+        block_ = block;
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    std::vector<DynamicObstacle> obstacles_;
+    size_t num_estimator_targets_;
+    double activation_height_;
+    double deactivation_height_;
+
+    ros::CallbackQueue queue_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    double t0_ = 0;
+
+    // Pipeline-thread state.
+    std::vector<ObstacleFlightState> flight_states_;
+    VecXd staging_;
+    bool was_in_flight_ = false;
+
+    // Snapshot shared with the control thread.
+    std::atomic<uint64_t> sequence_{0};
+    VecXd block_;
+
+    std::atomic<ObstacleTargetEvent> target_event_{
+        ObstacleTargetEvent::None};
+};
+
+}  // namespace upright
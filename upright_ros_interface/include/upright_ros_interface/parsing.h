@@ -8,8 +8,10 @@
 #include <pybind11/eigen.h>
 #include <pybind11/embed.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
 #include <upright_control/controller_settings.h>
+#include <upright_control/settings_snapshot.h>
 #include <upright_control/types.h>
 
 namespace py = pybind11;
@@ -28,6 +30,16 @@ ControllerSettings parse_control_settings(const std::string& config_path) {
         .cast<ControllerSettings>();
 }
 
+// List every file in the configuration's include closure, so snapshot
+// freshness can be judged against all of them rather than just the
+// top-level file.
+std::vector<std::string> parse_config_include_closure(
+    const std::string& config_path) {
+    py::object parsing = py::module::import("upright_core").attr("parsing");
+    return parsing.attr("config_include_closure")(config_path)
+        .cast<std::vector<std::string>>();
+}
+
 ocs2::TargetTrajectories parse_target_trajectory(const std::string& config_path,
                                                  const VecXd& x0) {
     py::object upright_control = py::module::import("upright_control");
@@ -37,4 +49,33 @@ ocs2::TargetTrajectories parse_target_trajectory(const std::string& config_path,
         .cast<ocs2::TargetTrajectories>();
 }
 
+// Parse the end effector pose waypoints from the configuration file. These
+// are relative to the initial end effector pose; combined with an initial
+// state they produce the same target trajectory as parse_target_trajectory,
+// but without requiring Python at tracking time (see
+// build_target_trajectory).
+std::vector<PoseWaypoint> parse_target_waypoints(
+    const std::string& config_path) {
+    py::object parsing = py::module::import("upright_core").attr("parsing");
+    py::dict config =
+        parsing.attr("load_config")(config_path).cast<py::dict>();
+    py::dict ctrl_config = config["controller"].cast<py::dict>();
+
+    std::vector<PoseWaypoint> waypoints;
+    if (!ctrl_config.contains("waypoints")) {
+        return waypoints;
+    }
+    for (auto item : ctrl_config["waypoints"]) {
+        py::dict waypoint_config = item.cast<py::dict>();
+        PoseWaypoint waypoint;
+        waypoint.time = waypoint_config["time"].cast<ocs2::scalar_t>();
+        waypoint.position = waypoint_config["position"].cast<Vec3d>();
+        const VecXd quat = waypoint_config["orientation"].cast<VecXd>();
+        waypoint.orientation =
+            Quatd(quat(3), quat(0), quat(1), quat(2)).normalized();
+        waypoints.push_back(waypoint);
+    }
+    return waypoints;
+}
+
 }  // namespace upright
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <upright_control/controller_settings.h>
+
+namespace upright {
+
+// Helpers to apply the tracking.realtime settings block at node startup.
+// Everything here is best-effort: a controller PC without the required
+// privileges gets a clear complaint on stderr and then runs with default
+// scheduling, which is exactly what it did before.
+
+// Switch the calling process to SCHED_FIFO at the given priority. A priority
+// of zero is a no-op (keep CFS). Returns true on success.
+inline bool set_fifo_priority(const std::string& name, int priority) {
+    if (priority <= 0) {
+        return true;
+    }
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+        std::cerr << "Failed to set SCHED_FIFO priority " << priority
+                  << " for " << name << ": " << strerror(errno)
+                  << ". Grant CAP_SYS_NICE or raise the rtprio limit in "
+                     "/etc/security/limits.conf." << std::endl;
+        return false;
+    }
+    std::cout << name << " running SCHED_FIFO at priority " << priority
+              << std::endl;
+    return true;
+}
+
+// Pin the calling process (and all threads it spawns afterward) to the given
+// cores. An empty list is a no-op (leave placement to the kernel). Returns
+// true on success.
+inline bool set_cpu_affinity(const std::string& name,
+                             const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return true;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        std::cerr << "Failed to set CPU affinity for " << name << ": "
+                  << strerror(errno) << std::endl;
+        return false;
+    }
+    std::cout << name << " pinned to " << cpus.size() << " core(s)."
+              << std::endl;
+    return true;
+}
+
+// Lock current and future pages into RAM so the control loop cannot take
+// page faults. Returns true on success.
+inline bool lock_memory(const std::string& name) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::cerr << "Failed to lock memory for " << name << ": "
+                  << strerror(errno)
+                  << ". Grant CAP_IPC_LOCK or raise the memlock limit in "
+                     "/etc/security/limits.conf." << std::endl;
+        return false;
+    }
+    std::cout << name << " memory locked." << std::endl;
+    return true;
+}
+
+// Apply the realtime settings for the MPC node. Call before the solver is
+// constructed so the worker threads inherit the affinity mask.
+inline void apply_mpc_realtime_settings(const RealtimeSettings& settings) {
+    set_cpu_affinity("mpc_node", settings.mpc_cpus);
+    set_fifo_priority("mpc_node", settings.mpc_priority);
+    if (settings.lock_memory) {
+        lock_memory("mpc_node");
+    }
+}
+
+// Apply the realtime settings for the tracking (MRT) node.
+inline void apply_control_realtime_settings(const RealtimeSettings& settings) {
+    set_cpu_affinity("mrt_node", settings.control_cpus);
+    set_fifo_priority("mrt_node", settings.control_priority);
+    if (settings.lock_memory) {
+        lock_memory("mrt_node");
+    }
+}
+
+}  // namespace upright
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <mobile_manipulation_central/robot_interfaces.h>
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+#include <upright_core/types.h>
+
+#include <atomic>
+#include <thread>
+
+namespace upright {
+
+// Event-driven robot feedback for the tracking loop.
+//
+// The robot interface's subscribers are registered on a dedicated callback
+// queue (see queue()) drained by an internal thread, so joint feedback is
+// processed the moment it arrives instead of when the control loop next calls
+// ros::spinOnce(). Each new measurement is published, together with its
+// receipt time, into a seqlock-protected snapshot that the control loop reads
+// without blocking: the loop then knows both the latest measurement and its
+// actual age, rather than assuming every measurement arrived this tick.
+class RobotFeedback {
+   public:
+    explicit RobotFeedback(size_t nq) : q_(VecXd::Zero(nq)) {}
+
+    ~RobotFeedback() { stop(); }
+
+    RobotFeedback(const RobotFeedback&) = delete;
+    RobotFeedback& operator=(const RobotFeedback&) = delete;
+
+    // Queue on which the robot interface must register its subscribers:
+    // construct the interface with a NodeHandle that has this queue set as
+    // its callback queue, then call start().
+    ros::CallbackQueue& queue() { return queue_; }
+
+    // Start the feedback thread. The robot interface must already have
+    // registered its subscribers on queue(), and is only accessed from the
+    // feedback thread from here on.
+    void start(mm::RobotROSInterface& robot) {
+        running_.store(true, std::memory_order_relaxed);
+        thread_ = std::thread([this, &robot]() {
+            while (ros::ok() && running_.load(std::memory_order_relaxed)) {
+                // Block until a callback is ready (with a timeout so that
+                // shutdown is noticed), run it, then drain any backlog
+                // without blocking so the snapshot reflects the newest
+                // message.
+                if (queue_.callOne(ros::WallDuration(0.1)) !=
+                    ros::CallbackQueue::Called) {
+                    continue;
+                }
+                while (queue_.callOne() == ros::CallbackQueue::Called) {
+                }
+                if (robot.ready()) {
+                    write(robot.q(), ros::Time::now().toSec());
+                }
+            }
+        });
+    }
+
+    void stop() {
+        running_.store(false, std::memory_order_relaxed);
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    // True once at least one measurement has been received.
+    bool has_measurement() const {
+        return sequence_.load(std::memory_order_acquire) >= 2;
+    }
+
+    // Copy the latest measurement and its receipt time into q and stamp,
+    // without ever blocking the writer. Returns false while no measurement
+    // has been received. A read torn by a concurrent write is retried; the
+    // writer's critical section is a small copy, so the retry loop is
+    // bounded in practice. Does not allocate (q must already have the right
+    // size).
+    bool read(VecXd& q, double& stamp) const {
+        while (true) {
+            const uint64_t seq_before =
+                sequence_.load(std::memory_order_acquire);
+            if (seq_before < 2) {
+                return false;
+            }
+            if (seq_before % 2 != 0) {
+                continue;  // write in progress
+            }
+            q = q_;
+            stamp = stamp_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == seq_before) {
+                return true;
+            }
+        }
+    }
+
+   private:
+    // Writer side; called only from the feedback thread. The sequence is
+    // bumped to an odd value before the write and the next even value after,
+    // as in ShmTransport.
+    void write(const VecXd& q, double stamp) {
+        const uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_release);
+        q_ = q;
+        stamp_ = stamp;
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    ros::CallbackQueue queue_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> sequence_{0};
+    VecXd q_;
+    double stamp_ = 0;
+};
+
+}  // namespace upright
@@ -1,65 +1,98 @@
 #pragma once
 
-#include <ocs2_pinocchio_interface/PinocchioEndEffectorKinematics.h>
 #include <ocs2_pinocchio_interface/PinocchioInterface.h>
 #include <upright_control/controller_interface.h>
-#include <upright_control/dynamics/system_pinocchio_mapping.h>
+#include <upright_control/reference_trajectory.h>
 #include <upright_core/types.h>
+#include <upright_ros_interface/async_logger.h>
 
-#include <iostream>
+#include <algorithm>
 #include <pinocchio/algorithm/frames.hpp>
+#include <pinocchio/algorithm/joint-configuration.hpp>
+#include <pinocchio/algorithm/model.hpp>
 #include <pinocchio/fwd.hpp>
+#include <vector>
 
 namespace upright {
 
 class SafetyMonitor {
    public:
     SafetyMonitor(const ControllerSettings& settings,
-                  const ocs2::PinocchioInterface& pinocchio_interface)
-        : settings_(settings), pinocchio_interface_(pinocchio_interface) {
-        SystemPinocchioMapping<TripleIntegratorPinocchioMapping<ocs2::scalar_t>,
-                               ocs2::scalar_t>
-            mapping(settings.dims);
-        kinematics_ptr_.reset(new ocs2::PinocchioEndEffectorKinematics(
-            pinocchio_interface, mapping, {settings.end_effector_link_name}));
-        kinematics_ptr_->setPinocchioInterface(pinocchio_interface_);
+                  const ocs2::PinocchioInterface& pinocchio_interface,
+                  AsyncLogger& logger)
+        : settings_(settings), logger_(logger) {
+        // The position check only needs the placement of the end effector
+        // frame, but the controller's model also carries the dynamic
+        // obstacle joints. Build a reduced model containing just the joint
+        // chain supporting the end effector, so forwardKinematics touches
+        // nothing else, and evaluate it into persistent, preallocated data.
+        const auto& model = pinocchio_interface.getModel();
+        const auto frame_id =
+            model.getFrameId(settings.end_effector_link_name);
+        const auto parent_joint = model.frames[frame_id].parent;
+
+        std::vector<bool> in_chain(model.njoints, false);
+        for (const auto joint : model.supports[parent_joint]) {
+            in_chain[joint] = true;
+        }
+        std::vector<pinocchio::JointIndex> joints_to_lock;
+        for (pinocchio::JointIndex joint = 1; joint < model.njoints; ++joint) {
+            if (!in_chain[joint]) {
+                joints_to_lock.push_back(joint);
+            }
+        }
+        chain_model_ = pinocchio::buildReducedModel(model, joints_to_lock,
+                                                    pinocchio::neutral(model));
+        chain_data_ = pinocchio::Data(chain_model_);
+        chain_frame_id_ =
+            chain_model_.getFrameId(settings.end_effector_link_name);
+
+        // The reduced model keeps the robot's joints in their original
+        // order, so its configuration is exactly the robot part of the
+        // state.
+        if (size_t(chain_model_.nq) != settings.dims.robot.q) {
+            throw std::runtime_error(
+                "End effector chain dimension does not match the robot "
+                "configuration dimension.");
+        }
+        q_chain_ = VecXd::Zero(chain_model_.nq);
     }
 
-    bool state_limits_violated(const VecXd& x) const {
+    // The checks below run inside the fixed-rate tracking loop, so
+    // diagnostics are pushed to the async logger rather than formatted here;
+    // formatted iostream output takes unbounded time, which is exactly what
+    // the loop cannot afford when something has already gone wrong.
+    bool state_limits_violated(ocs2::scalar_t t, const VecXd& x) const {
         VecXd x_robot = x.head(settings_.dims.robot.x);
 
         if (((x_robot - settings_.state_limit_lower).array() <
              -settings_.tracking.state_violation_margin)
                 .any()) {
-            std::cout << "x = " << x_robot.transpose() << std::endl;
-            std::cout << "State violated lower limits!" << std::endl;
+            logger_.log(LogEvent::StateLowerLimitViolated, t, x_robot);
             return true;
         }
         if (((settings_.state_limit_upper - x_robot).array() <
              -settings_.tracking.state_violation_margin)
                 .any()) {
-            std::cout << "x = " << x_robot.transpose() << std::endl;
-            std::cout << "State violated upper limits!" << std::endl;
+            logger_.log(LogEvent::StateUpperLimitViolated, t, x_robot);
             return true;
         }
         return false;
     }
 
-    bool input_limits_violated(const VecXd& u) const {
+    bool input_limits_violated(ocs2::scalar_t t, const VecXd& u) const {
         VecXd u_robot = u.head(settings_.dims.robot.u);
 
         if (((u_robot - settings_.input_limit_lower).array() <
              -settings_.tracking.input_violation_margin)
                 .any()) {
-            std::cout << "u = " << u_robot.transpose() << std::endl;
-            std::cout << "Input violated lower limits!" << std::endl;
+            logger_.log(LogEvent::InputLowerLimitViolated, t, u_robot);
             return true;
         }
         if (((settings_.input_limit_upper - u_robot).array() <
              -settings_.tracking.input_violation_margin)
                 .any()) {
-            std::cout << "u = " << u_robot.transpose() << std::endl;
-            std::cout << "Input violated upper limits!" << std::endl;
+            logger_.log(LogEvent::InputUpperLimitViolated, t, u_robot);
             return true;
         }
         return false;
@@ -67,29 +100,26 @@ class SafetyMonitor {
 
     bool end_effector_position_violated(const ocs2::TargetTrajectories& target,
                                         ocs2::scalar_t t, const VecXd& x) {
-        VecXd q = VecXd::Zero(settings_.dims.q());
-        q.tail(settings_.dims.robot.q) = x.head(settings_.dims.robot.q);
-
-        pinocchio::forwardKinematics(pinocchio_interface_.getModel(),
-                                     pinocchio_interface_.getData(), q);
-        pinocchio::updateFramePlacements(pinocchio_interface_.getModel(),
-                                         pinocchio_interface_.getData());
-        Vec3d actual_position = kinematics_ptr_->getPosition(x).front();
-        Vec3d desired_position = interpolate_end_effector_pose(t, target).first;
-
-        VecXd position_constraint(6);
-        position_constraint
-            << desired_position + settings_.xyz_upper - actual_position,
+        q_chain_ = x.head(settings_.dims.robot.q);
+
+        pinocchio::forwardKinematics(chain_model_, chain_data_, q_chain_);
+        pinocchio::updateFramePlacement(chain_model_, chain_data_,
+                                        chain_frame_id_);
+        Vec3d actual_position =
+            chain_data_.oMf[chain_frame_id_].translation();
+        Vec3d desired_position =
+            compiled_reference_.interpolate_pose(t, target).first;
+
+        // Fixed-size intermediates: this check runs every control cycle.
+        Vec3d upper_dist =
+            desired_position + settings_.xyz_upper - actual_position;
+        Vec3d lower_dist =
             actual_position - (desired_position + settings_.xyz_lower);
 
-        if (position_constraint.minCoeff() <
+        if (std::min(upper_dist.minCoeff(), lower_dist.minCoeff()) <
             -settings_.tracking.ee_position_violation_margin) {
-            std::cerr << "Controller violated position limits!" << std::endl;
-            std::cerr << "Controller position = " << actual_position.transpose()
-                      << std::endl;
-            std::cerr << "Desired position = " << desired_position.transpose()
-                      << std::endl;
-            std::cerr << "q = " << q.transpose() << std::endl;
+            logger_.log(LogEvent::EndEffectorPositionViolated, t,
+                        actual_position, desired_position, q_chain_);
             return true;
         }
         return false;
@@ -97,8 +127,12 @@ class SafetyMonitor {
 
    private:
     ControllerSettings settings_;
-    std::unique_ptr<ocs2::PinocchioEndEffectorKinematics> kinematics_ptr_;
-    ocs2::PinocchioInterface pinocchio_interface_;
+    pinocchio::Model chain_model_;
+    pinocchio::Data chain_data_;
+    pinocchio::FrameIndex chain_frame_id_;
+    VecXd q_chain_;
+    CompiledEndEffectorReference compiled_reference_;
+    AsyncLogger& logger_;
 };
 
 }  // namespace upright
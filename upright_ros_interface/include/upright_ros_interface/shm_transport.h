@@ -0,0 +1,299 @@
+#pragma once
+
+#include <ocs2_core/control/FeedforwardController.h>
+#include <ocs2_mpc/SystemObservation.h>
+#include <ocs2_oc/oc_data/PrimalSolution.h>
+#include <upright_core/types.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace upright {
+
+// Shared-memory transport between the MPC and tracking (MRT) nodes when both
+// run on the same host. Observations and policies are exchanged through
+// fixed-size slots in a POSIX shared-memory segment with seqlock-style
+// sequence validation, instead of being serialized through ROS TCP. Only
+// feedforward policies are carried: the tracking node applies its own state
+// feedback gains (tracking.kp/kv/ka), which is how this pipeline is run.
+//
+// Selected via tracking.use_shm_transport; leave it false when the nodes run
+// on different hosts, in which case the usual ROS transport is used.
+
+// Maximum problem dimensions representable in a slot. These bound the size
+// of the (fixed-size) shared segment; dimensions are validated at attach
+// time so a mismatch fails loudly rather than corrupting data.
+constexpr size_t SHM_MAX_STATE_DIM = 64;
+constexpr size_t SHM_MAX_INPUT_DIM = 32;
+constexpr size_t SHM_MAX_POLICY_NODES = 64;
+constexpr size_t SHM_MAX_POLICY_MODES = 8;
+constexpr size_t SHM_POLICY_RING_SIZE = 4;
+constexpr uint32_t SHM_TRANSPORT_MAGIC = 0x55505254;  // "UPRT"
+
+// Latest-wins observation slot. The writer bumps the sequence to an odd
+// value before writing and to the next even value after; a reader that sees
+// an odd or changed sequence discards the torn read and tries again.
+struct ShmObservationSlot {
+    std::atomic<uint64_t> sequence{0};
+    double time = 0;
+    uint64_t mode = 0;
+    double state[SHM_MAX_STATE_DIM];
+    double input[SHM_MAX_INPUT_DIM];
+};
+
+// One policy, flattened. The mode schedule stores num_modes modes separated
+// by num_modes - 1 event times.
+struct ShmPolicySlot {
+    std::atomic<uint64_t> sequence{0};
+    uint64_t num_nodes = 0;
+    uint64_t num_modes = 0;
+    double times[SHM_MAX_POLICY_NODES];
+    double states[SHM_MAX_POLICY_NODES * SHM_MAX_STATE_DIM];
+    double inputs[SHM_MAX_POLICY_NODES * SHM_MAX_INPUT_DIM];
+    double event_times[SHM_MAX_POLICY_MODES];
+    uint64_t modes[SHM_MAX_POLICY_MODES];
+};
+
+struct ShmSegment {
+    std::atomic<uint32_t> magic{0};
+    uint32_t nx = 0;
+    uint32_t nu = 0;
+    // Monotonic count of policies written; the latest lives in slot
+    // (policy_count - 1) % SHM_POLICY_RING_SIZE. The ring gives the reader
+    // time to finish copying a slot before the writer reuses it.
+    std::atomic<uint64_t> policy_count{0};
+    ShmObservationSlot observation;
+    ShmPolicySlot policies[SHM_POLICY_RING_SIZE];
+};
+
+class ShmTransport {
+   public:
+    // Create or attach to the segment for the given robot. Whichever node
+    // arrives first creates and initializes it (ftruncate zero-fills, so all
+    // sequence counters start in the "empty" state); the other validates
+    // that the dimensions match.
+    ShmTransport(const std::string& robot_name, size_t nx, size_t nu)
+        : name_("/" + robot_name + "_upright_shm") {
+        if (nx > SHM_MAX_STATE_DIM || nu > SHM_MAX_INPUT_DIM) {
+            throw std::runtime_error(
+                "Problem dimensions exceed shared-memory transport limits.");
+        }
+
+        const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open shared memory " + name_);
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 ||
+            (st.st_size == 0 && ftruncate(fd, sizeof(ShmSegment)) < 0)) {
+            close(fd);
+            throw std::runtime_error("Failed to size shared memory " + name_);
+        }
+
+        void* addr = mmap(nullptr, sizeof(ShmSegment),
+                          PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error("Failed to map shared memory " + name_);
+        }
+        segment_ = static_cast<ShmSegment*>(addr);
+
+        uint32_t expected = 0;
+        if (segment_->magic.compare_exchange_strong(
+                expected, SHM_TRANSPORT_MAGIC - 1)) {
+            // We created the segment: publish the dimensions, then the magic.
+            segment_->nx = nx;
+            segment_->nu = nu;
+            segment_->magic.store(SHM_TRANSPORT_MAGIC,
+                                  std::memory_order_release);
+        } else {
+            // The other node created it; wait for initialization to finish.
+            while (segment_->magic.load(std::memory_order_acquire) !=
+                   SHM_TRANSPORT_MAGIC) {
+            }
+            if (segment_->nx != nx || segment_->nu != nu) {
+                throw std::runtime_error(
+                    "Shared-memory transport dimension mismatch: segment has "
+                    "nx = " + std::to_string(segment_->nx) + ", nu = " +
+                    std::to_string(segment_->nu) + ".");
+            }
+        }
+        nx_ = nx;
+        nu_ = nu;
+
+        // The segment persists across process restarts, so it may still hold
+        // the previous session's observation and policies; a reader starting
+        // its counters at zero would otherwise consume the old session's
+        // final policy as if it were fresh. Clear the counters so both
+        // streams start empty. This also races benignly with a peer that is
+        // already running: at worst one observation or policy written during
+        // this constructor is dropped, and the peer republishes on its next
+        // cycle (the seqlock validation covers the reset like any other
+        // concurrent write).
+        segment_->observation.sequence.store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < SHM_POLICY_RING_SIZE; ++i) {
+            segment_->policies[i].sequence.store(0,
+                                                 std::memory_order_relaxed);
+        }
+        segment_->policy_count.store(0, std::memory_order_release);
+    }
+
+    // Unmap but do not unlink: the other node may outlive us. Any state left
+    // behind is discarded by the counter reset the next node performs above.
+    ~ShmTransport() { munmap(segment_, sizeof(ShmSegment)); }
+
+    ShmTransport(const ShmTransport&) = delete;
+    ShmTransport& operator=(const ShmTransport&) = delete;
+
+    // Write the latest observation. Allocation-free: plain stores into the
+    // mapped segment, so this is safe inside the strict real-time sections
+    // of the tracking loop.
+    void write_observation(const ocs2::SystemObservation& observation) {
+        ShmObservationSlot& slot = segment_->observation;
+        const uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(seq + 1, std::memory_order_release);
+        slot.time = observation.time;
+        slot.mode = observation.mode;
+        std::memcpy(slot.state, observation.state.data(),
+                    nx_ * sizeof(double));
+        std::memcpy(slot.input, observation.input.data(),
+                    nu_ * sizeof(double));
+        slot.sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Read the latest observation if it is newer than `last_sequence`.
+    // Returns false if nothing new is available or the read was torn;
+    // `observation` must already have the correct dimensions.
+    bool read_observation(ocs2::SystemObservation& observation,
+                          uint64_t& last_sequence) const {
+        const ShmObservationSlot& slot = segment_->observation;
+        const uint64_t seq_before =
+            slot.sequence.load(std::memory_order_acquire);
+        if (seq_before == last_sequence || seq_before % 2 != 0) {
+            return false;
+        }
+        observation.time = slot.time;
+        observation.mode = slot.mode;
+        std::memcpy(observation.state.data(), slot.state,
+                    nx_ * sizeof(double));
+        std::memcpy(observation.input.data(), slot.input,
+                    nu_ * sizeof(double));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != seq_before) {
+            return false;  // torn read; caller will retry next cycle
+        }
+        last_sequence = seq_before;
+        return true;
+    }
+
+    // Publish a policy into the next ring slot. The controller is not
+    // serialized; the reader reconstructs a feedforward controller from the
+    // input trajectory.
+    void write_policy(const ocs2::PrimalSolution& policy) {
+        const size_t num_nodes = policy.timeTrajectory_.size();
+        const size_t num_modes = policy.modeSchedule_.modeSequence.size();
+        if (num_nodes > SHM_MAX_POLICY_NODES ||
+            num_modes > SHM_MAX_POLICY_MODES) {
+            throw std::runtime_error(
+                "Policy exceeds shared-memory transport limits; increase "
+                "SHM_MAX_POLICY_NODES/SHM_MAX_POLICY_MODES.");
+        }
+
+        const uint64_t count =
+            segment_->policy_count.load(std::memory_order_relaxed);
+        ShmPolicySlot& slot =
+            segment_->policies[count % SHM_POLICY_RING_SIZE];
+
+        const uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(seq + 1, std::memory_order_release);
+        slot.num_nodes = num_nodes;
+        slot.num_modes = num_modes;
+        for (size_t i = 0; i < num_nodes; ++i) {
+            slot.times[i] = policy.timeTrajectory_[i];
+            std::memcpy(&slot.states[i * nx_],
+                        policy.stateTrajectory_[i].data(),
+                        nx_ * sizeof(double));
+            std::memcpy(&slot.inputs[i * nu_],
+                        policy.inputTrajectory_[i].data(),
+                        nu_ * sizeof(double));
+        }
+        for (size_t i = 0; i + 1 < num_modes; ++i) {
+            slot.event_times[i] = policy.modeSchedule_.eventTimes[i];
+        }
+        for (size_t i = 0; i < num_modes; ++i) {
+            slot.modes[i] = policy.modeSchedule_.modeSequence[i];
+        }
+        slot.sequence.store(seq + 2, std::memory_order_release);
+        segment_->policy_count.store(count + 1, std::memory_order_release);
+    }
+
+    // Read the latest policy if one newer than `last_count` is available,
+    // reconstructing the trajectories and a feedforward controller. Returns
+    // false if there is nothing new or the writer overran the slot mid-read.
+    bool read_policy(ocs2::PrimalSolution& policy,
+                     uint64_t& last_count) const {
+        const uint64_t count =
+            segment_->policy_count.load(std::memory_order_acquire);
+        if (count == last_count || count == 0) {
+            return false;
+        }
+        const ShmPolicySlot& slot =
+            segment_->policies[(count - 1) % SHM_POLICY_RING_SIZE];
+
+        const uint64_t seq_before =
+            slot.sequence.load(std::memory_order_acquire);
+        if (seq_before % 2 != 0) {
+            return false;
+        }
+        const size_t num_nodes = slot.num_nodes;
+        const size_t num_modes = slot.num_modes;
+
+        policy.timeTrajectory_.resize(num_nodes);
+        policy.stateTrajectory_.resize(num_nodes);
+        policy.inputTrajectory_.resize(num_nodes);
+        for (size_t i = 0; i < num_nodes; ++i) {
+            policy.timeTrajectory_[i] = slot.times[i];
+            policy.stateTrajectory_[i] =
+                Eigen::Map<const VecXd>(&slot.states[i * nx_], nx_);
+            policy.inputTrajectory_[i] =
+                Eigen::Map<const VecXd>(&slot.inputs[i * nu_], nu_);
+        }
+        ocs2::scalar_array_t event_times(num_modes - 1);
+        ocs2::size_array_t mode_sequence(num_modes);
+        for (size_t i = 0; i + 1 < num_modes; ++i) {
+            event_times[i] = slot.event_times[i];
+        }
+        for (size_t i = 0; i < num_modes; ++i) {
+            mode_sequence[i] = slot.modes[i];
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != seq_before) {
+            return false;  // writer lapped the ring during the copy
+        }
+
+        policy.modeSchedule_ =
+            ocs2::ModeSchedule(std::move(event_times),
+                               std::move(mode_sequence));
+        policy.controllerPtr_.reset(new ocs2::FeedforwardController(
+            policy.timeTrajectory_, policy.inputTrajectory_));
+        last_count = count;
+        return true;
+    }
+
+   private:
+    std::string name_;
+    ShmSegment* segment_ = nullptr;
+    size_t nx_ = 0;
+    size_t nu_ = 0;
+};
+
+}  // namespace upright
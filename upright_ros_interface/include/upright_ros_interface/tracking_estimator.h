@@ -0,0 +1,274 @@
+#pragma once
+
+#include <Eigen/Eigen>
+#include <upright_control/controller_settings.h>
+#include <upright_control/dimensions.h>
+#include <upright_core/types.h>
+
+#include <memory>
+
+namespace upright {
+
+// Interface for the tracking-loop Kalman filter, so the loop can hold any of
+// the fixed-size instantiations below behind one pointer. There is a single
+// virtual call per tick; everything inside runs on the instantiation's own
+// (fixed-size, preallocated) storage.
+class TrackingEstimatorBase {
+   public:
+    virtual ~TrackingEstimatorBase() = default;
+
+    // Update the estimate given the latest joint position measurement, the
+    // commanded jerk, and the time dt elapsed since the last update.
+    virtual void update(const VecXd& q_measured, const VecXd& u_cmd,
+                        ocs2::scalar_t dt) = 0;
+
+    // Precompute the steady-state Kalman gain for the nominal timestep dt.
+    virtual void compute_steady_state_gain(ocs2::scalar_t dt) = 0;
+
+    // Update the estimate using the constant gain from
+    // compute_steady_state_gain. Only valid when the elapsed time matches
+    // the nominal timestep.
+    virtual void update_steady_state(const VecXd& q_measured,
+                                     const VecXd& u_cmd) = 0;
+
+    // Shift a joint measurement forward by its age (the time elapsed between
+    // its receipt and the current loop time), so the correction step can
+    // treat it as a measurement of the current state.
+    virtual void compensate_measurement_age(VecXd& q_measured,
+                                            ocs2::scalar_t age) const = 0;
+
+    // Write the current state estimate into the head of x.
+    virtual void copy_state_to(VecXd& x) const = 0;
+};
+
+// Kalman filter for the robot's triple-integrator state used by the tracking
+// loop. Unlike the generic mm::kf routines, which return freshly-allocated
+// matrices, all storage here (including intermediate products and the LDLT
+// decomposition) is allocated once at construction, so update() performs no
+// heap allocations. This keeps the fixed-rate loop free of allocator-induced
+// latency spikes and lets it run under tracking.realtime_strict.
+//
+// Q is the compile-time configuration dimension (see FixedRobotDimensions);
+// for the supported robots (q = 3, 6, 9) every matrix below is fixed-size,
+// so Eigen unrolls and vectorizes the update kernels. Q = Eigen::Dynamic
+// gives the runtime-sized fallback. Use make_tracking_estimator to dispatch.
+template <int Q = Eigen::Dynamic>
+class TrackingEstimator final : public TrackingEstimatorBase {
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    static constexpr int X = (Q == Eigen::Dynamic) ? Eigen::Dynamic : 3 * Q;
+
+    using VecQ = Eigen::Matrix<ocs2::scalar_t, Q, 1>;
+    using VecX_ = Eigen::Matrix<ocs2::scalar_t, X, 1>;
+    using MatQ = Eigen::Matrix<ocs2::scalar_t, Q, Q>;
+    using MatX_ = Eigen::Matrix<ocs2::scalar_t, X, X>;
+    using MatXQ = Eigen::Matrix<ocs2::scalar_t, X, Q>;
+    using MatQX = Eigen::Matrix<ocs2::scalar_t, Q, X>;
+
+    TrackingEstimator(const RobotDimensions& dims,
+                      const EstimationSettings& settings, const VecXd& x0)
+        : nq_(dims.q), nv_(dims.v), nx_(dims.x), ldlt_(dims.q) {
+        x_ = x0.head(nx_);
+        P_ = settings.robot_init_variance * MatX_::Identity(nx_, nx_);
+
+        const MatQ I = MatQ::Identity(nq_, nq_);
+        Q0_ = settings.robot_process_variance * I;
+        R0_ = settings.robot_measurement_variance * I;
+
+        // The transition matrices are refilled in place each update; only
+        // their (block-)diagonal entries ever change.
+        A_ = MatX_::Identity(nx_, nx_);
+        B_ = MatXQ::Zero(nx_, nv_);
+
+        // Workspaces
+        Q_ = MatX_::Zero(nx_, nx_);
+        BQ0_ = MatXQ::Zero(nx_, nv_);
+        AP_ = MatX_::Zero(nx_, nx_);
+        x_work_ = VecX_::Zero(nx_);
+        S_ = MatQ::Zero(nq_, nq_);
+        Kt_ = MatQX::Zero(nq_, nx_);
+        KCP_ = MatX_::Zero(nx_, nx_);
+        y_ = VecQ::Zero(nq_);
+    }
+
+    void update(const VecXd& q_measured, const VecXd& u_cmd,
+                ocs2::scalar_t dt) override {
+        fill_transition_matrices(dt);
+
+        // Predict: x <- A * x + B * u, P <- A * P * A^T + B * Q0 * B^T
+        BQ0_.noalias() = B_ * Q0_;
+        Q_.noalias() = BQ0_ * B_.transpose();
+
+        x_work_.noalias() = A_ * x_;
+        x_work_.noalias() += B_ * u_cmd;
+        x_ = x_work_;
+
+        AP_.noalias() = A_ * P_;
+        P_.noalias() = AP_ * A_.transpose();
+        P_ += Q_;
+
+        // Correct with measurement matrix C = [I 0 0], so that C * P is just
+        // the top block row of P and the innovation covariance
+        // S = C * P * C^T + R0 is its top-left block.
+        S_ = P_.topLeftCorner(nq_, nq_);
+        S_ += R0_;
+
+        // Solve for the transposed Kalman gain K^T = S^{-1} * C * P rather
+        // than forming S^{-1} explicitly. compute() and solveInPlace() reuse
+        // the decomposition's preallocated storage.
+        ldlt_.compute(S_);
+        Kt_ = P_.topRows(nq_);
+        ldlt_.solveInPlace(Kt_);
+
+        y_ = q_measured;
+        y_ -= x_.head(nq_);
+        x_.noalias() += Kt_.transpose() * y_;
+
+        // P <- (I - K * C) * P = P - K^T^T * (C * P)
+        KCP_.noalias() = Kt_.transpose() * P_.topRows(nq_);
+        P_ -= KCP_;
+    }
+
+    // Precompute the steady-state Kalman gain for the nominal timestep dt by
+    // iterating the covariance propagation to convergence, i.e. a fixed-point
+    // solve of the discrete Riccati equation. Called once at startup; this is
+    // the only method here that is allowed to allocate. The internal
+    // covariance is left at its converged value so that a later fall back to
+    // the time-varying update() starts from a sensible covariance.
+    void compute_steady_state_gain(ocs2::scalar_t dt) override {
+        fill_transition_matrices(dt);
+        A_nom_ = A_;
+        B_nom_ = B_;
+
+        BQ0_.noalias() = B_ * Q0_;
+        Q_.noalias() = BQ0_ * B_.transpose();
+
+        MatX_ P = P_;
+        MatX_ P_prev = P;
+        for (size_t i = 0; i < MAX_RICCATI_ITERATIONS; ++i) {
+            P_prev = P;
+
+            // Predict
+            AP_.noalias() = A_ * P;
+            P.noalias() = AP_ * A_.transpose();
+            P += Q_;
+
+            // Correct
+            S_ = P.topLeftCorner(nq_, nq_);
+            S_ += R0_;
+            ldlt_.compute(S_);
+            Kt_nom_ = P.topRows(nq_);
+            ldlt_.solveInPlace(Kt_nom_);
+            KCP_.noalias() = Kt_nom_.transpose() * P.topRows(nq_);
+            P -= KCP_;
+
+            if ((P - P_prev).template lpNorm<Eigen::Infinity>() <
+                RICCATI_TOLERANCE) {
+                P_ = P;
+                return;
+            }
+        }
+        throw std::runtime_error(
+            "Steady-state Kalman gain iteration did not converge.");
+    }
+
+    // Skips covariance propagation and the innovation covariance solve
+    // entirely. Does not allocate.
+    void update_steady_state(const VecXd& q_measured,
+                             const VecXd& u_cmd) override {
+        x_work_.noalias() = A_nom_ * x_;
+        x_work_.noalias() += B_nom_ * u_cmd;
+        x_ = x_work_;
+
+        y_ = q_measured;
+        y_ -= x_.head(nq_);
+        x_.noalias() += Kt_nom_.transpose() * y_;
+    }
+
+    // Extrapolate a measurement forward by its age using the current
+    // velocity and acceleration estimates, so the correction step compares
+    // like with like: the prediction refers to the loop time, while the
+    // measurement was taken `age` seconds earlier. Does not allocate.
+    void compensate_measurement_age(VecXd& q_measured,
+                                    ocs2::scalar_t age) const override {
+        q_measured += age * x_.segment(nq_, nv_);
+        q_measured += (0.5 * age * age) * x_.tail(nv_);
+    }
+
+    void copy_state_to(VecXd& x) const override { x.head(nx_) = x_; }
+
+    const VecX_& state() const { return x_; }
+    const MatX_& covariance() const { return P_; }
+
+   private:
+    static constexpr size_t MAX_RICCATI_ITERATIONS = 10000;
+    static constexpr ocs2::scalar_t RICCATI_TOLERANCE = 1e-12;
+
+    // Refill the triple-integrator transition matrices in place. Only the
+    // diagonals of the upper-triangular blocks are non-zero.
+    void fill_transition_matrices(ocs2::scalar_t dt) {
+        const ocs2::scalar_t dt2 = dt * dt;
+
+        A_.block(0, nq_, nq_, nv_).diagonal().setConstant(dt);
+        A_.block(0, nq_ + nv_, nq_, nv_).diagonal().setConstant(0.5 * dt2);
+        A_.block(nq_, nq_ + nv_, nv_, nv_).diagonal().setConstant(dt);
+
+        B_.topRows(nq_).diagonal().setConstant(dt * dt2 / 6);
+        B_.middleRows(nq_, nv_).diagonal().setConstant(0.5 * dt2);
+        B_.bottomRows(nv_).diagonal().setConstant(dt);
+    }
+    size_t nq_;
+    size_t nv_;
+    size_t nx_;
+
+    // Estimate
+    VecX_ x_;
+    MatX_ P_;
+
+    // Noise covariances
+    MatQ Q0_;
+    MatQ R0_;
+
+    // Transition matrices, refilled in place each update
+    MatX_ A_;
+    MatXQ B_;
+
+    // Transition matrices and transposed gain at the nominal timestep, set
+    // by compute_steady_state_gain
+    MatX_ A_nom_;
+    MatXQ B_nom_;
+    MatQX Kt_nom_;
+
+    // Preallocated workspaces
+    MatX_ Q_;
+    MatXQ BQ0_;
+    MatX_ AP_;
+    VecX_ x_work_;
+    MatQ S_;
+    MatQX Kt_;
+    MatX_ KCP_;
+    VecQ y_;
+    Eigen::LDLT<MatQ> ldlt_;
+};
+
+// Dispatch once at startup to the fixed-size estimator matching the robot
+// (q = 3, 6, 9); exotic dimensions fall back to the runtime-sized variant.
+inline std::unique_ptr<TrackingEstimatorBase> make_tracking_estimator(
+    const RobotDimensions& dims, const EstimationSettings& settings,
+    const VecXd& x0) {
+    if (FixedRobotDimensions<3>::matches(dims)) {
+        return std::unique_ptr<TrackingEstimatorBase>(
+            new TrackingEstimator<3>(dims, settings, x0));
+    } else if (FixedRobotDimensions<6>::matches(dims)) {
+        return std::unique_ptr<TrackingEstimatorBase>(
+            new TrackingEstimator<6>(dims, settings, x0));
+    } else if (FixedRobotDimensions<9>::matches(dims)) {
+        return std::unique_ptr<TrackingEstimatorBase>(
+            new TrackingEstimator<9>(dims, settings, x0));
+    }
+    return std::unique_ptr<TrackingEstimatorBase>(
+        new TrackingEstimator<>(dims, settings, x0));
+}
+
+}  // namespace upright
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include <upright_control/settings_snapshot.h>
+
+#include <upright_ros_interface/parsing.h>
+
+using namespace upright;
+
+// Offline tool: compile the end effector waypoints from one or more YAML task
+// definitions into a binary target bank. The tracking node loads the bank at
+// startup and switches between the named entries at runtime via the
+// select_target service, without re-parsing anything or restarting the
+// controller. Each entry is named after its configuration file.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output bank path> <config.yaml> [config.yaml ...]"
+                  << std::endl;
+        return 1;
+    }
+    const std::string bank_path = argv[1];
+
+    // Parsing the YAML configurations requires the embedded interpreter;
+    // this is fine here since this tool runs offline.
+    py::scoped_interpreter guard{};
+
+    TargetBank bank;
+    for (int i = 2; i < argc; ++i) {
+        const std::string config_path = argv[i];
+        const std::string name =
+            boost::filesystem::path(config_path).stem().string();
+        if (bank.entries.count(name) > 0) {
+            throw std::runtime_error("Duplicate target bank entry name: " +
+                                     name);
+        }
+        bank.entries[name] = parse_target_waypoints(config_path);
+        std::cout << name << ": " << bank.entries[name].size()
+                  << " waypoint(s)" << std::endl;
+    }
+
+    save_target_bank(bank_path, bank);
+    std::cout << "Wrote " << bank.entries.size() << " target(s) to "
+              << bank_path << std::endl;
+
+    return 0;
+}
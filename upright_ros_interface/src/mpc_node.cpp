@@ -1,5 +1,7 @@
+#include <sstream>
 #include <vector>
 
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <ros/ros.h>
 
 #include <ocs2_mpc/MPC_BASE.h>
@@ -8,8 +10,12 @@
 
 #include <upright_control/controller_settings.h>
 #include <upright_control/controller_interface.h>
+#include <upright_control/settings_snapshot.h>
+#include <upright_control/warm_start_store.h>
 
 #include <upright_ros_interface/parsing.h>
+#include <upright_ros_interface/realtime.h>
+#include <upright_ros_interface/shm_transport.h>
 
 using namespace upright;
 
@@ -25,10 +31,51 @@ int main(int argc, char** argv) {
     ros::NodeHandle nh;
     std::string config_path = std::string(argv[1]);
 
-    // Robot interface
-    py::scoped_interpreter guard{};
-    ControllerSettings settings = parse_control_settings(config_path);
+    // Settings: load the binary snapshot if an up-to-date one exists;
+    // otherwise parse the YAML configuration (which requires an embedded
+    // Python interpreter) and write the snapshot so that the tracking node --
+    // which does not embed Python -- can load it natively.
+    const std::string snapshot_path = settings_snapshot_path(config_path);
+    SettingsSnapshot snapshot;
+    if (settings_snapshot_fresh(snapshot_path, config_path)) {
+        std::cout << "Loading settings snapshot " << snapshot_path
+                  << std::endl;
+        snapshot = load_settings_snapshot(snapshot_path);
+    } else {
+        py::scoped_interpreter guard{};
+        snapshot.settings = parse_control_settings(config_path);
+        snapshot.target_waypoints = parse_target_waypoints(config_path);
+        // Record the include closure first so the freshness check never
+        // pairs the new snapshot with the previous closure.
+        save_settings_snapshot_deps(snapshot_path,
+                                    parse_config_include_closure(config_path));
+        save_settings_snapshot(snapshot_path, snapshot);
+    }
+    ControllerSettings& settings = snapshot.settings;
     std::cout << settings << std::endl;
+
+    // Apply scheduling before building the controller interface so the
+    // solver worker threads inherit the affinity mask.
+    apply_mpc_realtime_settings(settings.tracking.realtime);
+
+    // Warm-start persistence: trajectories are keyed by a hash of the
+    // serialized settings and target waypoints (i.e. the snapshot contents),
+    // so a stored trajectory is only reused for the exact same task. On a
+    // hit, the previous run's final trajectory becomes the initializer via
+    // the operating-points mechanism.
+    LibraryHash warm_start_key;
+    warm_start_key.add_file(snapshot_path);
+    const WarmStartStore warm_start_store(settings.warm_start_folder);
+    if (settings.use_warm_start_store &&
+        warm_start_store.load(warm_start_key, settings.dims.x(),
+                              settings.dims.u(), settings.operating_times,
+                              settings.operating_states,
+                              settings.operating_inputs)) {
+        settings.use_operating_points = true;
+        std::cout << "Loaded warm start from "
+                  << warm_start_store.path(warm_start_key) << std::endl;
+    }
+
     ControllerInterface interface(settings);
 
     // ROS ReferenceManager
@@ -41,9 +88,121 @@ int main(int argc, char** argv) {
     std::unique_ptr<ocs2::MPC_BASE> mpc_ptr = interface.get_mpc();
     mpc_ptr->getSolverPtr()->setReferenceManager(ros_reference_manager_ptr);
 
-    // Launch MPC ROS node
-    ocs2::MPC_ROS_Interface mpc_node(*mpc_ptr, robot_name);
-    mpc_node.launchNodes(nh);
+    // Publish the per-term solve-time breakdown at low rate so deadline
+    // misses can be attributed to a term. The registry reads are atomic, so
+    // the timer callback does not perturb the solver; counters are reset
+    // after each publish, making the reported seconds per-interval.
+    ros::Publisher diagnostics_pub =
+        nh.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+    std::shared_ptr<SolveTimingRegistry> timing_registry =
+        interface.get_timing_registry();
+    std::shared_ptr<RtiMonitor> rti_monitor = interface.get_rti_monitor();
+    ros::Timer diagnostics_timer = nh.createTimer(
+        ros::Duration(1.0),
+        [&diagnostics_pub, timing_registry,
+         rti_monitor](const ros::TimerEvent&) {
+            const auto seconds = timing_registry->seconds();
+            const auto calls = timing_registry->calls();
+            timing_registry->reset();
+
+            diagnostic_msgs::DiagnosticStatus status;
+            status.level = diagnostic_msgs::DiagnosticStatus::OK;
+            status.name = "mpc_solve_timing";
+            status.message = "Per-term MPC solve time over the last interval.";
+            for (const auto& kv : seconds) {
+                diagnostic_msgs::KeyValue pair;
+                pair.key = kv.first;
+                std::ostringstream value;
+                value << kv.second << " s / "
+                      << static_cast<uint64_t>(calls.at(kv.first)) << " calls";
+                pair.value = value.str();
+                status.values.push_back(pair);
+            }
+
+            // Per-solve convergence of the most recent solve. Under
+            // real-time iteration this is the residual suboptimality left
+            // by the iteration budget.
+            diagnostic_msgs::DiagnosticStatus convergence;
+            convergence.level = diagnostic_msgs::DiagnosticStatus::OK;
+            convergence.name = "mpc_convergence";
+            convergence.message =
+                "Performance index of the most recent MPC solve.";
+            diagnostic_msgs::KeyValue solves;
+            solves.key = "solves";
+            solves.value = std::to_string(rti_monitor->solves());
+            convergence.values.push_back(solves);
+            diagnostic_msgs::KeyValue performance;
+            performance.key = "performance";
+            performance.value = rti_monitor->last_performance();
+            convergence.values.push_back(performance);
+
+            diagnostic_msgs::DiagnosticArray msg;
+            msg.header.stamp = ros::Time::now();
+            msg.status.push_back(status);
+            msg.status.push_back(convergence);
+            diagnostics_pub.publish(msg);
+        });
+
+    if (settings.tracking.use_shm_transport) {
+        // Intra-host transport: observations arrive and policies leave
+        // through a shared-memory segment rather than ROS serialization.
+        // Target updates still arrive via the ROS reference manager above.
+        ShmTransport shm(robot_name, settings.dims.x(), settings.dims.u());
+
+        ocs2::SystemObservation observation;
+        observation.state.setZero(settings.dims.x());
+        observation.input.setZero(settings.dims.u());
+        uint64_t observation_sequence = 0;
+        bool initialized = false;
+
+        ocs2::PrimalSolution policy;
+        ros::Rate rate(settings.tracking.rate);
+        while (ros::ok()) {
+            ros::spinOnce();
+            if (shm.read_observation(observation, observation_sequence)) {
+                if (!initialized) {
+                    // Equivalent of resetMpcNode in the ROS path: reset the
+                    // solver with the configured target trajectory, built
+                    // from the first received state.
+                    ocs2::TargetTrajectories target = build_target_trajectory(
+                        snapshot.target_waypoints, settings,
+                        observation.state);
+                    mpc_ptr->reset();
+                    ros_reference_manager_ptr->setTargetTrajectories(target);
+                    initialized = true;
+                    std::cout << "Received first observation." << std::endl;
+                }
+                mpc_ptr->run(observation.time, observation.state);
+                mpc_ptr->getSolverPtr()->getPrimalSolution(
+                    observation.time + mpc_ptr->settings().timeHorizon_,
+                    &policy);
+                shm.write_policy(policy);
+            }
+            rate.sleep();
+        }
+    } else {
+        // Launch MPC ROS node
+        ocs2::MPC_ROS_Interface mpc_node(*mpc_ptr, robot_name);
+        mpc_node.launchNodes(nh);
+    }
+
+    // Persist the final trajectory so the next run of the same task warm
+    // starts from it. If the solver never ran there is nothing to save.
+    if (settings.use_warm_start_store) {
+        try {
+            ocs2::PrimalSolution solution;
+            mpc_ptr->getSolverPtr()->getPrimalSolution(
+                mpc_ptr->getSolverPtr()->getFinalTime(), &solution);
+            warm_start_store.save(warm_start_key, solution.timeTrajectory_,
+                                  solution.stateTrajectory_,
+                                  solution.inputTrajectory_);
+            std::cout << "Saved warm start to "
+                      << warm_start_store.path(warm_start_key) << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to save warm start: " << e.what()
+                      << std::endl;
+        }
+    }
 
     // Successful exit
     return 0;
@@ -0,0 +1,221 @@
+// Offline MPC solve-latency benchmark. Replays a recorded sequence of
+// observations (and optional target resets) through the same MPC object the
+// live mpc_node runs, and reports per-solve latency percentiles along with
+// the solver's own benchmarking breakdown. This lets acceptance criteria
+// like "p99 solve < 20 ms on the 9-DOF config" be checked without driving
+// the robot.
+//
+// The replay log is plain text. Lines starting with '#' are comments.
+// Observation lines contain
+//     <t> <mode> <x (nx values)> <u (nu values)>
+// and target reset lines contain
+//     target <t> <x (nx values)>
+// which resets the reference to a single waypoint at the given time.
+#include <ocs2_mpc/MPC_BASE.h>
+#include <ocs2_mpc/SystemObservation.h>
+#include <ocs2_sqp/MultipleShootingSolver.h>
+#include <upright_control/controller_interface.h>
+#include <upright_control/controller_settings.h>
+#include <upright_control/settings_snapshot.h>
+#include <upright_ros_interface/parsing.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace upright;
+
+namespace {
+
+struct ReplayEntry {
+    bool is_target = false;
+    ocs2::SystemObservation observation;
+    ocs2::TargetTrajectories target;
+};
+
+std::vector<ReplayEntry> load_replay_log(const std::string& path, size_t nx,
+                                         size_t nu) {
+    std::ifstream f(path);
+    if (!f.good()) {
+        throw std::runtime_error("Could not open replay log " + path);
+    }
+
+    std::vector<ReplayEntry> entries;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(f, line)) {
+        ++line_number;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream ss(line);
+        ReplayEntry entry;
+        std::string first;
+        ss >> first;
+        if (first == "target") {
+            entry.is_target = true;
+            ocs2::scalar_t t;
+            VecXd x(nx);
+            ss >> t;
+            for (size_t i = 0; i < nx; ++i) {
+                ss >> x(i);
+            }
+            entry.target =
+                ocs2::TargetTrajectories({t}, {x}, {VecXd::Zero(nu)});
+        } else {
+            entry.observation.time = std::stod(first);
+            ss >> entry.observation.mode;
+            entry.observation.state.setZero(nx);
+            entry.observation.input.setZero(nu);
+            for (size_t i = 0; i < nx; ++i) {
+                ss >> entry.observation.state(i);
+            }
+            for (size_t i = 0; i < nu; ++i) {
+                ss >> entry.observation.input(i);
+            }
+        }
+        if (ss.fail()) {
+            throw std::runtime_error("Malformed replay log line " +
+                                     std::to_string(line_number) + " in " +
+                                     path);
+        }
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+// Percentile of a sorted sample, using the nearest-rank method.
+ocs2::scalar_t percentile(const std::vector<ocs2::scalar_t>& sorted_values,
+                          double p) {
+    const size_t n = sorted_values.size();
+    size_t rank = static_cast<size_t>(std::ceil(p * n));
+    rank = std::max(size_t(1), std::min(rank, n));
+    return sorted_values[rank - 1];
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        throw std::runtime_error("Config path and replay log are required.");
+    }
+    const std::string config_path = argv[1];
+    const std::string log_path = argv[2];
+
+    // Settings: same snapshot-or-parse logic as the MPC node, so the replay
+    // exercises exactly the configuration the live controller would use.
+    const std::string snapshot_path = settings_snapshot_path(config_path);
+    SettingsSnapshot snapshot;
+    if (settings_snapshot_fresh(snapshot_path, config_path)) {
+        std::cout << "Loading settings snapshot " << snapshot_path
+                  << std::endl;
+        snapshot = load_settings_snapshot(snapshot_path);
+    } else {
+        py::scoped_interpreter guard{};
+        snapshot.settings = parse_control_settings(config_path);
+        snapshot.target_waypoints = parse_target_waypoints(config_path);
+        // Record the include closure first so the freshness check never
+        // pairs the new snapshot with the previous closure.
+        save_settings_snapshot_deps(snapshot_path,
+                                    parse_config_include_closure(config_path));
+        save_settings_snapshot(snapshot_path, snapshot);
+    }
+    const ControllerSettings& settings = snapshot.settings;
+
+    ControllerInterface interface(settings);
+    std::unique_ptr<ocs2::MPC_BASE> mpc_ptr = interface.get_mpc();
+    mpc_ptr->getSolverPtr()->setReferenceManager(
+        interface.getReferenceManagerPtr());
+
+    const std::vector<ReplayEntry> entries =
+        load_replay_log(log_path, settings.dims.x(), settings.dims.u());
+    const auto first_observation =
+        std::find_if(entries.begin(), entries.end(),
+                     [](const ReplayEntry& e) { return !e.is_target; });
+    if (first_observation == entries.end()) {
+        throw std::runtime_error("Replay log contains no observations.");
+    }
+
+    // Reset with the target trajectory from the config, built from the first
+    // recorded state, exactly as the live pipeline does.
+    ocs2::TargetTrajectories target = build_target_trajectory(
+        snapshot.target_waypoints, settings, first_observation->observation.state);
+    mpc_ptr->reset();
+    mpc_ptr->getSolverPtr()->getReferenceManager().setTargetTrajectories(
+        target);
+
+    // Replay. The first solve is reported separately since it pays one-time
+    // initialization costs (cold start).
+    std::vector<ocs2::scalar_t> latencies_ms;
+    ocs2::scalar_t first_solve_ms = 0;
+    bool first_solve_done = false;
+    for (const auto& entry : entries) {
+        if (entry.is_target) {
+            mpc_ptr->getSolverPtr()
+                ->getReferenceManager()
+                .setTargetTrajectories(entry.target);
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        mpc_ptr->run(entry.observation.time, entry.observation.state);
+        const auto end = std::chrono::steady_clock::now();
+
+        const ocs2::scalar_t ms =
+            std::chrono::duration<ocs2::scalar_t, std::milli>(end - start)
+                .count();
+        if (!first_solve_done) {
+            first_solve_ms = ms;
+            first_solve_done = true;
+        } else {
+            latencies_ms.push_back(ms);
+        }
+    }
+
+    std::cout << "Replayed " << latencies_ms.size() + 1 << " solves from "
+              << log_path << std::endl;
+    std::cout << "First solve (cold start): " << first_solve_ms << " ms"
+              << std::endl;
+
+    if (!latencies_ms.empty()) {
+        std::sort(latencies_ms.begin(), latencies_ms.end());
+        const ocs2::scalar_t sum = std::accumulate(
+            latencies_ms.begin(), latencies_ms.end(), ocs2::scalar_t(0));
+        std::cout << "Warm solve latency over " << latencies_ms.size()
+                  << " solves:" << std::endl;
+        std::cout << "  mean = " << sum / latencies_ms.size() << " ms"
+                  << std::endl;
+        std::cout << "  p50  = " << percentile(latencies_ms, 0.50) << " ms"
+                  << std::endl;
+        std::cout << "  p95  = " << percentile(latencies_ms, 0.95) << " ms"
+                  << std::endl;
+        std::cout << "  p99  = " << percentile(latencies_ms, 0.99) << " ms"
+                  << std::endl;
+        std::cout << "  max  = " << latencies_ms.back() << " ms" << std::endl;
+    }
+
+    // The SQP solver tracks its own iteration counts and a breakdown of time
+    // spent in linear-quadratic approximation (constraint and cost
+    // evaluation), the QP solve, and line search.
+    auto* sqp_solver =
+        dynamic_cast<ocs2::MultipleShootingSolver*>(mpc_ptr->getSolverPtr());
+    if (sqp_solver != nullptr) {
+        std::cout << sqp_solver->getBenchmarkingInformation() << std::endl;
+    }
+
+    // Convergence of the final solve, for comparing cost formulations (e.g.
+    // the Gauss-Newton vs. full-Hessian end effector cost) by how far each
+    // gets within the same iteration limits.
+    std::cout << "Final solve performance index:" << std::endl
+              << interface.get_rti_monitor()->last_performance() << std::endl;
+
+    // Successful exit
+    return 0;
+}
@@ -1,11 +1,11 @@
-#include <mobile_manipulation_central/kalman_filter.h>
 #include <mobile_manipulation_central/projectile.h>
 #include <mobile_manipulation_central/robot_interfaces.h>
+#include <ocs2_core/misc/LinearInterpolation.h>
 #include <ocs2_mpc/SystemObservation.h>
 #include <ocs2_msgs/mpc_observation.h>
+#include <ocs2_oc/oc_data/PrimalSolution.h>
 #include <ocs2_pinocchio_interface/PinocchioEndEffectorKinematics.h>
 #include <ocs2_ros_interfaces/mrt/MRT_ROS_Interface.h>
-#include <pybind11/embed.h>
 #include <realtime_tools/realtime_publisher.h>
 #include <ros/init.h>
 #include <ros/package.h>
@@ -13,18 +13,77 @@
 #include <upright_control/constraint/obstacle_constraint.h>
 #include <upright_control/controller_interface.h>
 #include <upright_control/reference_trajectory.h>
-#include <upright_ros_interface/parsing.h>
+#include <upright_control/settings_snapshot.h>
+#include <upright_ros_interface/async_logger.h>
+#include <upright_ros_interface/obstacle_pipeline.h>
+#include <upright_ros_interface/realtime.h>
+#include <upright_ros_interface/robot_feedback.h>
 #include <upright_ros_interface/safety.h>
+#include <upright_ros_interface/shm_transport.h>
+#include <upright_ros_interface/tracking_estimator.h>
 
+#include <upright_ros_interface/SelectTarget.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <new>
+#include <thread>
 
 using namespace upright;
 
-enum class ProjectileState {
-    Preflight,
-    Flight,
-    Postflight,
-};
+// Global allocation counter used by strict real-time mode to verify that the
+// hot sections of the tracking loop are free of heap allocations. The
+// replacement operators are otherwise equivalent to the defaults. This is
+// safe because this node is a single translation unit.
+static std::atomic<uint64_t> allocation_count{0};
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// Returns true (after logging) if any heap allocation happened since `start`.
+// Used with tracking.realtime_strict to fail fast instead of silently
+// tolerating allocator latency in the control loop.
+bool allocations_occurred(uint64_t start, const char* section) {
+    const uint64_t n =
+        allocation_count.load(std::memory_order_relaxed) - start;
+    if (n > 0) {
+        ROS_ERROR_STREAM("Strict real-time violation: "
+                         << section << " performed " << n
+                         << " heap allocation(s).");
+        return true;
+    }
+    return false;
+}
+
+// Evaluate a buffered policy at (t, x), mirroring MRT_BASE::evaluatePolicy
+// but over a policy copy owned by the control thread. This lets the policy
+// reception thread receive and deserialize new policies concurrently: the
+// control thread never touches the MRT policy machinery, only the buffered
+// copy it was handed.
+void evaluate_policy(const ocs2::PrimalSolution& policy, ocs2::scalar_t t,
+                     const VecXd& x, VecXd& xd, VecXd& u, size_t& mode) {
+    // Like MRT_BASE, clamp to the policy horizon rather than extrapolating.
+    t = std::min(t, policy.timeTrajectory_.back());
+    xd = ocs2::LinearInterpolation::interpolate(t, policy.timeTrajectory_,
+                                                policy.stateTrajectory_);
+    u = policy.controllerPtr_->computeInput(t, x);
+    mode = policy.modeSchedule_.modeAtTime(t);
+}
 
 const double PROJECTILE_ACTIVATION_HEIGHT = 1.0;  // meters
 const double PROJECTILE_DEACTIVATION_HEIGHT = 0.2;
@@ -36,8 +95,10 @@ std::unique_ptr<mm::RobotROSInterface> robot_ptr;
 // Custom SIGINT handler
 void sigint_handler(int sig) {
     std::cerr << "Received SIGINT." << std::endl;
-    std::cerr << "Braking robot." << std::endl;
-    robot_ptr->brake();
+    if (robot_ptr) {
+        std::cerr << "Braking robot." << std::endl;
+        robot_ptr->brake();
+    }
     ros::shutdown();
 }
 
@@ -53,23 +114,59 @@ int main(int argc, char** argv) {
     ros::NodeHandle nh;
     std::string config_path = std::string(argv[1]);
 
+    // Optional precompiled target bank (see build_target_bank): when given,
+    // the node exposes a service for switching between the bank's named
+    // targets at runtime instead of requiring a restart per task.
+    std::string target_bank_path;
+    if (argc > 2) {
+        target_bank_path = std::string(argv[2]);
+    }
+
     // controller interface
-    // Python interpreter required for now because we actually load the control
-    // settings and the target trajectories using Python - not ideal but easier
-    // than re-implementing the parsing logic in C++
-    py::scoped_interpreter guard{};
-    ControllerSettings settings = parse_control_settings(config_path);
+    // The YAML configuration is parsed by a Python-capable process (normally
+    // the MPC node), which writes the result as a binary snapshot. This node
+    // deliberately does not embed a Python interpreter -- interpreter startup
+    // costs seconds and ~100 MB of resident memory in a real-time node -- so
+    // wait for an up-to-date snapshot to appear and load it natively.
+    const std::string snapshot_path = settings_snapshot_path(config_path);
+    ros::Rate snapshot_wait_rate(10);
+    while (ros::ok() &&
+           !settings_snapshot_fresh(snapshot_path, config_path)) {
+        snapshot_wait_rate.sleep();
+    }
+    SettingsSnapshot snapshot = load_settings_snapshot(snapshot_path);
+    ControllerSettings& settings = snapshot.settings;
     std::cout << settings << std::endl;
+
+    // Apply scheduling before anything else allocates or spawns threads so
+    // the whole node inherits the affinity mask and locked memory.
+    apply_control_realtime_settings(settings.tracking.realtime);
+
     ControllerInterface interface(settings);
     const auto& r = settings.dims.robot;
 
-    SafetyMonitor monitor(settings, interface.get_pinocchio_interface());
+    // Diagnostics from the control loop go through the async logger; the
+    // loop itself only pushes binary records.
+    AsyncLogger logger;
+    SafetyMonitor monitor(settings, interface.get_pinocchio_interface(),
+                          logger);
 
     // MRT
     ocs2::MRT_ROS_Interface mrt(robot_name);
     mrt.initRollout(&interface.get_rollout());
     mrt.launchNodes(nh);
 
+    // Intra-host transport: when enabled, observations and policies are
+    // exchanged with the MPC node through shared memory instead of ROS
+    // serialization. The MRT interface above is still used for target
+    // resets, which go through the ROS reference manager.
+    const bool use_shm = settings.tracking.use_shm_transport;
+    std::unique_ptr<ShmTransport> shm;
+    if (use_shm) {
+        shm.reset(new ShmTransport(robot_name, settings.dims.x(),
+                                   settings.dims.u()));
+    }
+
     // When debugging, we publish the desired state and input planned by the
     // MPC at each timestep.
     realtime_tools::RealtimePublisher<ocs2_msgs::mpc_observation> mpc_plan_pub(
@@ -78,49 +175,86 @@ int main(int argc, char** argv) {
     realtime_tools::RealtimePublisher<ocs2_msgs::mpc_observation> cmd_pub(
         nh, robot_name + "_cmds", 1);
 
-    // Initialize the robot interface
+    // Initialize the robot interface. Its subscribers go on the feedback
+    // object's dedicated callback queue, drained by a dedicated thread that
+    // publishes each timestamped measurement into a seqlock-protected
+    // snapshot. The control loop reads the snapshot wait-free instead of
+    // draining the callback queue once per cycle, so feedback latency is
+    // bounded by message arrival rather than quantized to the loop period.
+    RobotFeedback feedback(r.q);
+    ros::NodeHandle robot_nh;
+    robot_nh.setCallbackQueue(&feedback.queue());
     if (r.q == 3) {
-        robot_ptr.reset(new mm::RidgebackROSInterface(nh));
+        robot_ptr.reset(new mm::RidgebackROSInterface(robot_nh));
     } else if (r.q == 6) {
-        robot_ptr.reset(new mm::UR10ROSInterface(nh));
+        robot_ptr.reset(new mm::UR10ROSInterface(robot_nh));
     } else if (r.q == 9) {
-        robot_ptr.reset(new mm::MobileManipulatorROSInterface(nh));
+        robot_ptr.reset(new mm::MobileManipulatorROSInterface(robot_nh));
     } else {
         throw std::runtime_error("Unsupported base type.");
     }
+    feedback.start(*robot_ptr);
 
     // Set up a custom SIGINT handler to brake the robot before shutting down
     // (this is why we set it up after the robot is initialized)
     signal(SIGINT, sigint_handler);
 
-    // Initialize interface to dynamic obstacle estimator if we are using
-    // dynamic obstacles
+    // Obstacle pipeline: maintains the obstacle region of the state as one
+    // structure-of-arrays block off the control thread. The projectile
+    // estimator's subscribers go on the pipeline's callback queue so its
+    // callbacks and the flight-state machines run on the pipeline thread.
+    const bool using_projectile =
+        settings.dims.o > 0 && settings.tracking.use_projectile;
+    ObstaclePipeline obstacles(
+        settings.obstacle_settings.dynamic_obstacles,
+        using_projectile ? 1 : 0, PROJECTILE_ACTIVATION_HEIGHT,
+        PROJECTILE_DEACTIVATION_HEIGHT);
+    if (settings.dims.o > 0 &&
+        settings.obstacle_settings.dynamic_obstacles.size() !=
+            settings.dims.o) {
+        throw std::runtime_error(
+            "Number of dynamic obstacles does not match dims.o.");
+    }
+
+    // mm's Vicon estimator tracks a single projectile; it drives obstacle 0
+    // through the multi-target interface and any further obstacles follow
+    // their scripted modes.
     mm::ProjectileROSInterface projectile;
-    // if (settings.dims.o > 0) {  TODO after experiments
-    projectile.init(nh);
-    // }
-    // bool avoid_dynamic_obstacle = false;
-    ProjectileState projectile_state = ProjectileState::Preflight;
+    std::unique_ptr<ProjectileObstacleEstimator> obstacle_estimator;
+    if (using_projectile) {
+        ros::NodeHandle obstacle_nh;
+        obstacle_nh.setCallbackQueue(&obstacles.queue());
+        projectile.init(obstacle_nh);
+        obstacle_estimator.reset(new ProjectileObstacleEstimator(projectile));
+    }
 
     ros::Rate rate(settings.tracking.rate);
 
-    // Wait until we get feedback from the robot to do remaining setup.
-    while (ros::ok()) {
-        ros::spinOnce();
-        if (robot_ptr->ready()) {
-            break;
-        }
+    // Robot feedback buffer and the receipt time of the measurement in it.
+    VecXd q = VecXd::Zero(r.q);
+    double t_meas = 0;
+
+    // Wait until we get feedback from the robot to do remaining setup. The
+    // feedback thread drains the robot's callbacks; we just wait for the
+    // first snapshot.
+    while (ros::ok() && !feedback.has_measurement()) {
         rate.sleep();
     }
+    feedback.read(q, t_meas);
     std::cout << "Received feedback from robot." << std::endl;
 
     // Update initial state with robot feedback
     VecXd x0 = interface.get_initial_state();
-    x0.head(r.q) = robot_ptr->q();
-
-    // Reset MPC with our desired target trajectory
-    ocs2::TargetTrajectories target = parse_target_trajectory(config_path, x0);
-    mrt.resetMpcNode(target);
+    x0.head(r.q) = q;
+
+    // Reset MPC with our desired target trajectory. In shared-memory mode
+    // the MPC node is not running its reset service; it resets itself with
+    // the same target, built from the first observation we write below.
+    ocs2::TargetTrajectories target =
+        build_target_trajectory(snapshot.target_waypoints, settings, x0);
+    if (!use_shm) {
+        mrt.resetMpcNode(target);
+    }
 
     // Initial state and input
     VecXd x = x0;
@@ -132,43 +266,28 @@ int main(int argc, char** argv) {
     observation.state = x0;
     observation.input = u;
 
-    // Obstacle setup.
-    const bool using_projectile =
-        settings.dims.o > 0 && settings.tracking.use_projectile;
-    const bool using_stationary =
-        settings.dims.o > 0 && !settings.tracking.use_projectile;
-
-    DynamicObstacle* obstacle;
-    if (settings.dims.o > 0) {
-        obstacle = &settings.obstacle_settings.dynamic_obstacles[0];
-        const size_t num_modes = obstacle->modes.size();
-        if ((using_projectile && num_modes != 1) ||
-            (using_stationary && num_modes > 2)) {
-            throw std::runtime_error(
-                "Dynamic obstacle has wrong number of modes.");
-        }
-    }
-
     ros::Duration policy_update_delay(settings.tracking.min_policy_update_time);
     const ocs2::scalar_t dt0 = 1 / settings.tracking.rate;
     const ocs2::scalar_t dt_warn = 1.5 / settings.tracking.rate;
 
-    // Estimation
-    mm::kf::GaussianEstimate estimate;
-    estimate.x = x;
-    estimate.P =
-        settings.estimation.robot_init_variance * MatXd::Identity(r.x, r.x);
+    // Estimation. The estimator preallocates all of its workspace so the
+    // per-tick update below is heap-allocation-free, and is dispatched once
+    // here to the fixed-size instantiation matching the robot (q = 3, 6, 9)
+    // so its Eigen kernels are fully unrolled. When enabled, a steady-state
+    // Kalman gain is precomputed here for the nominal timestep, which
+    // removes the covariance propagation and gain solve from every tick;
+    // ticks with an off-nominal dt fall back to the time-varying update.
+    std::unique_ptr<TrackingEstimatorBase> estimator =
+        make_tracking_estimator(r, settings.estimation, x);
+    const bool use_steady_state_gain =
+        settings.tracking.use_steady_state_gain;
+    const ocs2::scalar_t dt_deviation_max =
+        settings.tracking.steady_state_dt_tolerance * dt0;
+    if (use_steady_state_gain) {
+        estimator->compute_steady_state_gain(dt0);
+    }
 
     const MatXd I = MatXd::Identity(r.q, r.q);
-    const MatXd Z = MatXd::Zero(r.q, r.q);
-    MatXd C(r.q, r.x);
-    C << I, Z, Z;
-
-    const MatXd Q0 = settings.estimation.robot_process_variance * I;
-    const MatXd R0 = settings.estimation.robot_measurement_variance * I;
-
-    MatXd A(r.x, r.x);
-    MatXd B(r.x, r.v);
 
     // Commands
     VecXd v_cmd = VecXd::Zero(r.v);
@@ -179,28 +298,156 @@ int main(int argc, char** argv) {
     Kx << settings.tracking.kp * I, settings.tracking.kv * I,
         settings.tracking.ka * I;
 
-    const VecXd original_target_state = target.stateTrajectory[0];
+    // Preallocate the debug message buffers so the loop only copies values
+    // into them rather than constructing new vectors.
+    mpc_plan_pub.msg_.state.value.resize(settings.dims.x());
+    mpc_plan_pub.msg_.input.value.resize(settings.dims.u());
+    cmd_pub.msg_.state.value.assign(r.x, 0.0);
+
+    const bool realtime_strict = settings.tracking.realtime_strict;
+    uint64_t audit_start = 0;
+
+    VecXd original_target_state = target.stateTrajectory[0];
+
+    // Precompiled target bank: build one trajectory per entry now, relative
+    // to the same initial state as the primary target, so a runtime task
+    // switch is a target reset with a precomputed trajectory rather than a
+    // controller restart.
+    std::vector<std::string> bank_names;
+    std::vector<ocs2::TargetTrajectories> bank_targets;
+    if (!target_bank_path.empty()) {
+        const TargetBank bank = load_target_bank(target_bank_path);
+        for (const auto& entry : bank.entries) {
+            bank_names.push_back(entry.first);
+            bank_targets.push_back(
+                build_target_trajectory(entry.second, settings, x0));
+        }
+        std::cout << "Loaded target bank with " << bank_names.size()
+                  << " target(s)." << std::endl;
+    }
+
+    // The service callback runs from ros::spinOnce() on the control thread,
+    // so it may touch the target and the MRT interface directly.
+    boost::function<bool(upright_ros_interface::SelectTarget::Request&,
+                         upright_ros_interface::SelectTarget::Response&)>
+        select_target_cb =
+            [&](upright_ros_interface::SelectTarget::Request& req,
+                upright_ros_interface::SelectTarget::Response& res) {
+                for (size_t i = 0; i < bank_names.size(); ++i) {
+                    if (bank_names[i] == req.name) {
+                        target = bank_targets[i];
+                        original_target_state = target.stateTrajectory[0];
+                        mrt.resetTarget(target);
+                        res.success = true;
+                        res.message = "Switched to target " + req.name + ".";
+                        return true;
+                    }
+                }
+                std::string names;
+                for (const auto& name : bank_names) {
+                    names += " " + name;
+                }
+                res.success = false;
+                res.message = "No target named " + req.name +
+                              " in the bank; available:" + names;
+                return true;
+            };
+    ros::ServiceServer select_target_srv;
+    if (!bank_targets.empty()) {
+        select_target_srv = nh.advertiseService(robot_name + "_select_target",
+                                                select_target_cb);
+    }
 
     // Let MPC generate the initial plan
+    ocs2::PrimalSolution* active_policy = nullptr;
+    uint64_t shm_policy_count = 0;
     observation.time = ros::Time::now().toSec();
-    mrt.setCurrentObservation(observation);
-    while (ros::ok()) {
-        mrt.spinMRT();
-        if (mrt.initialPolicyReceived()) {
-            break;
+    if (use_shm) {
+        auto* first = new ocs2::PrimalSolution;
+        while (ros::ok()) {
+            shm->write_observation(observation);
+            if (shm->read_policy(*first, shm_policy_count)) {
+                break;
+            }
+            rate.sleep();
         }
-        rate.sleep();
+        active_policy = first;
+    } else {
+        mrt.setCurrentObservation(observation);
+        while (ros::ok()) {
+            mrt.spinMRT();
+            if (mrt.initialPolicyReceived()) {
+                break;
+            }
+            rate.sleep();
+        }
+        mrt.updatePolicy();
+        active_policy = new ocs2::PrimalSolution(mrt.getPolicy());
     }
-    mrt.updatePolicy();
     std::cout << "Received first policy." << std::endl;
 
+    // Double-buffered policy handoff. The reception thread below owns all
+    // MRT spinning: it deserializes incoming policy messages off the control
+    // thread and publishes a copy through `pending_policy`. The control
+    // thread flips the pointer into `active_policy` at the top of each cycle
+    // and hands the superseded copy back through `retired_policy` so that it
+    // is also freed off the control thread. All handoffs are single atomic
+    // exchanges, so the control thread never blocks on the reception thread
+    // and never pays deserialization or copy cost.
+    std::atomic<ocs2::PrimalSolution*> pending_policy{nullptr};
+    std::atomic<ocs2::PrimalSolution*> retired_policy{nullptr};
+    std::atomic<bool> policy_thread_running{true};
+
+    std::thread policy_thread([&]() {
+        // Spin at the tracking rate; new policies arrive much more slowly.
+        ros::Rate policy_spin_rate(settings.tracking.rate);
+        ros::Time last_policy_update_time = ros::Time::now();
+        // Staging policy reused across shared-memory reads that find
+        // nothing new.
+        std::unique_ptr<ocs2::PrimalSolution> staging(
+            new ocs2::PrimalSolution);
+        while (ros::ok() &&
+               policy_thread_running.load(std::memory_order_relaxed)) {
+            ocs2::PrimalSolution* fresh = nullptr;
+            if (!use_shm) {
+                mrt.spinMRT();
+            }
+            const ros::Time spin_time = ros::Time::now();
+            if (spin_time - last_policy_update_time >= policy_update_delay) {
+                if (use_shm) {
+                    if (shm->read_policy(*staging, shm_policy_count)) {
+                        fresh = staging.release();
+                        staging.reset(new ocs2::PrimalSolution);
+                    }
+                } else if (mrt.updatePolicy()) {
+                    fresh = new ocs2::PrimalSolution(mrt.getPolicy());
+                }
+            }
+            if (fresh != nullptr) {
+                delete pending_policy.exchange(fresh,
+                                               std::memory_order_acq_rel);
+                last_policy_update_time = spin_time;
+            }
+            // Free the policy the control thread most recently retired.
+            delete retired_policy.exchange(nullptr,
+                                           std::memory_order_acq_rel);
+            policy_spin_rate.sleep();
+        }
+    });
+
     // Initialize time
     ros::Time now = ros::Time::now();
-    ros::Time last_policy_update_time = now;
     ocs2::scalar_t t = now.toSec();
     ocs2::scalar_t last_t = t;
     const ocs2::scalar_t t0 = t;
 
+    // Start the obstacle pipeline now that t0 anchors the scripted mode
+    // switching times. Its thread drains the estimator callbacks and runs the
+    // flight-state machines from here on.
+    const size_t nx_obs = 9 * settings.dims.o;
+    obstacles.start(obstacle_estimator.get(), x0.tail(nx_obs), t0,
+                    settings.tracking.rate);
+
     // Now that we're all set up and have an initial policy, we can get started
     // moving the robot.
     while (ros::ok()) {
@@ -213,102 +460,121 @@ int main(int argc, char** argv) {
             ROS_WARN_STREAM("Loop is slow: dt = " << 1000 * dt << " ms.");
         }
 
-        // Robot feedback
-        VecXd q = robot_ptr->q();
-
-        // Build KF matrices
-        // clang-format off
-        A << I, dt * I, 0.5 * dt * dt * I,
-             Z, I, dt * I,
-             Z, Z, I;
-        // clang-format on
-
-        B << dt * dt * dt * I / 6, 0.5 * dt * dt * I, dt * I;
-        MatXd Q = B * Q0 * B.transpose();
+        // Robot feedback: wait-free read of the latest measurement snapshot
+        // published by the feedback thread, together with its receipt time.
+        // If no message arrived since the last cycle the previous
+        // measurement is kept, and its larger age is accounted for below.
+        feedback.read(q, t_meas);
 
         // Estimate current state from joint position and jerk input using
-        // Kalman filter
-        // VecXd u_robot = u.head(r.u);
-        estimate = mm::kf::predict(estimate, A, Q, B * u_cmd);
-        estimate = mm::kf::correct(estimate, C, R0, q);
-        x.head(r.x) = estimate.x;
-
-        // Dynamic obstacles
-        if (using_projectile && projectile.ready()) {
-            Vec3d q_obs = projectile.q();
-
-            if (projectile_state == ProjectileState::Preflight &&
-                q_obs(2) > PROJECTILE_ACTIVATION_HEIGHT) {
-                // Ball is detected: avoid the ball
-                ocs2::vector_array_t new_target_states = target.stateTrajectory;
-                new_target_states[0].tail(1) << 1.0;
-                ocs2::TargetTrajectories new_target(target.timeTrajectory,
-                                                    new_target_states,
-                                                    target.inputTrajectory);
-                mrt.resetTarget(new_target);
-
-                projectile_state = ProjectileState::Flight;
-            } else if (projectile_state == ProjectileState::Flight &&
-                       q_obs(2) < PROJECTILE_DEACTIVATION_HEIGHT) {
-                // Ball has passed: go back to the original trajectory
-                ocs2::vector_array_t new_target_states = target.stateTrajectory;
-                new_target_states[0] = original_target_state;
-                ocs2::TargetTrajectories new_target(target.timeTrajectory,
-                                                    new_target_states,
-                                                    target.inputTrajectory);
-                mrt.resetTarget(new_target);
-
-                projectile_state = ProjectileState::Postflight;
-            }
+        // the Kalman filter. The measurement is first extrapolated forward
+        // by its actual age, so the correction uses where the joints are
+        // estimated to be now rather than where they were when the message
+        // arrived. The audit only covers the sections this node computes
+        // itself: the ROS and MRT calls elsewhere in the loop allocate
+        // during message (de)serialization and are beyond our control.
+        if (realtime_strict) {
+            audit_start = allocation_count.load(std::memory_order_relaxed);
+        }
+        const ocs2::scalar_t age = std::max(0.0, t - t_meas);
+        estimator->compensate_measurement_age(q, age);
+        if (use_steady_state_gain &&
+            std::abs(dt - dt0) <= dt_deviation_max) {
+            estimator->update_steady_state(q, u_cmd);
+        } else {
+            estimator->update(q, u_cmd, dt);
+        }
+        estimator->copy_state_to(x);
+        if (realtime_strict &&
+            allocations_occurred(audit_start, "State estimation")) {
+            break;
+        }
 
-            // Always update state once we're past preflight
-            if (projectile_state != ProjectileState::Preflight) {
-                Vec3d v_obs = projectile.v();
-                Vec3d a_obs = obstacle->modes[0].acceleration;
-                x.tail(9) << q_obs, v_obs, a_obs;
+        // Dynamic obstacles: the pipeline thread has already run the
+        // flight-state machines and assembled the whole obstacle block; this
+        // thread only acts on pending target events (it owns the MRT
+        // interface) and copies the block into the state, so the per-tick
+        // cost is independent of the number of obstacles.
+        if (settings.dims.o > 0) {
+            switch (obstacles.poll_target_event()) {
+                case ObstacleTargetEvent::Avoid: {
+                    // An obstacle is airborne: avoid it
+                    ocs2::vector_array_t new_target_states =
+                        target.stateTrajectory;
+                    new_target_states[0].tail(1) << 1.0;
+                    ocs2::TargetTrajectories new_target(
+                        target.timeTrajectory, new_target_states,
+                        target.inputTrajectory);
+                    mrt.resetTarget(new_target);
+                    break;
+                }
+                case ObstacleTargetEvent::Restore: {
+                    // All obstacles have landed: go back to the original
+                    // trajectory
+                    ocs2::vector_array_t new_target_states =
+                        target.stateTrajectory;
+                    new_target_states[0] = original_target_state;
+                    ocs2::TargetTrajectories new_target(
+                        target.timeTrajectory, new_target_states,
+                        target.inputTrajectory);
+                    mrt.resetTarget(new_target);
+                    break;
+                }
+                case ObstacleTargetEvent::None:
+                    break;
             }
 
             // TODO we could have the MPC reset if the projectile was inside
             // the "awareness zone" but then leaves, such that the robot is
             // ready for the next throw
-        } else if (using_stationary && obstacle->modes.size() > 1) {
-            if (t - t0 <= obstacle->modes[1].time) {
-                x.tail(9) = obstacle->modes[0].state();
-            } else {
-                x.tail(9) = obstacle->modes[1].state();
-            }
+            obstacles.read(x.tail(nx_obs));
+        }
+
+        // Flip in a freshly-deserialized policy, if one is waiting. This is
+        // the only point where the policy may change within a cycle.
+        ocs2::PrimalSolution* fresh =
+            pending_policy.exchange(nullptr, std::memory_order_acq_rel);
+        if (fresh != nullptr) {
+            ocs2::PrimalSolution* superseded = active_policy;
+            active_policy = fresh;
+            // Hand the old policy back for off-thread destruction. The slot
+            // is only still occupied if the reception thread has fallen
+            // behind, in which case we free the oldest copy ourselves.
+            delete retired_policy.exchange(superseded,
+                                           std::memory_order_acq_rel);
         }
 
         // Compute optimal state and input using current policy
-        mrt.evaluatePolicy(t, x, xd, u, mode);
+        evaluate_policy(*active_policy, t, x, xd, u, mode);
 
         if (settings.debug) {
-            if (using_projectile) {
-                std::cout << "x_obs = " << x.tail(9).transpose() << std::endl;
-                std::cout << "xd_obs = " << xd.tail(9).transpose() << std::endl;
+            if (settings.dims.o > 0) {
+                logger.log(LogEvent::ObstacleStateDebug, t, x.tail(nx_obs),
+                           xd.tail(nx_obs));
             }
 
-            // Publish planned state and input
+            // Publish planned state and input, copying into the preallocated
+            // message buffers
             if (mpc_plan_pub.trylock()) {
-                VecX<float> xf = xd.cast<float>();
-                VecX<float> uf = u.cast<float>();
-
                 mpc_plan_pub.msg_.time = t;
-                mpc_plan_pub.msg_.state.value =
-                    std::vector<float>(xf.data(), xf.data() + xf.size());
-                mpc_plan_pub.msg_.input.value =
-                    std::vector<float>(uf.data(), uf.data() + uf.size());
+                for (int i = 0; i < xd.size(); ++i) {
+                    mpc_plan_pub.msg_.state.value[i] =
+                        static_cast<float>(xd(i));
+                }
+                for (int i = 0; i < u.size(); ++i) {
+                    mpc_plan_pub.msg_.input.value[i] =
+                        static_cast<float>(u(i));
+                }
                 mpc_plan_pub.unlockAndPublish();
             }
 
             // Publish commanded (integrated) velocity and acceleration
             if (cmd_pub.trylock()) {
-                VecX<float> xf = VecX<float>::Zero(r.x);
-                xf.segment(r.q, r.v) = v_cmd.cast<float>();
-
                 cmd_pub.msg_.time = t;
-                cmd_pub.msg_.state.value =
-                    std::vector<float>(xf.data(), xf.data() + xf.size());
+                for (size_t i = 0; i < r.v; ++i) {
+                    cmd_pub.msg_.state.value[r.q + i] =
+                        static_cast<float>(v_cmd(i));
+                }
                 cmd_pub.unlockAndPublish();
             }
         }
@@ -323,23 +589,31 @@ int main(int argc, char** argv) {
         // Check that the controller has provided sane values.
         // Check monitor first so we can still log violations
         if (settings.tracking.enforce_state_limits &&
-            monitor.state_limits_violated(xd)) {
+            monitor.state_limits_violated(t, xd)) {
             break;
         }
         if (settings.tracking.enforce_input_limits &&
-            monitor.input_limits_violated(u)) {
+            monitor.input_limits_violated(t, u)) {
             break;
         }
 
         // State feedback
         // This should only be used when an optimal feedback policy is not
         // computed internally by the MPC
-        u_cmd = Kx * (xd - x).head(r.x) + u.head(r.u);
+        if (realtime_strict) {
+            audit_start = allocation_count.load(std::memory_order_relaxed);
+        }
+        u_cmd = u.head(r.u);
+        u_cmd.noalias() += Kx * (xd - x).head(r.x);
         u.head(r.u) = u_cmd;
 
         // Double integrate the commanded jerk to get commanded velocity
         v_cmd = x.segment(r.q, r.v) + dt * x.segment(r.q + r.v, r.v) +
                 0.5 * dt * dt * u_cmd;
+        if (realtime_strict &&
+            allocations_occurred(audit_start, "Command computation")) {
+            break;
+        }
 
         // TODO probably should be a real-time publisher
         robot_ptr->publish_cmd_vel(v_cmd, /* bodyframe = */ false);
@@ -348,25 +622,34 @@ int main(int argc, char** argv) {
         observation.time = t;
         observation.state = x;
         observation.input = u;
-        mrt.setCurrentObservation(observation);
-
-        ros::spinOnce();
-
-        // Get new policy messages and update the policy if available
-        mrt.spinMRT();
-        if (now - last_policy_update_time >= policy_update_delay) {
-            mrt.updatePolicy();
-            last_policy_update_time = now;
+        if (use_shm) {
+            shm->write_observation(observation);
+        } else {
+            mrt.setCurrentObservation(observation);
         }
 
+        ros::spinOnce();
         rate.sleep();
     }
 
     // stop the robot when we're done
     std::cout << "Braking robot." << std::endl;
     robot_ptr->brake();
+
+    policy_thread_running.store(false, std::memory_order_relaxed);
+    policy_thread.join();
+    delete pending_policy.exchange(nullptr);
+    delete retired_policy.exchange(nullptr);
+    delete active_policy;
+
+    obstacles.stop();
+    feedback.stop();
     ros::shutdown();
 
+    // Release the robot interface before `feedback` (and with it the
+    // callback queue its subscribers deregister from) goes out of scope.
+    robot_ptr.reset();
+
     // Successful exit
     return 0;
 }